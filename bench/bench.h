@@ -0,0 +1,61 @@
+#ifndef SYNCAIDE_BENCH_BENCH_H
+#define SYNCAIDE_BENCH_BENCH_H
+
+#include <fmt/format.h>
+#include <algorithm>
+#include <iostream>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Keeps the compiler from discarding a result the benchmark never uses.
+template<typename Type>
+inline void keep(Type &&value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Runs the function in batches until the budget is spent and prints the
+// time per call as percentiles over the batches, which shows jitter from
+// locks and allocation that a plain mean would hide. The batch size is
+// grown until a batch takes long enough to time reliably.
+template<typename Fn>
+void measure(
+    const string &name,
+    Fn &&fn,
+    chrono::milliseconds budget = chrono::milliseconds(1000)
+) {
+    using clock = chrono::steady_clock;
+
+    size_t batch = 1;
+    for (;;) {
+        auto start = clock::now();
+        for (size_t i = 0; i < batch; i++) fn();
+        if (clock::now() - start > chrono::microseconds(100)) break;
+        batch *= 2;
+    }
+
+    vector<double> samples;
+    uint64_t calls = 0;
+    auto deadline = clock::now() + budget;
+    while (clock::now() < deadline) {
+        auto start = clock::now();
+        for (size_t i = 0; i < batch; i++) fn();
+        chrono::duration<double, nano> elapsed = clock::now() - start;
+        samples.emplace_back(elapsed.count() / batch);
+        calls += batch;
+    }
+
+    sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        return samples[min(samples.size() - 1, (size_t) (p * samples.size()))];
+    };
+    cout << fmt::format(
+        "{:<32} calls={:<10} p50={:.1f}ns p90={:.1f}ns p99={:.1f}ns",
+        name, calls, percentile(0.50), percentile(0.90), percentile(0.99)
+    ) << endl;
+}
+
+#endif //SYNCAIDE_BENCH_BENCH_H
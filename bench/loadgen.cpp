@@ -0,0 +1,444 @@
+#include "protos/message.pb.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl/stream.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <boost/program_options.hpp>
+#include <nlohmann/json.hpp>
+#include <fmt/format.h>
+#include <type_traits>
+#include <functional>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <mutex>
+
+using namespace std;
+
+namespace loadgen {
+    namespace po = boost::program_options;
+    namespace asio = boost::asio;
+    namespace ssl = boost::asio::ssl;
+    namespace http = boost::beast::http;
+    namespace websocket = boost::beast::websocket;
+    using boost::asio::ip::tcp;
+    using boost::system::error_code;
+    using nlohmann::json;
+
+    struct Settings {
+        string host;
+        string port;
+        bool tls = false;
+        size_t miners = 100;
+        double rate = 1;
+        chrono::seconds duration{30};
+        unsigned int threads = 1;
+    };
+
+    // Samples from every agent. Agents finish on any of the io threads, so
+    // recording goes through the mutex, which is fine at these rates.
+    struct Results {
+        mutex lock;
+        vector<double> setup;
+        vector<double> latency;
+        size_t connected = 0;
+        size_t failures = 0;
+        atomic<size_t> active{0};
+        function<void()> idle;
+
+        void record(vector<double> &into, double value) {
+            lock_guard<mutex> guard(lock);
+            into.emplace_back(value);
+        }
+
+        void fail(const string &call, error_code code) {
+            lock_guard<mutex> guard(lock);
+            if (failures++ < 10) cerr << call << ": " << code.message() << endl;
+        }
+    };
+
+    // One simulated miner. It fetches syncaide.js for a signed set of agent
+    // parameters the way a browser would, upgrades the same connection on
+    // /agent/{uid} and logs in. From then on it sends a message followed by a
+    // ping at the configured rate. The node has no reply for agent messages,
+    // but it only answers the ping after reading the message before it, so
+    // the time to the pong is the time the node took to take the message in.
+    template<typename Stream>
+    class Agent : public enable_shared_from_this<Agent<Stream>> {
+        using clock = chrono::steady_clock;
+        static constexpr bool secured = !is_same<Stream, tcp::socket>::value;
+
+    private:
+        Settings &_cfg;
+        Results &_results;
+        asio::strand<asio::io_context::executor_type> _strand;
+        tcp::resolver _resolver;
+        websocket::stream<Stream> _ws;
+        asio::steady_timer _timer;
+        boost::beast::flat_buffer _buffer;
+        http::request<http::empty_body> _req;
+        http::response<http::string_body> _resp;
+        string _path;
+        string _outgoing;
+        clock::time_point _started;
+        clock::time_point _sent;
+        clock::time_point _deadline;
+        bool _closing = false;
+
+    public:
+        template<typename... Args>
+        Agent(Settings &cfg, Results &results, asio::io_context &ioc, Args &&... args) :
+            _cfg(cfg),
+            _results(results),
+            _strand(ioc.get_executor()),
+            _resolver(ioc),
+            _ws(ioc, forward<Args>(args)...),
+            _timer(ioc) {
+            _results.active++;
+        }
+
+        ~Agent() {
+            if (--_results.active == 0) _results.idle();
+        }
+
+        void run() {
+            _started = clock::now();
+            _resolver.async_resolve(
+                _cfg.host,
+                _cfg.port,
+                bind_executor(_strand, [self = this->shared_from_this()](
+                    error_code code,
+                    tcp::resolver::results_type results
+                ) {
+                    if (code) return self->_results.fail("resolve", code);
+                    self->connect(results);
+                })
+            );
+        }
+
+    private:
+        void connect(const tcp::resolver::results_type &results) {
+            asio::async_connect(
+                _ws.next_layer().lowest_layer(),
+                results.begin(),
+                results.end(),
+                bind_executor(_strand, [self = this->shared_from_this()](
+                    error_code code,
+                    auto
+                ) {
+                    if (code) return self->_results.fail("connect", code);
+                    auto &socket = self->_ws.next_layer().lowest_layer();
+                    socket.set_option(tcp::no_delay(true), code);
+                    self->handshake();
+                })
+            );
+        }
+
+        void handshake() {
+            if constexpr (secured) {
+                _ws.next_layer().async_handshake(
+                    ssl::stream_base::client,
+                    bind_executor(_strand, [self = this->shared_from_this()](
+                        error_code code
+                    ) {
+                        if (code) return self->_results.fail("handshake", code);
+                        self->script();
+                    })
+                );
+            } else {
+                script();
+            }
+        }
+
+        void script() {
+            _req = {http::verb::get, "/syncaide.js", 11};
+            _req.set(http::field::host, _cfg.host);
+            _req.keep_alive(true);
+            http::async_write(
+                _ws.next_layer(),
+                _req,
+                bind_executor(_strand, [self = this->shared_from_this()](
+                    error_code code,
+                    size_t
+                ) {
+                    if (code) return self->_results.fail("request", code);
+                    self->on_request();
+                })
+            );
+        }
+
+        void on_request() {
+            http::async_read(
+                _ws.next_layer(),
+                _buffer,
+                _resp,
+                bind_executor(_strand, [self = this->shared_from_this()](
+                    error_code code,
+                    size_t
+                ) {
+                    if (code) return self->_results.fail("response", code);
+                    self->upgrade();
+                })
+            );
+        }
+
+        // The script starts with "var Module = {...};" carrying the signature
+        // and the signed parameters, which name the uid to connect under.
+        void upgrade() {
+            auto &body = _resp.body();
+            auto begin = body.find('{');
+            auto end = body.find(";\n");
+            auto found = begin != string::npos && end != string::npos;
+            if (_resp.result() != http::status::ok || !found) {
+                return _results.fail("script", asio::error::invalid_argument);
+            }
+
+            json module = json::parse(body.substr(begin, end - begin), nullptr, false);
+            if (module.is_discarded() || module["arguments"].size() != 2) {
+                return _results.fail("script", asio::error::invalid_argument);
+            }
+            string signature = module["arguments"][0];
+            string parameters = module["arguments"][1];
+            json signed_parameters = json::parse(parameters, nullptr, false);
+            if (signed_parameters.is_discarded()) {
+                return _results.fail("script", asio::error::invalid_argument);
+            }
+            _path = "/agent/" + signed_parameters.value("id", string());
+
+            protos::Message msg;
+            msg.set_type(protos::MessageType::LOGIN);
+            msg.mutable_login()->set_signature(signature);
+            msg.mutable_login()->set_parameters(parameters);
+            _outgoing = msg.SerializeAsString();
+
+            _buffer.consume(_buffer.size());
+            _ws.async_handshake(
+                _cfg.host,
+                _path,
+                bind_executor(_strand, [self = this->shared_from_this()](
+                    error_code code
+                ) {
+                    if (code) return self->_results.fail("upgrade", code);
+                    self->login();
+                })
+            );
+        }
+
+        void login() {
+            _ws.binary(true);
+            _ws.async_write(
+                asio::buffer(_outgoing),
+                bind_executor(_strand, [self = this->shared_from_this()](
+                    error_code code,
+                    size_t
+                ) {
+                    if (code) return self->_results.fail("login", code);
+                    self->on_login();
+                })
+            );
+        }
+
+        void on_login() {
+            chrono::duration<double, milli> elapsed = clock::now() - _started;
+            _results.record(_results.setup, elapsed.count());
+            {
+                lock_guard<mutex> guard(_results.lock);
+                _results.connected++;
+            }
+
+            _ws.control_callback([this](websocket::frame_type kind, auto) {
+                if (kind == websocket::frame_type::pong) on_pong();
+            });
+
+            protos::Message msg;
+            msg.set_type(protos::MessageType::SUBMIT);
+            _outgoing = msg.SerializeAsString();
+            _deadline = clock::now() + _cfg.duration;
+            read();
+            tick();
+        }
+
+        // Pongs are only noticed while a read is pending, so one always is.
+        void read() {
+            _ws.async_read(
+                _buffer,
+                bind_executor(_strand, [self = this->shared_from_this()](
+                    error_code code,
+                    size_t
+                ) {
+                    if (code) {
+                        if (!self->_closing) self->_results.fail("read", code);
+                        self->_timer.cancel();
+                        return;
+                    }
+                    self->_buffer.consume(self->_buffer.size());
+                    self->read();
+                })
+            );
+        }
+
+        void tick() {
+            if (clock::now() >= _deadline) return close();
+            _sent = clock::now();
+            _ws.async_write(
+                asio::buffer(_outgoing),
+                bind_executor(_strand, [self = this->shared_from_this()](
+                    error_code code,
+                    size_t
+                ) {
+                    if (code) return self->_results.fail("write", code);
+                    self->ping();
+                })
+            );
+        }
+
+        void ping() {
+            _ws.async_ping(
+                {},
+                bind_executor(_strand, [self = this->shared_from_this()](
+                    error_code code
+                ) {
+                    if (code) return self->_results.fail("ping", code);
+                })
+            );
+        }
+
+        void on_pong() {
+            if (_closing) return;
+            chrono::duration<double, micro> elapsed = clock::now() - _sent;
+            _results.record(_results.latency, elapsed.count());
+
+            auto interval = chrono::duration<double>(1.0 / _cfg.rate);
+            _timer.expires_at(_sent + chrono::duration_cast<clock::duration>(interval));
+            _timer.async_wait(
+                bind_executor(_strand, [self = this->shared_from_this()](
+                    error_code code
+                ) {
+                    if (code) return;
+                    self->tick();
+                })
+            );
+        }
+
+        void close() {
+            _closing = true;
+            _ws.async_close(
+                websocket::close_code::normal,
+                bind_executor(_strand, [self = this->shared_from_this()](
+                    error_code
+                ) {})
+            );
+        }
+    };
+
+    static string summary(vector<double> &samples, const string &unit) {
+        if (samples.empty()) return "n/a";
+        sort(samples.begin(), samples.end());
+        auto percentile = [&samples](double p) {
+            return samples[min(samples.size() - 1, (size_t) (p * samples.size()))];
+        };
+        return fmt::format(
+            "p50={0:.1f}{4} p90={1:.1f}{4} p99={2:.1f}{4} max={3:.1f}{4}",
+            percentile(0.50), percentile(0.90), percentile(0.99),
+            samples.back(), unit
+        );
+    }
+
+    // Opens the given number of agent connections to a local syncaided, logs
+    // them all in and keeps each one sending at the given rate for the given
+    // time, then prints connection setup time and message latency.
+    int run(int argc, const char *argv[]) {
+        Settings cfg;
+        int duration = (int) cfg.duration.count();
+        po::options_description options("Options");
+        options.add_options()
+            ("help", "show this help message and exit")
+            ("host", po::value<string>(&cfg.host)->default_value("127.0.0.1"),
+                "frontend host to connect to")
+            ("port", po::value<string>(&cfg.port)->default_value("8080"),
+                "frontend port to connect to")
+            ("tls", po::bool_switch(&cfg.tls), "connect over TLS")
+            ("miners", po::value<size_t>(&cfg.miners)->default_value(cfg.miners),
+                "number of agent connections to open")
+            ("rate", po::value<double>(&cfg.rate)->default_value(cfg.rate),
+                "messages per second sent by each agent")
+            ("duration", po::value<int>(&duration)->default_value(duration),
+                "seconds each agent keeps sending after logging in")
+            ("threads", po::value<unsigned int>(&cfg.threads)->default_value(cfg.threads),
+                "io threads driving the agents");
+
+        po::variables_map vm;
+        try {
+            po::store(po::parse_command_line(argc, argv, options), vm);
+            po::notify(vm);
+        } catch (exception &e) {
+            cerr << "error: " << e.what() << endl << options << endl;
+            return EXIT_FAILURE;
+        }
+        if (vm.count("help") || cfg.rate <= 0 || cfg.threads == 0) {
+            cout << options << endl;
+            return vm.count("help") ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        cfg.duration = chrono::seconds(duration);
+
+        asio::io_context ioc{(int) cfg.threads};
+        ssl::context ctx{ssl::context::sslv23_client};
+        ctx.set_verify_mode(ssl::verify_none);
+
+        // Agents that stall are not waited on forever, the rest are done
+        // once the last of them is gone.
+        asio::steady_timer limit(ioc, cfg.duration + chrono::seconds(30));
+        limit.async_wait([&ioc](error_code code) {
+            if (!code) ioc.stop();
+        });
+
+        Results results;
+        results.idle = [&ioc, &limit] {
+            asio::post(ioc, [&limit] { limit.cancel(); });
+        };
+        for (size_t i = 0; i < cfg.miners; i++) {
+            if (cfg.tls) {
+                using secured = ssl::stream<tcp::socket>;
+                make_shared<Agent<secured>>(cfg, results, ioc, ctx)->run();
+            } else {
+                make_shared<Agent<tcp::socket>>(cfg, results, ioc)->run();
+            }
+        }
+
+        auto started = chrono::steady_clock::now();
+        vector<thread> threads;
+        for (unsigned int i = 1; i < cfg.threads; i++) {
+            threads.emplace_back([&ioc] { ioc.run(); });
+        }
+        ioc.run();
+        for (auto &each : threads) each.join();
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - started;
+
+        lock_guard<mutex> guard(results.lock);
+        cout << fmt::format(
+            "miners={} connected={} failures={} messages={} throughput={:.0f}/s",
+            cfg.miners, results.connected, results.failures,
+            results.latency.size(), results.latency.size() / elapsed.count()
+        ) << endl;
+        cout << "setup   " << summary(results.setup, "ms") << endl;
+        cout << "latency " << summary(results.latency, "us") << endl;
+        return results.failures ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+}
+
+int main(int argc, const char *argv[]) {
+    return loadgen::run(argc, argv);
+}
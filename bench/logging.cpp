@@ -0,0 +1,59 @@
+#include "logging.h"
+#include "bench.h"
+
+#include <nlohmann/json.hpp>
+#include <streambuf>
+
+using nlohmann::json;
+
+// Swallows whatever the sink writes, so only the logging path itself is
+// measured and not the terminal.
+class Discard : public streambuf {
+protected:
+    int overflow(int c) override {
+        return c;
+    }
+
+    streamsize xsputn(const char *, streamsize count) override {
+        return count;
+    }
+};
+
+// A LOG call the way Http::on_read makes one per request. The call itself
+// only queues the record, formatting and writing happen on the sink thread
+// and are measured by flushing after a burst of records.
+int main() {
+    Discard discard;
+    auto original = clog.rdbuf(&discard);
+
+    json extra = {
+        {"remote", {{"addr", "203.0.113.7"}, {"port", 51234}}},
+        {"method", "GET"},
+        {"target", "/syncaide.wasm"},
+        {"version", "1.1"},
+        {"fields", {{"host", "node.example.com"}, {"user-agent", "bench"}}}
+    };
+
+    measure("LOG info with extra", [&] {
+        LOG(info) << logging::add_value("Extra", extra);
+    });
+
+    measure("LOG info message only", [&] {
+        LOG(info) << "subscribed to daemon notifications.";
+    });
+
+    measure("LOG with extra, 1000 written", [&] {
+        for (int i = 0; i < 1000; i++) {
+            LOG(info) << logging::add_value("Extra", extra);
+        }
+        ::logger.flush();
+    });
+
+    measure("Extra serialization alone", [&] {
+        keep(extra.dump());
+    });
+
+    ::logger.flush();
+    clog.rdbuf(original);
+    return 0;
+}
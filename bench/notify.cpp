@@ -0,0 +1,101 @@
+#include "server/notifier.h"
+#include "server/web/pool.h"
+#include "daemon.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <nlohmann/json.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+namespace http = boost::beast::http;
+using server::Notifier;
+using server::web::Pool;
+using common::Uri;
+using nlohmann::json;
+
+// Latency from the daemon publishing a new block to its refreshed block
+// template arriving over the pool, which is the path Upstream takes on a
+// notification. Prints percentiles over the given number of blocks.
+int main(int argc, char *argv[]) {
+    size_t rounds = argc > 1 ? stoul(argv[1]) : 1000;
+
+    Daemon daemon;
+    boost::asio::io_context ioc;
+    Uri rpc(fmt::format("http://127.0.0.1:{}", daemon.rpc_port()));
+    Uri pub(fmt::format("tcp://127.0.0.1:{}", daemon.pub_port()));
+
+    auto pool = make_shared<Pool>(ioc, rpc, 2, 4);
+    pool->run();
+
+    http::request<http::string_body> req;
+    req.method(http::verb::post);
+    req.target("/json_rpc");
+    req.version(11);
+    req.set(http::field::host, rpc.host());
+    req.set(http::field::content_type, "application/json");
+    req.keep_alive(true);
+    req.body() = json{
+        {"jsonrpc", "2.0"},
+        {"id", "0"},
+        {"method", "getblocktemplate"},
+        {"params", {{"wallet_address", string(95, '4')}, {"reserve_size", 60}}}
+    }.dump();
+    req.prepare_payload();
+
+    vector<double> samples;
+    samples.reserve(rounds);
+    chrono::steady_clock::time_point published;
+
+    function<void()> publish = [&] {
+        if (samples.size() == rounds) return ioc.stop();
+        published = chrono::steady_clock::now();
+        daemon.publish();
+    };
+
+    auto notifier = make_shared<Notifier>(ioc, pub, "json-minimal-chain_main",
+        [&](const string &message) {
+            pool->request(req, [&](auto &res) {
+                json parsed = json::parse(res.body().text, nullptr, false);
+                if (parsed["result"]["height"] != daemon.height()) {
+                    cerr << "stale template" << endl;
+                }
+                chrono::duration<double, micro> elapsed =
+                    chrono::steady_clock::now() - published;
+                samples.emplace_back(elapsed.count());
+                publish();
+            }, [&](const string &call, boost::system::error_code code) {
+                cerr << call << ": " << code.message() << endl;
+                ioc.stop();
+            });
+        }
+    );
+    notifier->run();
+
+    thread starter([&] {
+        if (!daemon.wait_subscribers(1, chrono::seconds(5))) {
+            cerr << "notifier did not subscribe" << endl;
+            return ioc.stop();
+        }
+        boost::asio::post(ioc, publish);
+    });
+    ioc.run();
+    starter.join();
+    notifier->stop();
+    pool->stop();
+
+    if (samples.empty()) return 1;
+    sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        return samples[min(samples.size() - 1, (size_t) (p * samples.size()))];
+    };
+    cout << fmt::format(
+        "blocks={} p50={:.1f}us p90={:.1f}us p99={:.1f}us max={:.1f}us",
+        samples.size(), percentile(0.50), percentile(0.90),
+        percentile(0.99), samples.back()
+    ) << endl;
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include "server/router.h"
+#include "bench.h"
+
+#include <boost/beast/http.hpp>
+
+using server::Router;
+namespace params = server::params;
+namespace http = boost::beast::http;
+
+static int route(void *server, void *request) {
+    return 200;
+}
+
+static int route_uid(void *server, void *request, const string &uid) {
+    return 101;
+}
+
+// Router::dispatch over the frontend's own set of routes. Every rule is
+// matched against every request, so the cost is the same for each route
+// and grows with the number of rules rather than with the target.
+int main() {
+    struct {} server;
+
+    Router router;
+    router.add(route, "/health");
+    router.add(route, "/metrics");
+    router.add(route, "/syncaide[.]js");
+    router.add(route, "/syncaide[.]wasm");
+    router.add(route_uid, "/agent/{}", params::string());
+    router.add(route, "/syncaide[.]html");
+
+    for (auto target : {
+        "/health",
+        "/syncaide.wasm",
+        "/agent/5f3c2a1e-8b0d-4c7a-9e61-2d4b7f0a93c8",
+        "/missing"
+    }) {
+        http::request<http::string_body> req(http::verb::get, target, 11);
+        measure(fmt::format("Router::dispatch {}", target), [&] {
+            keep(router.dispatch(server, req));
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,459 @@
+#include "view.h"
+
+#include <boost/program_options.hpp>
+#include <fmt/format.h>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <queue>
+#include <cmath>
+
+using namespace std;
+
+namespace simulate {
+    namespace po = boost::program_options;
+
+    struct Settings {
+        size_t nodes = 1000;
+        int c = 30;
+        // Half the view unless given.
+        int H = -1;
+        int S = 0;
+        int k = 1;
+        int probe = 5;
+        int rounds = 100;
+        int seeds = 3;
+        int partition = 0;
+        int heal = 10;
+        int kill = 0;
+        double victims = 0.1;
+        int every = 10;
+        unsigned int seed = 1;
+        // Nodes are spread evenly over the regions, exchanges within one
+        // take a short round trip and between them a long one.
+        int regions = 1;
+        double near = 1;
+        double far = 80;
+        View::Policy policy = View::Policy::random;
+        double nearby = 0.75;
+    };
+
+    // A View whose quarantines run on simulated time, one round being the
+    // second between two pulses of a real node.
+    class Node : public View {
+    private:
+        const double &_time;
+
+    public:
+        string addr;
+        bool alive = true;
+        int side = 0;
+        int region = 0;
+        int pulses = 0;
+        deque<Peer> joins;
+
+        Node(const double &time, string addr, const Settings &cfg) :
+            View(chrono::seconds(30), cfg.policy, cfg.nearby),
+            _time(time),
+            addr(move(addr)) {}
+
+    protected:
+        chrono::steady_clock::time_point now() const override {
+            return chrono::steady_clock::time_point(
+                chrono::duration_cast<chrono::steady_clock::duration>(
+                    chrono::duration<double>(_time)
+                )
+            );
+        }
+    };
+
+    struct Event {
+        double time;
+        size_t node;
+
+        bool operator>(const Event &rhs) const {
+            return time > rhs.time;
+        }
+    };
+
+    // What the overlay looked like at the end of a round.
+    struct Sample {
+        size_t alive = 0;
+        size_t components = 0;
+        size_t full = 0;
+        size_t dead = 0;
+        double fill = 0;
+        vector<int> indegree;
+    };
+
+    class Cluster {
+    private:
+        const Settings &_cfg;
+        double _time = 0;
+        mt19937 _random;
+        vector<unique_ptr<Node>> _nodes;
+        unordered_map<string, size_t> _index;
+        priority_queue<Event, vector<Event>, greater<Event>> _events;
+        bool _partitioned = false;
+
+    public:
+        size_t exchanges = 0;
+        // Of the exchanges that went through.
+        size_t answered = 0;
+        size_t local = 0;
+        double latency = 0;
+
+        explicit Cluster(const Settings &cfg) : _cfg(cfg), _random(cfg.seed) {
+            for (size_t i = 0; i < cfg.nodes; i++) {
+                auto addr = fmt::format(
+                    "10.{}.{}.{}:8847",
+                    (i >> 16) & 0xff, (i >> 8) & 0xff, i & 0xff
+                );
+                _index.emplace(addr, i);
+                _nodes.emplace_back(make_unique<Node>(_time, addr, cfg));
+                _nodes.back()->region = (int) (i % cfg.regions);
+            }
+
+            // Every node is started with the same few --joins, the way a
+            // cluster is usually configured, and pulses at its own phase.
+            uniform_real_distribution<double> phase(0, 1);
+            for (size_t i = 0; i < cfg.nodes; i++) {
+                auto &node = *_nodes[i];
+                for (size_t j = 0; j < min((size_t) cfg.seeds, cfg.nodes); j++) {
+                    if (j != i) node.joins.emplace_back(_nodes[j]->addr, 0);
+                }
+                for (auto &join : node.joins) node.add_probe(join.addr());
+                auto joins = node.joins;
+                node.update(cfg.c, cfg.H, cfg.S, joins);
+                _events.push({phase(_random), i});
+            }
+        }
+
+        // Runs every pulse due before the end of the given round.
+        void run(int round) {
+            uniform_real_distribution<double> jitter(0.95, 1.05);
+            while (!_events.empty() && _events.top().time < round + 1) {
+                auto event = _events.top();
+                _events.pop();
+                _time = event.time;
+                auto &node = *_nodes[event.node];
+                if (!node.alive) continue;
+                pulse(node);
+                _events.push({_time + jitter(_random), event.node});
+            }
+            _time = round + 1;
+        }
+
+        void split() {
+            for (auto &node : _nodes) node->side = (int) (_random() % 2);
+            _partitioned = true;
+        }
+
+        void heal() {
+            _partitioned = false;
+        }
+
+        void kill(double share) {
+            vector<size_t> order(_nodes.size());
+            iota(order.begin(), order.end(), 0);
+            std::shuffle(order.begin(), order.end(), _random);
+            order.resize((size_t) (share * order.size()));
+            for (auto i : order) _nodes[i]->alive = false;
+        }
+
+        Sample sample() {
+            Sample out;
+            out.indegree.assign(_nodes.size(), 0);
+
+            // Components are counted over links in either direction, which
+            // is what tells whether the overlay fell apart.
+            vector<size_t> parent(_nodes.size());
+            iota(parent.begin(), parent.end(), 0);
+            function<size_t(size_t)> root = [&](size_t i) {
+                while (parent[i] != i) i = parent[i] = parent[parent[i]];
+                return i;
+            };
+
+            for (size_t i = 0; i < _nodes.size(); i++) {
+                auto &node = *_nodes[i];
+                if (!node.alive) continue;
+                out.alive++;
+                auto view = node.snapshot();
+                out.fill += view.size();
+                if ((int) view.size() >= _cfg.c) out.full++;
+                for (auto &peer : view) {
+                    auto j = _index.at(peer.addr());
+                    if (!_nodes[j]->alive) {
+                        out.dead++;
+                        continue;
+                    }
+                    out.indegree[j]++;
+                    parent[root(i)] = root(j);
+                }
+            }
+
+            for (size_t i = 0; i < _nodes.size(); i++) {
+                if (_nodes[i]->alive && root(i) == i) out.components++;
+            }
+            vector<int> alive;
+            for (size_t i = 0; i < _nodes.size(); i++) {
+                if (_nodes[i]->alive) alive.emplace_back(out.indegree[i]);
+            }
+            out.indegree = move(alive);
+            if (out.alive) out.fill /= out.alive * (double) _cfg.c;
+            return out;
+        }
+
+    private:
+        bool reachable(const Node &from, const Node &to) const {
+            return to.alive && (!_partitioned || from.side == to.side);
+        }
+
+        chrono::steady_clock::duration rtt(const Node &from, const Node &to) {
+            bool same = from.region == to.region;
+            uniform_real_distribution<double> jitter(0.9, 1.1);
+            chrono::duration<double, milli> taken(
+                (same ? _cfg.near : _cfg.far) * jitter(_random)
+            );
+            answered++;
+            if (same) local++;
+            latency += taken.count();
+            return chrono::duration_cast<chrono::steady_clock::duration>(taken);
+        }
+
+        // One Peering::on_pulse, with the PeersService::gossip calls it
+        // causes on the other side carried out in place.
+        void pulse(Node &node) {
+            auto &cfg = _cfg;
+            if (node.empty()) {
+                auto joins = node.joins;
+                node.update(cfg.c, cfg.H, cfg.S, joins);
+                return;
+            }
+
+            deque<Peer> push = node.select(cfg.c / 2 - 1, cfg.H);
+            push.emplace(push.begin(), Peer(node.addr, 0));
+
+            auto targets = node.random_peers(cfg.k);
+            if (cfg.probe && ++node.pulses % cfg.probe == 0) {
+                auto addr = node.next_probe();
+                if (!addr.empty()) targets.emplace_back(addr, 0);
+            }
+
+            for (auto &peer : targets) {
+                auto &other = *_nodes[_index.at(peer.addr())];
+                exchanges++;
+                deque<Peer> pull;
+                if (!reachable(node, other)) {
+                    node.failed(other.addr);
+                    node.update(cfg.c, cfg.H, cfg.S, pull);
+                    continue;
+                }
+
+                deque<Peer> buffer;
+                for (auto &each : push) {
+                    if (each.addr() != other.addr) buffer.emplace_back(each);
+                }
+                other.heard(node.addr);
+                deque<Peer> result = other.select(cfg.c / 2 - 1, cfg.H);
+                result.emplace(result.begin(), Peer(other.addr, 0));
+                other.update(cfg.c, cfg.H, cfg.S, buffer);
+
+                for (auto &each : result) {
+                    if (each.addr() != node.addr) pull.emplace_back(each);
+                }
+                node.succeeded(other.addr, rtt(node, other));
+                node.update(cfg.c, cfg.H, cfg.S, pull);
+            }
+        }
+    };
+
+    static string distribution(vector<int> values) {
+        if (values.empty()) return "n/a";
+        sort(values.begin(), values.end());
+        double mean = accumulate(values.begin(), values.end(), 0.0) / values.size();
+        double variance = 0;
+        for (auto each : values) variance += (each - mean) * (each - mean);
+        auto percentile = [&values](double p) {
+            return values[min(values.size() - 1, (size_t) (p * values.size()))];
+        };
+        return fmt::format(
+            "min={} p10={} p50={} p90={} max={} mean={:.1f} stddev={:.2f}",
+            values.front(), percentile(0.10), percentile(0.50),
+            percentile(0.90), values.back(), mean,
+            sqrt(variance / values.size())
+        );
+    }
+
+    static void policy(Settings &cfg, const string &name) {
+        if (name == "random") {
+            cfg.policy = View::Policy::random;
+        } else if (name == "nearest") {
+            cfg.policy = View::Policy::nearest;
+        } else {
+            auto kind = po::validation_error::invalid_option_value;
+            throw po::validation_error(kind, "policy");
+        }
+    }
+
+    static string rounds(int found, int since) {
+        return found < 0 ? "never" : fmt::format("{} rounds", found - since);
+    }
+
+    // Runs the given number of gossip rounds over simulated nodes that all
+    // start at once from the same joins. The cluster can be split in two
+    // for a while and part of it can be killed, to see how the overlay
+    // holds up. Prints the state of the overlay as it goes, then when it
+    // converged and recovered, the in-degree spread, how much of the gossip
+    // stayed within a region and the CPU time spent on View operations per
+    // exchange.
+    int run(int argc, const char *argv[]) {
+        Settings cfg;
+        po::options_description options("Options");
+        options.add_options()
+            ("help", "show this help message and exit")
+            ("nodes", po::value<size_t>(&cfg.nodes)->default_value(cfg.nodes),
+                "number of simulated nodes")
+            ("c", po::value<int>(&cfg.c)->default_value(cfg.c),
+                "view size")
+            ("H", po::value<int>(&cfg.H)->default_value(-1, "c/2"),
+                "healing, oldest entries dropped on each update")
+            ("S", po::value<int>(&cfg.S)->default_value(cfg.S),
+                "swap, entries sent away dropped on each update")
+            ("k", po::value<int>(&cfg.k)->default_value(cfg.k),
+                "peers gossiped with at once in every round")
+            ("probe", po::value<int>(&cfg.probe)->default_value(cfg.probe),
+                "rounds between probes of a suspected peer or join, 0 for never")
+            ("rounds", po::value<int>(&cfg.rounds)->default_value(cfg.rounds),
+                "gossip rounds to run")
+            ("seeds", po::value<int>(&cfg.seeds)->default_value(cfg.seeds),
+                "number of joins every node starts with")
+            ("partition", po::value<int>(&cfg.partition)->default_value(cfg.partition),
+                "round at which the cluster splits in two halves, 0 for never")
+            ("heal", po::value<int>(&cfg.heal)->default_value(cfg.heal),
+                "rounds the partition lasts")
+            ("kill", po::value<int>(&cfg.kill)->default_value(cfg.kill),
+                "round at which part of the cluster dies, 0 for never")
+            ("victims", po::value<double>(&cfg.victims)->default_value(cfg.victims),
+                "share of the nodes that die")
+            ("every", po::value<int>(&cfg.every)->default_value(cfg.every),
+                "rounds between progress lines")
+            ("seed", po::value<unsigned int>(&cfg.seed)->default_value(cfg.seed),
+                "random seed for the cluster layout and events")
+            ("regions", po::value<int>(&cfg.regions)->default_value(cfg.regions),
+                "number of regions the nodes are spread over")
+            ("near", po::value<double>(&cfg.near)->default_value(cfg.near),
+                "round trip within a region in milliseconds")
+            ("far", po::value<double>(&cfg.far)->default_value(cfg.far),
+                "round trip between regions in milliseconds")
+            ("policy", po::value<string>()
+                    ->default_value("random")
+                    ->notifier([&cfg](const string &name) { policy(cfg, name); }),
+                "how gossip targets are picked, random or nearest")
+            ("nearby", po::value<double>(&cfg.nearby)->default_value(cfg.nearby),
+                "share of the picks that go by round trip under nearest");
+
+        po::variables_map vm;
+        try {
+            po::store(po::parse_command_line(argc, argv, options), vm);
+            po::notify(vm);
+        } catch (exception &e) {
+            cerr << "error: " << e.what() << endl << options << endl;
+            return EXIT_FAILURE;
+        }
+        if (vm.count("help") || cfg.nodes < 2 || cfg.c < 2 || cfg.every < 1 ||
+            cfg.regions < 1 || !(cfg.nearby >= 0 && cfg.nearby <= 1)) {
+            cout << options << endl;
+            return vm.count("help") ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        if (cfg.H < 0) cfg.H = cfg.c / 2;
+
+        Cluster cluster(cfg);
+        int converged = -1, recovered = -1, purged = -1;
+        vector<double> costs;
+        Sample last;
+        for (int round = 0; round < cfg.rounds; round++) {
+            if (cfg.partition && round == cfg.partition) cluster.split();
+            if (cfg.partition && round == cfg.partition + cfg.heal) cluster.heal();
+            if (cfg.kill && round == cfg.kill) cluster.kill(cfg.victims);
+
+            auto before = cluster.exchanges;
+            auto started = chrono::steady_clock::now();
+            cluster.run(round);
+            chrono::duration<double, nano> elapsed =
+                chrono::steady_clock::now() - started;
+            auto exchanges = cluster.exchanges - before;
+            if (exchanges) costs.emplace_back(elapsed.count() / exchanges);
+
+            last = cluster.sample();
+            bool whole = last.components == 1 && last.full == last.alive;
+            if (converged < 0 && whole) converged = round + 1;
+            if (cfg.partition && recovered < 0 &&
+                round >= cfg.partition + cfg.heal && last.components == 1) {
+                recovered = round + 1;
+            }
+            if (cfg.kill && purged < 0 && round >= cfg.kill && !last.dead) {
+                purged = round + 1;
+            }
+
+            if ((round + 1) % cfg.every == 0 || round + 1 == cfg.rounds) {
+                cout << fmt::format(
+                    "round={:<5} alive={:<6} components={:<4} full={:<6} "
+                    "fill={:.3f} dead={:<6} round_ms={:.1f}",
+                    round + 1, last.alive, last.components, last.full,
+                    last.fill, last.dead, elapsed.count() / 1e6
+                ) << endl;
+            }
+        }
+
+        cout << fmt::format(
+            "nodes={} c={} H={} S={} k={} seeds={} regions={} policy={}",
+            cfg.nodes, cfg.c, cfg.H, cfg.S, cfg.k, cfg.seeds, cfg.regions,
+            vm["policy"].as<string>()
+        ) << endl;
+        cout << "converged  " << rounds(converged, 0) << endl;
+        if (cfg.partition) {
+            cout << "recovered  " << rounds(recovered, cfg.partition + cfg.heal)
+                 << " after healing" << endl;
+        }
+        if (cfg.kill) {
+            cout << "purged     " << rounds(purged, cfg.kill)
+                 << " after the kill" << endl;
+        }
+        cout << "indegree   " << distribution(last.indegree) << endl;
+        if (cfg.regions > 1 && cluster.answered) {
+            cout << fmt::format(
+                "locality   {:.1f}% of exchanges within a region, "
+                "mean rtt {:.1f}ms",
+                100.0 * cluster.local / cluster.answered,
+                cluster.latency / cluster.answered
+            ) << endl;
+        }
+
+        sort(costs.begin(), costs.end());
+        if (!costs.empty()) {
+            cout << fmt::format(
+                "exchange   p50={:.0f}ns p90={:.0f}ns max={:.0f}ns",
+                costs[costs.size() / 2],
+                costs[min(costs.size() - 1, costs.size() * 9 / 10)],
+                costs.back()
+            ) << endl;
+        }
+        // Failing when the overlay did not get over what was done to it
+        // lets scenarios run as regression checks.
+        bool failed = converged < 0 ||
+                      (cfg.kill && purged < 0) ||
+                      (cfg.partition && recovered < 0);
+        return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+}
+
+int main(int argc, const char *argv[]) {
+    return simulate::run(argc, argv);
+}
@@ -0,0 +1,51 @@
+#include "view.h"
+#include "bench.h"
+
+#include <fmt/format.h>
+#include <random>
+
+// Cost of the two View operations every gossip round performs, at the
+// default c=30, H=c/2, S=0, with a view that is already full and buffers
+// that overlap it partially as they do in a converged cluster.
+int main(int argc, char *argv[]) {
+    int c = argc > 1 ? stoi(argv[1]) : 30;
+    int H = c / 2;
+    int S = 0;
+
+    mt19937 random(7);
+    uniform_int_distribution<int> addrs(0, c * 4);
+    uniform_int_distribution<int> ages(0, 20);
+    auto buffer = [&] {
+        deque<Peer> out;
+        for (int i = 0; i < c / 2; i++) {
+            out.emplace_back(
+                fmt::format("10.0.{}.{}:8847", addrs(random) / 256, addrs(random) % 256),
+                ages(random)
+            );
+        }
+        return out;
+    };
+
+    View view;
+    while (view.size() < c) {
+        auto fill = buffer();
+        view.update(c, H, S, fill);
+    }
+
+    measure(fmt::format("View::select c={}", c), [&] {
+        keep(view.select(c / 2 - 1, H));
+    });
+
+    vector<deque<Peer>> buffers;
+    for (int i = 0; i < 1024; i++) buffers.emplace_back(buffer());
+    size_t next = 0;
+    measure(fmt::format("View::update c={}", c), [&] {
+        auto each = buffers[next++ % buffers.size()];
+        view.update(c, H, S, each);
+    });
+
+    measure(fmt::format("View::random_peer c={}", c), [&] {
+        keep(view.random_peer());
+    });
+    return 0;
+}
@@ -5,6 +5,7 @@
 client::Client::Client(client::Options &options) :
     peers(*this),
     miners(*this),
+    trace(*this),
     _cfg(options) {}
 
 client::Options &client::Client::cfg() {
@@ -16,6 +17,9 @@ int client::Client::start() {
         if (_cfg.peers.cmd == "list") return peers.list();
     } else if (_cfg.cmd == "miners") {
         if (_cfg.miners.cmd == "list") return miners.list();
+        if (_cfg.miners.cmd == "watch") return miners.watch();
+    } else if (_cfg.cmd == "trace") {
+        if (_cfg.trace.cmd == "dump") return trace.dump();
     }
     return EXIT_FAILURE;
 }
@@ -29,7 +33,8 @@ int client::Client::Peers::list() {
         )
     );
 
-    auto[status, buffer] = caller.list();
+    auto &cfg = _self.cfg().peers.list;
+    auto[status, buffer] = caller.list(cfg.min_age, cfg.max_age);
     if (status.ok()) {
         cout << buffer.value().dump() << endl;
     } else {
@@ -48,7 +53,8 @@ int client::Client::Miners::list() {
         )
     );
 
-    auto[status, buffer] = caller.list(_self.cfg().miners.list.id);
+    auto &cfg = _self.cfg().miners.list;
+    auto[status, buffer] = caller.list(cfg.id, cfg.prefix);
     if (status.ok()) {
         cout << buffer.value().dump() << endl;
     } else {
@@ -57,3 +63,43 @@ int client::Client::Miners::list() {
 
     return status.error_code();
 }
+
+
+int client::Client::Miners::watch() {
+    rpc::callers::MinersCaller caller(
+        grpc::CreateCustomChannel(
+            _self.cfg().network.host.netloc(),
+            grpc::InsecureChannelCredentials(),
+            grpc::ChannelArguments()
+        )
+    );
+
+    // One event per line, flushed right away so the output can be piped.
+    auto status = caller.watch(_self.cfg().miners.watch.id, [](auto &event) {
+        cout << event.dump() << endl;
+    });
+    if (!status.ok()) {
+        LOG(error) << status.error_message();
+    }
+
+    return status.error_code();
+}
+
+int client::Client::Trace::dump() {
+    rpc::callers::TraceCaller caller(
+        grpc::CreateCustomChannel(
+            _self.cfg().network.host.netloc(),
+            grpc::InsecureChannelCredentials(),
+            grpc::ChannelArguments()
+        )
+    );
+
+    auto[status, events] = caller.dump(_self.cfg().trace.dump.clear);
+    if (status.ok()) {
+        cout << events.value().dump() << endl;
+    } else {
+        LOG(error) << status.error_message();
+    }
+
+    return status.error_code();
+}
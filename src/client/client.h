@@ -4,6 +4,7 @@
 #include "client/options.h"
 #include "rpc/callers/peers.h"
 #include "rpc/callers/miners.h"
+#include "rpc/callers/trace.h"
 
 #include <nlohmann/json.hpp>
 #include <boost/format.hpp>
@@ -38,11 +39,24 @@ namespace client {
             explicit Miners(Client &self) : _self(self) {}
 
             int list();
+
+            int watch();
+        };
+
+        class Trace {
+        private:
+            Client &_self;
+
+        public:
+            explicit Trace(Client &self) : _self(self) {}
+
+            int dump();
         };
 
     public:
         Peers peers;
         Miners miners;
+        Trace trace;
 
     private:
         Options &_cfg;
@@ -24,7 +24,8 @@ bool client::Options::parse(int argc, const char **argv) {
     commands.emplace_back(po::options_description("Commands"));
     commands.back().add_options()
         ("peers", "peers commands")
-        ("miners", "miners commands");
+        ("miners", "miners commands")
+        ("trace", "trace commands");
 
     vector<po::variables_map> maps;
     maps.emplace_back(po::variables_map());
@@ -152,7 +153,11 @@ bool client::Options::parse(int argc, const char **argv) {
             description = "This is how it works.";
             descriptors.emplace_back(po::options_description("List Options"));
             descriptors.back().add_options()
-                ("help", "show this help message and exit.");
+                ("help", "show this help message and exit.")
+                ("min-age", po::value<int>(&peers.list.min_age),
+                    "only list peers at least this old")
+                ("max-age", po::value<int>(&peers.list.max_age),
+                    "only list peers at most this old");
 
             positions.emplace_back(po::positional_options_description());
 
@@ -249,7 +254,8 @@ bool client::Options::parse(int argc, const char **argv) {
 
         commands.emplace_back(po::options_description("Commands"));
         commands.back().add_options()
-            ("list", "list command");
+            ("list", "list command")
+            ("watch", "watch command");
 
         options.emplace_back(vector<string>());
         while (it != parsed.options.end()) {
@@ -307,7 +313,227 @@ bool client::Options::parse(int argc, const char **argv) {
             descriptors.back().add_options()
                 ("help", "show this help message and exit.")
                 ("id", po::value<string>(&miners.list.id),
-                    "list the specific registered miner designated by the provided id");
+                    "list the specific registered miner designated by the provided id")
+                ("prefix", po::value<string>(&miners.list.prefix),
+                    "list the registered miners whose id starts with the provided prefix");
+
+            positions.emplace_back(po::positional_options_description());
+
+            options.emplace_back(vector<string>());
+            while (it != parsed.options.end()) {
+                auto begin = it->original_tokens.begin();
+                auto end = it->original_tokens.end();
+                copy(begin, end, back_inserter(options.back()));
+                it++;
+            }
+
+            maps.emplace_back(po::variables_map());
+            try {
+                po::store(
+                    po::command_line_parser(options.back())
+                        .options(descriptors.back())
+                        .positional(positions.back())
+                        .run(),
+                    maps.back()
+                );
+            } catch (exception &e) {
+                cerr << "\033[1;91m"
+                     << "error: " << e.what()
+                     << "\033[0m" << endl;
+                cout << usage(
+                    program_name,
+                    description,
+                    descriptors,
+                    positions,
+                    maps
+                ) << endl;
+                return false;
+            }
+
+            if (maps.back().count("help")) {
+                cout << usage(
+                    program_name,
+                    description,
+                    descriptors,
+                    positions,
+                    maps
+                ) << endl;
+                return false;
+            }
+
+            for (auto &vm : maps) {
+                try {
+                    po::notify(vm);
+                } catch (exception &e) {
+                    cerr << "error: " << e.what() << endl;
+                    return false;
+                }
+            }
+
+            return true;
+        } else if (cmd == "watch") {
+            program_name += " " + cmd;
+            description = "This is how it works.";
+            descriptors.emplace_back(po::options_description("Watch Options"));
+            descriptors.back().add_options()
+                ("help", "show this help message and exit.")
+                ("id", po::value<string>(&miners.watch.id),
+                    "only watch events of the miner designated by the provided id");
+
+            positions.emplace_back(po::positional_options_description());
+
+            options.emplace_back(vector<string>());
+            while (it != parsed.options.end()) {
+                auto begin = it->original_tokens.begin();
+                auto end = it->original_tokens.end();
+                copy(begin, end, back_inserter(options.back()));
+                it++;
+            }
+
+            maps.emplace_back(po::variables_map());
+            try {
+                po::store(
+                    po::command_line_parser(options.back())
+                        .options(descriptors.back())
+                        .positional(positions.back())
+                        .run(),
+                    maps.back()
+                );
+            } catch (exception &e) {
+                cerr << "\033[1;91m"
+                     << "error: " << e.what()
+                     << "\033[0m" << endl;
+                cout << usage(
+                    program_name,
+                    description,
+                    descriptors,
+                    positions,
+                    maps
+                ) << endl;
+                return false;
+            }
+
+            if (maps.back().count("help")) {
+                cout << usage(
+                    program_name,
+                    description,
+                    descriptors,
+                    positions,
+                    maps
+                ) << endl;
+                return false;
+            }
+
+            for (auto &vm : maps) {
+                try {
+                    po::notify(vm);
+                } catch (exception &e) {
+                    cerr << "error: " << e.what() << endl;
+                    return false;
+                }
+            }
+
+            return true;
+        } else if (cmd.empty()) {
+            cerr << "\033[1;91m"
+                 << "error: unspecified command"
+                 << "\033[0m" << endl;
+            cout << usage(
+                program_name,
+                description,
+                descriptors,
+                positions,
+                maps,
+                commands.back()
+            ) << endl;
+            return false;
+        } else {
+            using boost::format;
+            cerr << "\033[1;91m"
+                 << format("error: unrecognised command '%1%'") % cmd
+                 << "\033[0m" << endl;
+            cout << usage(
+                program_name,
+                description,
+                descriptors,
+                positions,
+                maps,
+                commands.back()
+            ) << endl;
+            return false;
+        }
+    } else if (cmd == "trace") {
+        program_name += " " + cmd;
+        description = "This is how it works.";
+        descriptors.emplace_back(po::options_description("Trace Options"));
+        descriptors.back().add_options()
+            ("help", "show this help message and exit.")
+            ("cmd", po::value<string>(&trace.cmd)->default_value(""));
+
+        positions.emplace_back(po::positional_options_description());
+        positions.back().add("cmd", 1).add("args", -1);
+
+        commands.emplace_back(po::options_description("Commands"));
+        commands.back().add_options()
+            ("dump", "dump command");
+
+        options.emplace_back(vector<string>());
+        while (it != parsed.options.end()) {
+            auto begin = it->original_tokens.begin();
+            auto end = it->original_tokens.end();
+            copy(begin, end, back_inserter(options.back()));
+            if (it->position_key != -1) {
+                it++;
+                break;
+            }
+            it++;
+        }
+
+        maps.emplace_back(po::variables_map());
+        try {
+            po::store(
+                po::command_line_parser(options.back())
+                    .options(descriptors.back())
+                    .positional(positions.back())
+                    .allow_unregistered()
+                    .run(),
+                maps.back()
+            );
+        } catch (exception &e) {
+            cerr << "\033[1;91m" << "error: " << e.what() << "\033[0m" << endl;
+            cout << usage(
+                program_name,
+                description,
+                descriptors,
+                positions,
+                maps,
+                commands.back()
+            ) << endl;
+            return false;
+        }
+
+        if (maps.back().count("help")) {
+            cout << usage(
+                program_name,
+                description,
+                descriptors,
+                positions,
+                maps,
+                commands.back()
+            ) << endl;
+            return false;
+        }
+
+        cmd.clear();
+        cmd = maps.back()["cmd"].as<string>();
+        if (cmd == "dump") {
+            program_name += " " + cmd;
+            description = "This is how it works.";
+            descriptors.emplace_back(po::options_description("Dump Options"));
+            descriptors.back().add_options()
+                ("help", "show this help message and exit.")
+                ("clear", po::bool_switch(&trace.dump.clear),
+                    "discard the dumped events on the node afterwards");
 
             positions.emplace_back(po::positional_options_description());
 
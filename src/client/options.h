@@ -28,17 +28,35 @@ namespace client {
         } network;
 
         struct {
+            struct {
+                int min_age = 0;
+                int max_age = 0;
+            } list;
+
             string cmd;
         } peers;
 
         struct {
             struct {
                 string id;
+                string prefix;
             } list;
 
+            struct {
+                string id;
+            } watch;
+
             string cmd;
         } miners;
 
+        struct {
+            struct {
+                bool clear = false;
+            } dump;
+
+            string cmd;
+        } trace;
+
         bool parse(int argc, const char **argv) override;
 
     private:
@@ -0,0 +1,71 @@
+#ifndef SYNCAIDE_COMMON_LRU_H
+#define SYNCAIDE_COMMON_LRU_H
+
+#include <unordered_map>
+#include <optional>
+#include <utility>
+#include <list>
+
+using namespace std;
+
+namespace common {
+    template<typename Key, typename Value>
+    class Lru {
+        using entry_type = pair<Key, Value>;
+        using iterator_type = typename list<entry_type>::iterator;
+
+    private:
+        size_t _capacity;
+        list<entry_type> _entries;
+        unordered_map<Key, iterator_type> _index;
+
+    public:
+        explicit Lru(size_t capacity) : _capacity(capacity) {
+            _index.reserve(capacity);
+        }
+
+        optional<Value> get(const Key &key) {
+            auto search = _index.find(key);
+            if (search == _index.end()) return nullopt;
+            _entries.splice(_entries.begin(), _entries, search->second);
+            return search->second->second;
+        }
+
+        void put(const Key &key, const Value &value) {
+            if (_capacity == 0) return;
+
+            auto search = _index.find(key);
+            if (search != _index.end()) {
+                search->second->second = value;
+                _entries.splice(_entries.begin(), _entries, search->second);
+                return;
+            }
+
+            if (_entries.size() >= _capacity) {
+                _index.erase(_entries.back().first);
+                _entries.pop_back();
+            }
+
+            _entries.emplace_front(key, value);
+            _index[key] = _entries.begin();
+        }
+
+        bool erase(const Key &key) {
+            auto search = _index.find(key);
+            if (search == _index.end()) return false;
+            _entries.erase(search->second);
+            _index.erase(search);
+            return true;
+        }
+
+        size_t size() const {
+            return _entries.size();
+        }
+
+        size_t capacity() const {
+            return _capacity;
+        }
+    };
+}
+
+#endif //SYNCAIDE_COMMON_LRU_H
@@ -0,0 +1,72 @@
+#include "common/placement.h"
+
+#include <pthread.h>
+#include <string_view>
+#include <system_error>
+#include <cerrno>
+
+namespace {
+    // Reads the number of at most five digits at the front of rest.
+    bool number(string_view &rest, int &value) {
+        size_t length = 0;
+        value = 0;
+        while (length < rest.size() && rest[length] >= '0' &&
+               rest[length] <= '9' && length < 5) {
+            value = value * 10 + (rest[length] - '0');
+            length++;
+        }
+        rest.remove_prefix(length);
+        return length > 0;
+    }
+}
+
+common::Placement::Placement() {
+    CPU_ZERO(&_cpus);
+}
+
+common::Placement::Placement(const string &list) : Placement() {
+    string_view rest(list);
+    while (!rest.empty()) {
+        int first, last;
+        if (!number(rest, first)) throw invalid_argument("cpu list: " + list);
+        last = first;
+        if (!rest.empty() && rest[0] == '-') {
+            rest.remove_prefix(1);
+            if (!number(rest, last)) throw invalid_argument("cpu list: " + list);
+        }
+        if (first > last || last >= CPU_SETSIZE) {
+            throw invalid_argument("cpu list: " + list);
+        }
+        for (int cpu = first; cpu <= last; cpu++) CPU_SET(cpu, &_cpus);
+
+        if (rest.empty()) break;
+        if (rest[0] != ',' || rest.size() == 1) {
+            throw invalid_argument("cpu list: " + list);
+        }
+        rest.remove_prefix(1);
+    }
+    _list = list;
+}
+
+bool common::Placement::empty() const {
+    return count() == 0;
+}
+
+size_t common::Placement::count() const {
+    return (size_t) CPU_COUNT(&_cpus);
+}
+
+const string &common::Placement::str() const {
+    return _list;
+}
+
+void common::Placement::apply() const {
+    if (empty()) return;
+    auto error = pthread_setaffinity_np(pthread_self(), sizeof(_cpus), &_cpus);
+    if (error) throw system_error(error, generic_category(), _list);
+}
+
+void common::Placement::name(const string &name) {
+    // The kernel refuses longer names instead of cutting them short.
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+}
@@ -0,0 +1,43 @@
+#ifndef SYNCAIDE_COMMON_PLACEMENT_H
+#define SYNCAIDE_COMMON_PLACEMENT_H
+
+#include <sched.h>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace common {
+    // Set of CPUs a group of threads is kept on, written the way the kernel
+    // lists them, e.g. "0-3,8". Threads started by a placed thread inherit
+    // its CPUs, so placing the first thread of a subsystem covers the ones
+    // it starts, including those libraries start behind its back.
+    class Placement {
+    private:
+        cpu_set_t _cpus;
+        string _list;
+
+    public:
+        // No CPUs, threads are left wherever the scheduler puts them.
+        Placement();
+
+        // Throws invalid_argument for anything that is not a CPU list.
+        explicit Placement(const string &list);
+
+        bool empty() const;
+
+        size_t count() const;
+
+        const string &str() const;
+
+        // Keeps the calling thread on the CPUs, throws system_error when
+        // none of them is available to the process.
+        void apply() const;
+
+        // Names the calling thread for top, perf and debuggers, which show
+        // at most the first 15 characters.
+        static void name(const string &name);
+    };
+}
+
+#endif //SYNCAIDE_COMMON_PLACEMENT_H
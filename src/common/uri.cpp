@@ -1,30 +1,61 @@
 #include "common/uri.h"
 
+#include <cstring>
+
+namespace {
+    // Splits off everything up to the first of the stop characters.
+    string_view take(string_view &rest, const char *stops) {
+        auto part = rest.substr(0, rest.find_first_of(stops));
+        rest.remove_prefix(part.size());
+        return part;
+    }
+}
+
 common::Uri::Uri(const string &source) : Uri() {
-    regex expr(
-        "(?:^(?<scheme>(?:[[:alpha:]][[:alnum:]+.-]*)*)(?::[/]{2}|[/]{2})?)"
-        "(?:(?:(?<=[/]{2})|(?<=^))(?<authority>[^/?#\\s]*)(?!(?&authority)[/]{2}))"
-        "(?<path>[^?#\\s]*)"
-        "(?:\\?(?<query>[^#\\s]*))?"
-        "(?:#(?<fragment>.*))?"
-    );
-
-    smatch match;
-    if (regex_match(source, match, expr)) {
-        _scheme = match["scheme"];
-        auto it = special_scheme.find(_scheme);
-        if (it != special_scheme.end()) {
-            _port = it->second;
+    string_view rest(source);
+
+    // A scheme only counts when "://" or "//" follows, otherwise the source
+    // starts right at the authority, as in "host:port".
+    size_t length = 0;
+    if (!rest.empty() && address::is_alpha(rest[0])) {
+        while (++length < rest.size()) {
+            auto c = rest[length];
+            if (!address::is_alnum(c) && c != '+' && c != '.' && c != '-') {
+                break;
+            }
         }
+    }
+    auto after = rest.substr(length);
+    for (auto separator : {"://", "//"}) {
+        if (after.substr(0, strlen(separator)) == separator) {
+            _scheme = rest.substr(0, length);
+            rest = after.substr(strlen(separator));
+            break;
+        }
+    }
 
-        _authority(match["authority"]);
-        _path = match["path"];
-        if (_path.empty()) _path = "/";
-        if (match["query"].matched) _query = match["query"];
-        if (match["fragment"].matched) _fragment = match["fragment"];
-        return;
+    auto authority = take(rest, "/?# \t\n\v\f\r");
+    if (rest.substr(0, 2) == "//") {
+        throw invalid_argument("Failure parsing uri.");
     }
-    throw invalid_argument("Failure parsing uri.");
+    _path = take(rest, "?# \t\n\v\f\r");
+    if (!rest.empty() && rest[0] == '?') {
+        rest.remove_prefix(1);
+        _query = take(rest, "# \t\n\v\f\r");
+    }
+    if (!rest.empty() && rest[0] == '#') {
+        _fragment = rest.substr(1);
+        rest = {};
+    }
+    if (!rest.empty()) throw invalid_argument("Failure parsing uri.");
+
+    auto it = special_scheme.find(_scheme);
+    if (it != special_scheme.end()) {
+        _port = it->second;
+    }
+
+    _authority(authority);
+    if (_path.empty()) _path = "/";
 }
 
 common::Uri::Uri(
@@ -128,55 +159,43 @@ const string &common::Uri::fragment() const {
     return _fragment;
 }
 
-void common::Uri::_authority(const string &source) {
-    regex expr(
-        "(?(DEFINE)"
-        "(?<octet>(?<!\\d)(?:[1-9]?\\d|1\\d\\d|2(?:[0-4]\\d|5[0-5]))(?!\\d))"
-        "(?<ipv4>(?:(?:(?&octet))[.]){3}(?:(?&octet)))"
-        "(?<hextet>[[:xdigit:]]{1,4})"
-        "(?<ipv6>(?:(?&hextet):){7,7}(?&hextet)|(?:(?&hextet):){1,7}:|(?:(?&hextet):){1,6}:(?&hextet)|(?:(?&hextet):){1,5}(?::(?&hextet)){1,2}|(?:(?&hextet):){1,4}(?::(?&hextet)){1,3}|(?:(?&hextet):){1,3}(?::(?&hextet)){1,4}|(?:(?&hextet):){1,2}(?::(?&hextet)){1,5}|(?&hextet):(?:(?::(?&hextet)){1,6})|:(?:(?::(?&hextet)){1,7}|:)|[fF][eE]80:(?::[[:xdigit:]]{0,4}){0,4}%[[:alnum:]]{1,}|::(?:[fF]{4}(?::0{1,4}){0,1}:){0,1}(?&ipv4)|(?:(?&hextet):){1,4}:(?&ipv4))"
-        "(?<fqdn>(?:localhost)|(?=.{1,254}$)(?:(?=[a-z0-9-]{1,63}\\.)(xn--+)?[a-z0-9]+(-[a-z0-9]+)*\\.)+[a-z]{2,63}))"
-        "^(?:(?<username>[^@:\\s]*)(?::(?<password>[^@\\s]*))?@)?"
-        "(?|(?<host>(?&ipv4))|\\[(?<host>(?&ipv6))\\]|(?<host>(?&fqdn)))"
-        "(?::(?<port>(?:0|[1-9]\\d{0,3}|[1-5]\\d{4}|6[0-4]\\d{3}|65[0-4]\\d{2}|655[0-2]\\d|6553[0-5])))?"
-    );
-
-    regex ipv4(
-        "(?(DEFINE)"
-        "(?<octet>(?<!\\d)(?:[1-9]?\\d|1\\d\\d|2(?:[0-4]\\d|5[0-5]))(?!\\d))"
-        "(?<ipv4>(?:(?:(?&octet))[.]){3}(?:(?&octet))))"
-        "^(?&ipv4)$"
-    );
-
-    regex ipv6(
-        "(?(DEFINE)"
-        "(?<octet>(?<!\\d)(?:[1-9]?\\d|1\\d\\d|2(?:[0-4]\\d|5[0-5]))(?!\\d))"
-        "(?<ipv4>(?:(?:(?&octet))[.]){3}(?:(?&octet)))"
-        "(?<hextet>[[:xdigit:]]{1,4})"
-        "(?<ipv6>(?:(?&hextet):){7,7}(?&hextet)|(?:(?&hextet):){1,7}:|(?:(?&hextet):){1,6}:(?&hextet)|(?:(?&hextet):){1,5}(?::(?&hextet)){1,2}|(?:(?&hextet):){1,4}(?::(?&hextet)){1,3}|(?:(?&hextet):){1,3}(?::(?&hextet)){1,4}|(?:(?&hextet):){1,2}(?::(?&hextet)){1,5}|(?&hextet):(?:(?::(?&hextet)){1,6})|:(?:(?::(?&hextet)){1,7}|:)|[fF][eE]80:(?::[[:xdigit:]]{0,4}){0,4}%[[:alnum:]]{1,}|::(?:[fF]{4}(?::0{1,4}){0,1}:){0,1}(?&ipv4)|(?:(?&hextet):){1,4}:(?&ipv4)))"
-        "^(?&ipv6)$"
-    );
-
-    regex fqdn(
-        "(?(DEFINE)"
-        "(?<fqdn>(?:localhost)|(?=.{1,254}$)(?:(?=[a-z0-9-]{1,63}\\.)(xn--+)?[a-z0-9]+(-[a-z0-9]+)*\\.)+[a-z]{2,63}))"
-        "^(?&fqdn)$"
-    );
-
-    smatch match;
-    if (regex_match(source, match, expr)) {
-        _host = match["host"];
-        if (regex_match(_host, ipv4)) _type = host_t::IPV4;
-        if (regex_match(_host, ipv6)) _type = host_t::IPV6;
-        if (regex_match(_host, fqdn)) _type = host_t::FQDN;
-
-        if (match["username"].matched) _username = match["username"];
-        if (match["password"].matched) _password = match["password"];
-        if (match["port"].matched)
-            _port = lexical_cast<uint16_t>(match["port"]);
-        return;
+void common::Uri::_authority(string_view source) {
+    auto at = source.find('@');
+    if (at != string_view::npos) {
+        auto userinfo = source.substr(0, at);
+        auto colon = userinfo.find(':');
+        _username = userinfo.substr(0, colon);
+        if (colon != string_view::npos) {
+            _password = userinfo.substr(colon + 1);
+        }
+        source.remove_prefix(at + 1);
+    }
+
+    string_view host;
+    if (!source.empty() && source[0] == '[') {
+        auto close = source.find(']');
+        if (close == string_view::npos) {
+            throw invalid_argument("Failure parsing authority.");
+        }
+        host = source.substr(1, close - 1);
+        if (address::is_ipv6(host)) _type = host_t::IPV6;
+        source.remove_prefix(close + 1);
+    } else {
+        host = source.substr(0, source.find(':'));
+        if (address::is_ipv4(host)) _type = host_t::IPV4;
+        else if (address::is_fqdn(host)) _type = host_t::FQDN;
+        source.remove_prefix(host.size());
+    }
+
+    if (_type == host_t::NONE) {
+        throw invalid_argument("Failure parsing authority.");
+    }
+    if (!source.empty() && (
+        source[0] != ':' || !address::parse_port(source.substr(1), _port)
+    )) {
+        throw invalid_argument("Failure parsing authority.");
     }
-    throw invalid_argument("Failure parsing authority.");
+    _host = host;
 }
 
 const string common::Uri::compose() const {
@@ -1,22 +1,232 @@
 #ifndef SYNCAIDE_COMMON_ENDPOINT_H
 #define SYNCAIDE_COMMON_ENDPOINT_H
 
-#include <boost/lexical_cast.hpp>
-#include <boost/regex.hpp>
+#include <unordered_map>
+#include <string_view>
+#include <stdexcept>
 #include <exception>
 #include <iostream>
+#include <cstdint>
 #include <string>
 
 using namespace std;
 
 namespace common {
-    using boost::lexical_cast;
-    using boost::regex_match;
-    using boost::smatch;
-    using boost::regex;
-
     enum host_t { NONE, IPV4, IPV6, FQDN };
 
+    // Validators for the pieces of an authority. They accept the same
+    // grammar the parser always has, including only lower case names, and
+    // are usable in constant expressions.
+    namespace address {
+        constexpr bool is_digit(char c) {
+            return c >= '0' && c <= '9';
+        }
+
+        constexpr bool is_lower(char c) {
+            return c >= 'a' && c <= 'z';
+        }
+
+        constexpr bool is_alpha(char c) {
+            return is_lower(c) || (c >= 'A' && c <= 'Z');
+        }
+
+        constexpr bool is_alnum(char c) {
+            return is_alpha(c) || is_digit(c);
+        }
+
+        constexpr bool is_xdigit(char c) {
+            return is_digit(c) ||
+                   (c >= 'a' && c <= 'f') ||
+                   (c >= 'A' && c <= 'F');
+        }
+
+        // Length of the run of up to four hex digits at the start.
+        constexpr size_t hextet(string_view source) {
+            size_t i = 0;
+            while (i < source.size() && i < 4 && is_xdigit(source[i])) i++;
+            return i;
+        }
+
+        // Dotted quad of decimal octets without leading zeros.
+        constexpr bool is_ipv4(string_view source) {
+            size_t i = 0;
+            for (int octet = 0; octet < 4; octet++) {
+                if (octet > 0) {
+                    if (i == source.size() || source[i] != '.') return false;
+                    i++;
+                }
+
+                size_t start = i;
+                unsigned value = 0;
+                while (i < source.size() && i - start < 3 &&
+                       is_digit(source[i])) {
+                    value = value * 10 + (source[i++] - '0');
+                }
+                if (i == start || value > 255) return false;
+                if (i - start > 1 && source[start] == '0') return false;
+            }
+            return i == source.size();
+        }
+
+        // Eight groups, or fewer around a single "::".
+        constexpr bool is_ipv6_hex(string_view source) {
+            size_t i = 0;
+            size_t groups = 0;
+            bool compressed = false;
+            if (source.substr(0, 2) == "::") {
+                if (source.size() == 2) return true;
+                compressed = true;
+                i = 2;
+            }
+
+            for (;;) {
+                auto length = hextet(source.substr(i));
+                if (length == 0) return false;
+                i += length;
+                groups++;
+                if (i == source.size()) break;
+                if (source[i++] != ':') return false;
+                if (i < source.size() && source[i] == ':') {
+                    if (compressed) return false;
+                    compressed = true;
+                    if (++i == source.size()) break;
+                } else if (i == source.size()) {
+                    return false;
+                }
+            }
+            return compressed ? groups <= 7 : groups == 8;
+        }
+
+        // IPv4 tail behind "::", "::ffff:", "::ffff:0:" or one to four
+        // groups followed by "::".
+        constexpr bool is_ipv6_mapped(string_view source) {
+            auto split = source.rfind(':');
+            if (split == string_view::npos) return false;
+            if (!is_ipv4(source.substr(split + 1))) return false;
+
+            auto head = source.substr(0, split + 1);
+            if (head.substr(0, 2) == "::") {
+                head.remove_prefix(2);
+                if (head.empty()) return true;
+                if (head.size() < 5 || head[4] != ':') return false;
+                for (size_t i = 0; i < 4; i++) {
+                    if (head[i] != 'f' && head[i] != 'F') return false;
+                }
+
+                head.remove_prefix(5);
+                if (head.empty()) return true;
+                size_t zeros = 0;
+                while (zeros < head.size() && head[zeros] == '0') zeros++;
+                return zeros >= 1 && zeros <= 4 &&
+                       head.size() == zeros + 1;
+            }
+
+            if (head.size() < 2 || head[head.size() - 2] != ':') return false;
+            head.remove_suffix(1);
+            size_t groups = 0;
+            while (!head.empty()) {
+                auto length = hextet(head);
+                if (length == 0 || length == head.size()) return false;
+                if (head[length] != ':') return false;
+                head.remove_prefix(length + 1);
+                groups++;
+            }
+            return groups >= 1 && groups <= 4;
+        }
+
+        // Link-local address with a zone, as in "fe80::1%eth0".
+        constexpr bool is_ipv6_scoped(string_view source) {
+            auto split = source.find('%');
+            auto zone = source.substr(split + 1);
+            if (zone.empty()) return false;
+            for (auto c : zone) {
+                if (!is_alnum(c)) return false;
+            }
+
+            auto head = source.substr(0, split);
+            if (head.size() < 5 ||
+                (head[0] != 'f' && head[0] != 'F') ||
+                (head[1] != 'e' && head[1] != 'E') ||
+                head.substr(2, 3) != "80:") {
+                return false;
+            }
+
+            head.remove_prefix(5);
+            for (int groups = 0; !head.empty(); groups++) {
+                if (groups == 4 || head[0] != ':') return false;
+                head.remove_prefix(1 + hextet(head.substr(1)));
+            }
+            return true;
+        }
+
+        constexpr bool is_ipv6(string_view source) {
+            if (source.find('%') != string_view::npos) {
+                return is_ipv6_scoped(source);
+            }
+            if (source.find('.') != string_view::npos) {
+                return is_ipv6_mapped(source);
+            }
+            return is_ipv6_hex(source);
+        }
+
+        // Lower case labels joined by dots, no leading, trailing or doubled
+        // hyphens, except the "xn--" prefix of punycode.
+        constexpr bool is_label(string_view source) {
+            if (source.empty() || source.size() > 63) return false;
+            if (source.substr(0, 4) == "xn--") {
+                auto rest = source.find_first_not_of('-', 4);
+                if (rest == string_view::npos) return false;
+                source.remove_prefix(rest);
+            }
+
+            if (source.front() == '-' || source.back() == '-') return false;
+            for (size_t i = 0; i < source.size(); i++) {
+                if (source[i] == '-') {
+                    if (source[i + 1] == '-') return false;
+                } else if (!is_lower(source[i]) && !is_digit(source[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        constexpr bool is_fqdn(string_view source) {
+            if (source == "localhost") return true;
+            if (source.size() > 254) return false;
+
+            auto split = source.rfind('.');
+            if (split == string_view::npos) return false;
+            auto top = source.substr(split + 1);
+            if (top.size() < 2 || top.size() > 63) return false;
+            for (auto c : top) {
+                if (!is_lower(c)) return false;
+            }
+
+            source.remove_suffix(top.size() + 1);
+            for (;;) {
+                auto dot = source.find('.');
+                if (!is_label(source.substr(0, dot))) return false;
+                if (dot == string_view::npos) return true;
+                source.remove_prefix(dot + 1);
+            }
+        }
+
+        // Decimal without leading zeros, up to 65535.
+        constexpr bool parse_port(string_view source, uint16_t &port) {
+            if (source.empty() || source.size() > 5) return false;
+            if (source.size() > 1 && source[0] == '0') return false;
+
+            uint32_t value = 0;
+            for (auto c : source) {
+                if (!is_digit(c)) return false;
+                value = value * 10 + (c - '0');
+            }
+            if (value > 65535) return false;
+            port = (uint16_t) value;
+            return true;
+        }
+    }
+
     static const unordered_map<string, uint16_t> special_scheme{ // NOLINT
         {"ftp", 21},
         {"http", 80},
@@ -133,7 +343,7 @@ namespace common {
         bool is_tls() const;
 
     private:
-        void _authority(const string &source);
+        void _authority(string_view source);
     };
 }
 
@@ -1,7 +1,15 @@
+#include <cryptopp/sha.h>
+#include <cryptopp/hex.h>
+#include <cryptopp/files.h>
+#include <cryptopp/filters.h>
 #include <boost/filesystem.hpp>
 #include <boost/dll.hpp>
 #include <fmt/format.h>
+#include <algorithm>
 #include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
 
 using namespace std;
 namespace fs = boost::filesystem;
@@ -22,6 +30,16 @@ private:
     const char **_argv;
 };
 
+// Escapes a string for a double quoted C or assembler literal.
+string escape(const string &source) {
+    string output;
+    for (auto c : source) {
+        if (c == '\\' || c == '"') output += '\\';
+        output += c;
+    }
+    return output;
+}
+
 int main(int argc, const char **argv) {
     if (argc < 2) {
         string program_name = program_location().stem().string();
@@ -32,45 +50,79 @@ int main(int argc, const char **argv) {
         return EXIT_FAILURE;
     }
 
+    vector<fs::path> filepaths;
+    for (const char *each : args(argc, argv)) {
+        filepaths.emplace_back(fs::canonical(fs::path(each)));
+    }
+    sort(filepaths.begin(), filepaths.end(), [](auto &a, auto &b) {
+        return a.filename() < b.filename();
+    });
+
+    // The bytes are pulled in by the assembler with .incbin instead of being
+    // spelled out as array literals, which kept the compiler busy for ages
+    // on the wasm binary. Each one gets a trailing zero so the data can be
+    // handed to C APIs as is.
     ofstream ofs("resources.cpp");
-    ofs << "#include <map>" << endl;
-    ofs << "#include <vector>" << endl;
-    ofs << "#include <string>" << endl;
-    ofs << endl;
-    ofs << "using namespace std;" << endl;
+    ofs << "#include \"resources.h\"" << endl;
     ofs << endl;
-    ofs << "map<string, vector<unsigned char>> resources{" << endl;
 
-    for (const char *each : args(argc, argv)) {
-        fs::path filepath(fs::canonical(fs::path(each)));
-        string filename = filepath.filename().string();
-        ofs << fmt::format("{{\"{0}\", {{", filename) << endl;
-
-        ifstream ifs(filepath.string(), ios::binary);
-        ifs.unsetf(ios::skipws);
-        ifs.seekg(0, ios::end);
-        streampos pos = ifs.tellg();
-        ifs.seekg(0, ios::beg);
+    vector<string> entries;
+    for (size_t i = 0; i < filepaths.size(); i++) {
+        auto &filepath = filepaths[i];
+        string symbol = fmt::format("syncaide_resource_{}", i);
+        ofs << "__asm__(" << endl;
+        ofs << "    \".section .rodata,\\\"a\\\",@progbits\\n\"" << endl;
+        ofs << "    \".balign 64\\n\"" << endl;
+        ofs << fmt::format("    \".global {0}\\n\"", symbol) << endl;
+        ofs << fmt::format("    \".hidden {0}\\n\"", symbol) << endl;
+        ofs << fmt::format("    \"{0}:\\n\"", symbol) << endl;
+        ofs << fmt::format(
+            "    \".incbin \\\"{0}\\\"\\n\"",
+            escape(escape(filepath.string()))
+        ) << endl;
+        ofs << "    \".byte 0\\n\"" << endl;
+        ofs << "    \".previous\\n\"" << endl;
+        ofs << ");" << endl;
+        ofs << fmt::format("extern \"C\" const char {0}[];", symbol) << endl;
+        ofs << endl;
 
-        vector<unsigned char> data;
-        data.reserve((size_t) pos);
-        data.insert(data.begin(),
-            istream_iterator<unsigned char>(ifs),
-            istream_iterator<unsigned char>()
+        string digest;
+        CryptoPP::SHA256 sha256sum;
+        CryptoPP::FileSource(
+            filepath.string().c_str(), true,
+            new CryptoPP::HashFilter(
+                sha256sum,
+                new CryptoPP::HexEncoder(
+                    new CryptoPP::StringSink(digest),
+                    false
+                )
+            )
         );
 
-        unsigned int count = 0;
-        for (auto &byte : data) {
-            count = (count + 1) % 10;
-            ofs << fmt::format("0x{:0=2x}, ", byte);
-            if (count == 0) {
-                ofs << endl;
-            }
-        }
-
-        ofs << "}}," << endl;
+        entries.emplace_back(fmt::format(
+            "{{\"{0}\", {{{1}, {2}}}, \"{3}\"}}",
+            escape(filepath.filename().string()),
+            symbol,
+            fs::file_size(filepath),
+            digest
+        ));
     }
 
-    ofs << "};" << endl;
+    ofs << "namespace resources {" << endl;
+    ofs << "    constexpr Resource index[] = {" << endl;
+    for (auto &each : entries) {
+        ofs << "        " << each << "," << endl;
+    }
+    ofs << "    };" << endl;
+    ofs << endl;
+    ofs << "    constexpr size_t count = sizeof(index) / sizeof(Resource);" << endl;
+    ofs << endl;
+    ofs << "    const Resource *find(string_view name) {" << endl;
+    ofs << "        for (size_t i = 0; i < count; i++) {" << endl;
+    ofs << "            if (index[i].name == name) return &index[i];" << endl;
+    ofs << "        }" << endl;
+    ofs << "        return nullptr;" << endl;
+    ofs << "    }" << endl;
+    ofs << "}" << endl;
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -1,76 +1,150 @@
 #include "logging.h"
 
+#include <fmt/format.h>
+#include <unistd.h>
+
 Logging logger; // NOLINT
 
 Logging::Logging() {
-    typedef sinks::synchronous_sink<sinks::text_ostream_backend> text_sink;
-    boost::shared_ptr<text_sink> sink(new text_sink);
-
-    text_sink::locked_backend_ptr backend = (*(&sink))->locked_backend();
+    _backend = boost::make_shared<Backend>(clog);
+    _sink = boost::make_shared<sink_type>(_backend);
 
-    boost::shared_ptr<ostream> console(&clog, boost::null_deleter());
-    (*(&backend))->add_stream(console);
+    // Colors are only for people watching a terminal, anything collecting
+    // the output gets plain json lines.
+    bool colored = isatty(STDERR_FILENO) == 1;
+    _sink->set_formatter(bind(
+        &formatter,
+        placeholders::_1,
+        placeholders::_2,
+        colored
+    ));
 
-    (*(&sink))->set_formatter(&formatter);
+    _sink->backend = _backend.get();
 
     boost::shared_ptr<logging::core> core = logging::core::get();
 
-    core->add_sink((*(&sink)));
+    core->add_sink(_sink);
 
     core->add_global_attribute("TimeStamp", attrs::local_clock());
 }
 
+Logging::~Logging() {
+    logging::core::get()->remove_sink(_sink);
+    _sink->stop();
+    _sink->flush();
+}
+
 auto &Logging::get() {
     return _slg;
 }
 
+void Logging::flush() {
+    _sink->flush();
+}
+
+Logging::Backend::Backend(ostream &stream) : _stream(stream) {
+    _batch.reserve(limit);
+}
+
+void Logging::Backend::consume(
+    const logging::record_view &,
+    const string &line
+) {
+    _batch.append(line);
+    _batch.push_back('\n');
+    if (_batch.size() >= limit) flush();
+}
+
+void Logging::Backend::flush() {
+    if (_batch.empty()) return;
+    _stream.write(_batch.data(), _batch.size());
+    _stream.flush();
+    _batch.clear();
+}
+
 void Logging::formatter(
     const logging::record_view &record,
-    logging::formatting_ostream &stream
+    logging::formatting_ostream &stream,
+    bool colored
 ) {
     using namespace srcs;
     using namespace boost::posix_time;
-    using json = nlohmann::basic_json<fifo_map>;
-
-    switch (record[logging::trivial::severity].get()) {
-        case severity_level::trace:
-            stream << "\033[94m";
-            break;
-        case severity_level::debug:
-            stream << "\033[94m";
-            break;
-        case severity_level::info:
-            stream << "\033[0m";
-            break;
-        case severity_level::warning:
-            stream << "\033[93m";
-            break;
-        case severity_level::error:
-            stream << "\033[91m";
-            break;
-        case severity_level::fatal:
-            stream << "\033[101m";
-            break;
+    using json = nlohmann::json;
+
+    auto severity = record[logging::trivial::severity].get();
+    if (colored) {
+        switch (severity) {
+            case severity_level::trace:
+                stream << "\033[94m";
+                break;
+            case severity_level::debug:
+                stream << "\033[94m";
+                break;
+            case severity_level::info:
+                stream << "\033[0m";
+                break;
+            case severity_level::warning:
+                stream << "\033[93m";
+                break;
+            case severity_level::error:
+                stream << "\033[91m";
+                break;
+            case severity_level::fatal:
+                stream << "\033[101m";
+                break;
+        }
     }
 
-    auto timestamp = logging::extract<ptime>("TimeStamp", record);
-    json entry;
-    entry["timestamp"] = to_simple_string(timestamp.get());
-    entry["severity"] = to_string(record[logging::trivial::severity].get());
+    // Same as to_simple_string, which goes through a stringstream.
+    auto timestamp = logging::extract<ptime>("TimeStamp", record).get();
+    auto date = timestamp.date();
+    auto time = timestamp.time_of_day();
+    stream << fmt::format(
+        R"({{"timestamp":"{:04}-{}-{:02} {:02}:{:02}:{:02})",
+        (int) date.year(),
+        date.month().as_short_string(),
+        (int) date.day(),
+        time.hours(),
+        time.minutes(),
+        time.seconds()
+    );
+    if (time.fractional_seconds() != 0) {
+        stream << fmt::format(
+            ".{:0{}}",
+            time.fractional_seconds(),
+            time_duration::num_fractional_digits()
+        );
+    }
+    stream << R"(","severity":")" << to_string(severity) << '"';
 
-    auto extra = logging::extract<string>("Extra", record);
-    if (extra) {
-        auto parse = json::parse(extra.get());
-        for (json::iterator it = parse.begin(); it != parse.end(); ++it) {
-            entry[it.key()] = it.value();
+    // Extra fields go in between as one dump with its braces dropped. Ones
+    // named like the fields written here are left out, the message given to
+    // the stream takes the place of a message field.
+    string message = string(record[exprs::smessage].get());
+    auto extra = logging::extract<json>("Extra", record);
+    if (extra && extra.get().is_object() && !extra.get().empty()) {
+        string fields;
+        auto &value = extra.get();
+        if (value.count("timestamp") || value.count("severity") ||
+            (value.count("message") && !message.empty())) {
+            json copy = value;
+            copy.erase("timestamp");
+            copy.erase("severity");
+            if (!message.empty()) copy.erase("message");
+            fields = copy.dump();
+        } else {
+            fields = value.dump();
+        }
+        if (fields.size() > 2) {
+            stream << ',';
+            stream.write(fields.data() + 1, fields.size() - 2);
         }
     }
 
-    string message = string(record[exprs::smessage].get());
     if (!message.empty()) {
-        entry["message"] = message;
+        stream << R"(,"message":)" << json(message).dump();
     }
+    stream << '}';
 
-    stream << entry.dump();
-    stream << "\033[0m";
+    if (colored) stream << "\033[0m";
 }
\ No newline at end of file
@@ -5,17 +5,20 @@
 #include <boost/log/expressions.hpp>
 #include <boost/log/attributes/clock.hpp>
 #include <boost/log/attributes/constant.hpp>
-#include <boost/log/sinks/sync_frontend.hpp>
-#include <boost/log/sinks/text_ostream_backend.hpp>
+#include <boost/log/sinks/async_frontend.hpp>
+#include <boost/log/sinks/basic_sink_backend.hpp>
+#include <boost/log/sinks/bounded_fifo_queue.hpp>
+#include <boost/log/sinks/block_on_overflow.hpp>
 #include <boost/log/support/date_time.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/date_time/posix_time/posix_time_io.hpp>
 #include <boost/log/utility/manipulators/add_value.hpp>
-#include <boost/core/null_deleter.hpp>
 #include <boost/make_shared.hpp>
 #include <nlohmann/json.hpp>
-#include <nlohmann/fifo_map.hpp>
+#include <functional>
+#include <atomic>
 #include <iostream>
+#include <string>
 
 namespace logging = boost::log;
 namespace srcs = logging::sources;
@@ -28,24 +31,76 @@ namespace trivial = logging::trivial;
 using namespace std;
 using namespace trivial;
 
-template<class K, class V, class dummy_compare, class A>
-using fifo_map = nlohmann::fifo_map<K, V, nlohmann::fifo_map_compare<K>, A>;
-
+// Extra fields are attached as json values, e.g.
+// LOG(info) << logging::add_value("Extra", move(extra)) << "message.";
+// and only serialized once the record is written out.
 #define LOG(lvl) BOOST_LOG_SEV(logger::get(), trivial::lvl)
 
 class Logging {
+public:
+    // Collects formatted records and writes them to the stream together,
+    // once enough piled up or whenever the queue in front of it runs dry.
+    class Backend : public sinks::basic_formatted_sink_backend<
+        char,
+        sinks::synchronized_feeding
+    > {
+    private:
+        ostream &_stream;
+        string _batch;
+
+    public:
+        static constexpr size_t limit = 64 * 1024;
+
+        explicit Backend(ostream &stream);
+
+        void consume(const logging::record_view &record, const string &line);
+
+        void flush();
+    };
+
+    // Bounded queue the logging threads hand records to. Once it is full
+    // they wait for the writer to catch up rather than lose records.
+    class Queue : public sinks::bounded_fifo_queue<
+        4096,
+        sinks::block_on_overflow
+    > {
+    private:
+        typedef sinks::bounded_fifo_queue<4096, sinks::block_on_overflow> base;
+
+    public:
+        // Set once the sink is up, the writer may already be waiting.
+        atomic<Backend *> backend{nullptr};
+
+        bool dequeue_ready(logging::record_view &record) {
+            if (base::try_dequeue_ready(record)) return true;
+            auto idle = backend.load();
+            if (idle) idle->flush();
+            return base::dequeue_ready(record);
+        }
+    };
+
 private:
+    typedef sinks::asynchronous_sink<Backend, Queue> sink_type;
+
     srcs::severity_logger_mt<trivial::severity_level> _slg;
+    boost::shared_ptr<Backend> _backend;
+    boost::shared_ptr<sink_type> _sink;
 
 public:
     Logging();
 
+    ~Logging();
+
     auto &get();
 
+    // Blocks until everything logged so far has been written.
+    void flush();
+
 private:
     static void formatter(
         logging::record_view const &rec,
-        logging::formatting_ostream &strm
+        logging::formatting_ostream &strm,
+        bool colored
     );
 };
 
@@ -0,0 +1,27 @@
+#ifndef SYNCAIDE_RESOURCES_H
+#define SYNCAIDE_RESOURCES_H
+
+#include <string_view>
+#include <cstddef>
+
+using namespace std;
+
+// Files compiled into syncaided by the embedder. The bytes are included as
+// raw read-only sections, so nothing is copied or allocated at startup and
+// the index below is initialized at compile time.
+namespace resources {
+    struct Resource {
+        string_view name;
+        string_view data;
+        // Lower case hex sha256 of the data, computed when embedding.
+        string_view digest;
+    };
+
+    extern const Resource index[];
+
+    extern const size_t count;
+
+    const Resource *find(string_view name);
+}
+
+#endif //SYNCAIDE_RESOURCES_H
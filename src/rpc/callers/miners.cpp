@@ -2,24 +2,104 @@
 #include "rpc/callers/miners.h"
 
 rpc::response<nlohmann::json>
-rpc::callers::MinersCaller::list(const string &id) {
-    grpc::ClientContext context;
-    miners::ListRequest request;
-    miners::ListResponse response;
+rpc::callers::MinersCaller::list(const string &id, const string &prefix) {
+    json result = json::array();
+    grpc::Status status;
+    string token;
 
-    request.set_id(id);
-    grpc::Status status = stub->list(&context, request, &response);
+    do {
+        grpc::ClientContext context;
+        miners::ListRequest request;
+        miners::ListResponse response;
+
+        request.set_id(id);
+        request.set_prefix(prefix);
+        request.set_page_token(token);
+        status = stub->list(&context, request, &response);
+        if (!status.ok()) break;
 
-    json result = json::array();
-    if (status.ok()) {
         auto miners = response.miners();
         auto it = miners.begin();
         while (it != miners.end()) {
             result.emplace_back(json({
-                {"id", it->id()}
+                {"id", it->id()},
+                {"node", it->node()}
             }));
             it++;
         }
+        token = response.next_page_token();
+    } while (!token.empty());
+    return {status, result};
+}
+
+void rpc::callers::MinersCaller::announce(
+    const string &node,
+    const vector<string> &connected,
+    const vector<string> &disconnected,
+    chrono::milliseconds deadline,
+    grpc::CompletionQueue &queue,
+    announce_handler handler
+) {
+    auto call = new Pending<miners::AnnounceResponse>();
+    miners::AnnounceRequest request;
+
+    call->context.set_deadline(chrono::system_clock::now() + deadline);
+    call->handler = [handler](auto &status, auto &) {
+        handler(status);
+    };
+
+    request.set_node(node);
+    for (const auto &each : connected) request.add_connected(each);
+    for (const auto &each : disconnected) request.add_disconnected(each);
+
+    call->reader = stub->Asyncannounce(&call->context, request, &queue);
+    call->reader->Finish(&call->response, &call->status, call);
+}
+
+rpc::response<string>
+rpc::callers::MinersCaller::locate(
+    const string &id,
+    chrono::milliseconds deadline
+) {
+    grpc::ClientContext context;
+    miners::LocateRequest request;
+    miners::LocateResponse response;
+
+    context.set_deadline(chrono::system_clock::now() + deadline);
+    request.set_id(id);
+
+    grpc::Status status = stub->locate(&context, request, &response);
+
+    string result;
+    if (status.ok() && response.miners_size() > 0) {
+        result = response.miners(0).node();
     }
     return {status, result};
 }
+
+grpc::Status rpc::callers::MinersCaller::watch(
+    const string &id,
+    const function<void(const json &)> &handler
+) {
+    static const char *types[] = {
+        "reset", "snapshot", "synced", "connect", "login", "disconnect"
+    };
+
+    grpc::ClientContext context;
+    miners::WatchRequest request;
+    miners::Event event;
+
+    request.set_id(id);
+    auto reader = stub->watch(&context, request);
+    while (reader->Read(&event)) {
+        // A newer node may send types this build does not know about.
+        auto type = (size_t) event.type();
+        json result = {{"event", type < size(types) ? types[type] : "unknown"}};
+        if (event.has_miner()) {
+            result["id"] = event.miner().id();
+            result["node"] = event.miner().node();
+        }
+        handler(result);
+    }
+    return reader->Finish();
+}
\ No newline at end of file
@@ -5,7 +5,11 @@
 #include "rpc/helper.h"
 
 #include <nlohmann/json.hpp>
+#include <functional>
+#include <iterator>
+#include <chrono>
 #include <string>
+#include <vector>
 
 using namespace std;
 
@@ -15,6 +19,8 @@ namespace rpc {
         using nlohmann::json;
 
         class MinersCaller {
+            using announce_handler = function<void(const grpc::Status &)>;
+
         private:
             unique_ptr<miners::Miners::Stub> stub;
 
@@ -23,7 +29,31 @@ namespace rpc {
                 const shared_ptr<grpc::ChannelInterface> &channel
             ) : stub(miners::Miners::NewStub(channel)) {}
 
-            response<json> list(const string &id);
+            response<json> list(
+                const string &id,
+                const string &prefix = string()
+            );
+
+            // Returns right away, the handler is told on the queue how the
+            // call went.
+            void announce(
+                const string &node,
+                const vector<string> &connected,
+                const vector<string> &disconnected,
+                chrono::milliseconds deadline,
+                grpc::CompletionQueue &queue,
+                announce_handler handler
+            );
+
+            response<string> locate(
+                const string &id,
+                chrono::milliseconds deadline
+            );
+
+            grpc::Status watch(
+                const string &id,
+                const function<void(const json &)> &handler
+            );
         };
     }
 }
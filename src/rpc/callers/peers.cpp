@@ -4,12 +4,14 @@
 rpc::response<deque<Peer>>
 rpc::callers::PeersCaller::gossip(
     const deque<Peer> &buffer,
-    const string &remove
+    const string &remove,
+    chrono::milliseconds deadline
 ) {
     grpc::ClientContext context;
     peers::GossipRequest request;
     peers::GossipResponse response;
 
+    context.set_deadline(chrono::system_clock::now() + deadline);
     for (const auto &each : buffer) {
         request.add_peers(each.addr());
     }
@@ -31,15 +33,24 @@ rpc::callers::PeersCaller::gossip(
 }
 
 rpc::response<nlohmann::json>
-rpc::callers::PeersCaller::list() {
-    grpc::ClientContext context;
-    peers::ListRequest request;
-    peers::ListResponse response;
+rpc::callers::PeersCaller::list(int min_age, int max_age) {
+    json result = json::array();
+    grpc::Status status;
+    string token;
 
-    grpc::Status status = stub->list(&context, request, &response);
+    // Pages are fetched until the node reports no more, the caller sees a
+    // single list either way.
+    do {
+        grpc::ClientContext context;
+        peers::ListRequest request;
+        peers::ListResponse response;
+
+        request.set_page_token(token);
+        request.set_min_age(min_age);
+        request.set_max_age(max_age);
+        status = stub->list(&context, request, &response);
+        if (!status.ok()) break;
 
-    json result = json::array();
-    if (status.ok()) {
         auto peers = response.peers();
         auto it = peers.begin();
         while (it != peers.end()) {
@@ -49,6 +60,7 @@ rpc::callers::PeersCaller::list() {
             }));
             it++;
         }
-    }
+        token = response.next_page_token();
+    } while (!token.empty());
     return {status, result};
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "rpc/helper.h"
 #include "peer.h"
 
+#include <chrono>
 #include <string>
 #include <tuple>
 #include <deque>
@@ -25,11 +26,12 @@ namespace rpc {
             ) : stub(peers::Peers::NewStub(channel)) {}
 
             response<deque<Peer>> gossip(
-                const deque<Peer> &buffer = deque<Peer>(),
-                const string &remove = string()
+                const deque<Peer> &buffer,
+                const string &remove,
+                chrono::milliseconds deadline
             );
 
-            response<json> list();
+            response<json> list(int min_age = 0, int max_age = 0);
         };
     }
 }
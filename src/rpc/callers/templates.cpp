@@ -0,0 +1,39 @@
+#include "logging.h"
+#include "rpc/callers/templates.h"
+
+void rpc::callers::TemplatesCaller::push(
+    const string &origin,
+    uint64_t beat,
+    uint64_t sequence,
+    const string &digest,
+    const server::Template *block,
+    chrono::milliseconds deadline,
+    grpc::CompletionQueue &queue,
+    push_handler handler
+) {
+    auto call = new Pending<templates::PushResponse>();
+    templates::PushRequest request;
+
+    call->context.set_deadline(chrono::system_clock::now() + deadline);
+    call->handler = [handler](auto &status, auto &response) {
+        handler(status, response.missing());
+    };
+
+    request.set_origin(origin);
+    request.set_sequence(sequence);
+    request.set_beat(beat);
+    request.set_digest(digest);
+    if (block) {
+        protos::Template *each = request.mutable_block();
+        each->set_height(block->height());
+        each->set_difficulty(block->difficulty());
+        each->set_reward(block->reward());
+        each->set_reserved_offset(block->reserved_offset());
+        each->set_prev_hash(block->prev_hash().data(), block->prev_hash().size());
+        each->set_seed_hash(block->seed_hash().data(), block->seed_hash().size());
+        each->set_blob(block->blob());
+    }
+
+    call->reader = stub->Asyncpush(&call->context, request, &queue);
+    call->reader->Finish(&call->response, &call->status, call);
+}
@@ -0,0 +1,46 @@
+#ifndef SYNCAIDE_RPC_CALLERS_TEMPLATES_H
+#define SYNCAIDE_RPC_CALLERS_TEMPLATES_H
+
+#include "protos/templates.grpc.pb.h"
+#include "server/template.h"
+#include "rpc/helper.h"
+
+#include <functional>
+#include <chrono>
+#include <string>
+
+using namespace std;
+
+namespace rpc {
+    namespace callers {
+        namespace templates = protos::templates;
+
+        class TemplatesCaller {
+            using push_handler = function<void(const grpc::Status &, bool)>;
+
+        private:
+            unique_ptr<templates::Templates::Stub> stub;
+
+        public:
+            explicit TemplatesCaller(
+                const shared_ptr<grpc::ChannelInterface> &channel
+            ) : stub(templates::Templates::NewStub(channel)) {}
+
+            // Returns right away, the handler is told on the queue whether
+            // the peer is missing the block. A null block only sends the
+            // digest.
+            void push(
+                const string &origin,
+                uint64_t beat,
+                uint64_t sequence,
+                const string &digest,
+                const server::Template *block,
+                chrono::milliseconds deadline,
+                grpc::CompletionQueue &queue,
+                push_handler handler
+            );
+        };
+    }
+}
+
+#endif //SYNCAIDE_RPC_CALLERS_TEMPLATES_H
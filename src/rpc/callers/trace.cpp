@@ -0,0 +1,14 @@
+#include "logging.h"
+#include "rpc/callers/trace.h"
+
+rpc::response<nlohmann::json>
+rpc::callers::TraceCaller::dump(bool clear) {
+    grpc::ClientContext context;
+    trace::DumpRequest request;
+    trace::DumpResponse response;
+
+    request.set_clear(clear);
+    grpc::Status status = stub->dump(&context, request, &response);
+    if (!status.ok()) return {status, nullopt};
+    return {status, json::parse(response.events(), nullptr, false)};
+}
@@ -0,0 +1,29 @@
+#ifndef SYNCAIDE_RPC_CALLERS_TRACE_H
+#define SYNCAIDE_RPC_CALLERS_TRACE_H
+
+#include "protos/trace.grpc.pb.h"
+#include "rpc/helper.h"
+
+#include <string>
+
+using namespace std;
+
+namespace rpc {
+    namespace callers {
+        namespace trace = protos::trace;
+
+        class TraceCaller {
+        private:
+            unique_ptr<trace::Trace::Stub> stub;
+
+        public:
+            explicit TraceCaller(
+                const shared_ptr<grpc::ChannelInterface> &channel
+            ) : stub(trace::Trace::NewStub(channel)) {}
+
+            response<json> dump(bool clear = false);
+        };
+    }
+}
+
+#endif //SYNCAIDE_RPC_CALLERS_TRACE_H
@@ -13,5 +13,19 @@ void rpc::log(const string &msg, const string &peer, const json &details) {
     if (scheme != "unix") result["addr"] = netloc;
     else result["addr"] = "unix:socket";
     if (!details.empty()) result["details"] = details;
-    LOG(info) << logging::add_value("Extra", result.dump());
+    LOG(info) << logging::add_value("Extra", move(result));
+}
+
+void rpc::drain(grpc::CompletionQueue &queue) {
+    void *tag;
+    bool ok;
+    while (queue.Next(&tag, &ok)) {
+        unique_ptr<Call> call(static_cast<Call *>(tag));
+        call->finish();
+    }
+}
+
+size_t rpc::page_size(uint32_t requested) {
+    if (requested == 0) return page_default;
+    return min((size_t) requested, (size_t) page_limit);
 }
\ No newline at end of file
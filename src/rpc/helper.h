@@ -3,7 +3,10 @@
 
 #include <nlohmann/json.hpp>
 #include <grpc++/grpc++.h>
+#include <algorithm>
+#include <functional>
 #include <optional>
+#include <cstdint>
 #include <string>
 
 using namespace std;
@@ -14,11 +17,50 @@ namespace rpc {
     template<typename Type>
     using response = tuple<grpc::Status, optional<Type>>;
 
+    // Lists are served in pages small enough to stay well clear of the
+    // gRPC message size limit. A page token is the key of the last entry
+    // of the previous page, entries are returned in key order.
+    enum page {
+        page_default = 100,
+        page_limit = 1000
+    };
+
+    // Unary call in flight on a completion queue, whose tag it is. Calls
+    // are made on the heap and drain() hands each one its reply and frees
+    // it, so whoever starts one never waits for the peer.
+    class Call {
+    public:
+        grpc::ClientContext context;
+        grpc::Status status;
+
+        virtual ~Call() = default;
+
+        virtual void finish() = 0;
+    };
+
+    template<typename Response>
+    class Pending : public Call {
+    public:
+        Response response;
+        unique_ptr<grpc::ClientAsyncResponseReader<Response>> reader;
+        function<void(const grpc::Status &, const Response &)> handler;
+
+        void finish() override {
+            if (handler) handler(status, response);
+        }
+    };
+
+    // Finishes calls as they complete until the queue is shut down and
+    // the last of them is done.
+    void drain(grpc::CompletionQueue &queue);
+
     void log(
         const string &msg,
         const string &peer,
         const json &details = json()
     );
+
+    size_t page_size(uint32_t requested);
 };
 
 #endif //SYNCAIDE_RPC_H
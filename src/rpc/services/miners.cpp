@@ -11,12 +11,111 @@ grpc::Status rpc::services::MinersService::list(
 ) {
     json details;
     if (!request->id().empty()) details["id"] = request->id();
+    if (!request->prefix().empty()) details["prefix"] = request->prefix();
+    if (!request->page_token().empty()) details["after"] = request->page_token();
     log("/miners/find", context->peer(), details);
 
-    auto miners = _server.frontend()->miners.list(request->id());
+    auto self = _server.cfg().network.advertise.netloc();
+    auto &registry = _server.frontend()->miners;
+    if (request->id().empty()) {
+        string next;
+        auto miners = registry.page(
+            request->prefix(),
+            request->page_token(),
+            page_size(request->page_size()),
+            next
+        );
+        for (const auto &each : miners) {
+            protos::Miner *miner = response->add_miners();
+            miner->set_id(each->id());
+            miner->set_node(self);
+        }
+        response->set_next_page_token(next);
+        return grpc::Status::OK;
+    }
+
+    auto miners = registry.list(request->id());
     for (const auto &each : miners) {
         protos::Miner *miner = response->add_miners();
         miner->set_id(each->id());
+        miner->set_node(self);
+    }
+
+    // A miner connected elsewhere is looked up in the cluster directory,
+    // which costs one call to the node its id hashes onto.
+    if (miners.empty()) {
+        auto node = _server.peering()->locate(request->id());
+        if (!node.empty()) {
+            protos::Miner *miner = response->add_miners();
+            miner->set_id(request->id());
+            miner->set_node(node);
+        }
+    }
+    return grpc::Status::OK;
+}
+
+grpc::Status rpc::services::MinersService::announce(
+    grpc::ServerContext *context,
+    const miners::AnnounceRequest *request,
+    miners::AnnounceResponse *response
+) {
+    // Every node repeats its announcements every few seconds, so they are
+    // not logged one by one.
+    auto directory = _server.peering()->directory();
+    for (const auto &id : request->connected()) {
+        directory->record(id, request->node());
+    }
+    for (const auto &id : request->disconnected()) {
+        directory->erase(id, request->node());
+    }
+    return grpc::Status::OK;
+}
+
+grpc::Status rpc::services::MinersService::locate(
+    grpc::ServerContext *context,
+    const miners::LocateRequest *request,
+    miners::LocateResponse *response
+) {
+    log("/miners/locate", context->peer(), {{"id", request->id()}});
+
+    auto node = _server.peering()->directory()->locate(request->id());
+    if (!node.empty()) {
+        protos::Miner *miner = response->add_miners();
+        miner->set_id(request->id());
+        miner->set_node(node);
+    }
+    return grpc::Status::OK;
+}
+
+grpc::Status rpc::services::MinersService::watch(
+    grpc::ServerContext *context,
+    const miners::WatchRequest *request,
+    grpc::ServerWriter<miners::Event> *writer
+) {
+    json details;
+    if (!request->id().empty()) details["id"] = request->id();
+    log("/miners/watch", context->peer(), details);
+
+    // The wait is bounded so that a watcher that went away is noticed even
+    // when no miner comes or goes. The node closes every watch on its way
+    // down, which ends the stream.
+    auto &miners = _server.frontend()->miners;
+    auto self = _server.cfg().network.advertise.netloc();
+    auto watch = miners.watch(request->id());
+    server::Watch::Event event;
+    while (!context->IsCancelled() && !watch->closed()) {
+        if (watch->overrun()) miners.resync(watch);
+        if (!watch->next(event, chrono::milliseconds(500))) continue;
+
+        // Watch::Type lists its values in the order of the protocol enum.
+        miners::Event outgoing;
+        outgoing.set_type((miners::Event::Type) event.type);
+        if (!event.id.empty()) {
+            outgoing.mutable_miner()->set_id(event.id);
+            outgoing.mutable_miner()->set_node(self);
+        }
+        if (!writer->Write(outgoing)) break;
     }
+    miners.unwatch(watch);
     return grpc::Status::OK;
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "protos/miners.grpc.pb.h"
 #include "server/frontend.h"
+#include "server/peering.h"
 #include "rpc/helper.h"
 
 #include <string>
@@ -30,6 +31,24 @@ namespace rpc {
                 const miners::ListRequest *request,
                 miners::ListResponse *response
             ) override;
+
+            grpc::Status announce(
+                grpc::ServerContext *context,
+                const miners::AnnounceRequest *request,
+                miners::AnnounceResponse *response
+            ) override;
+
+            grpc::Status locate(
+                grpc::ServerContext *context,
+                const miners::LocateRequest *request,
+                miners::LocateResponse *response
+            ) override;
+
+            grpc::Status watch(
+                grpc::ServerContext *context,
+                const miners::WatchRequest *request,
+                grpc::ServerWriter<miners::Event> *writer
+            ) override;
         };
     }
 }
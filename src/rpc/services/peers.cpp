@@ -23,7 +23,10 @@ grpc::Status rpc::services::PeersService::gossip(
         it++;
     }
 
+    // Senders put themselves first, hearing from a peer directly is the
+    // best sign it is alive.
     auto view = _server.peering()->view();
+    if (request->peers_size() > 0) view->heard(request->peers(0));
     deque<Peer> result = view->select(cfg.peers.c / 2 - 1, cfg.peers.H);
     result.emplace(result.begin(), Peer(cfg.network.advertise.netloc(), 0));
     for (const auto &each : result) {
@@ -41,12 +44,31 @@ grpc::Status rpc::services::PeersService::list(
 ) {
     log("/peers/list", context->peer());
 
+    // A max_age of zero leaves the range open at the top.
     auto view = _server.peering()->view();
     deque<Peer> snap = view->snapshot();
+    sort(snap.begin(), snap.end(), [](const Peer &a, const Peer &b) {
+        return a.addr() < b.addr();
+    });
+
+    auto limit = page_size(request->page_size());
+    auto after = request->page_token();
+    int count = 0;
     for (const auto &each : snap) {
+        if (!after.empty() && each.addr() <= after) continue;
+        if (each.age() < request->min_age()) continue;
+        if (request->max_age() > 0 && each.age() > request->max_age()) continue;
+        if (count == (int) limit) {
+            response->set_next_page_token(
+                response->peers(count - 1).addr()
+            );
+            break;
+        }
+
         protos::Peer *peer = response->add_peers();
         peer->set_addr(each.addr());
         peer->set_age(each.age());
+        count++;
     }
 
     return grpc::Status::OK;
@@ -6,6 +6,7 @@
 #include "rpc/helper.h"
 #include "peer.h"
 
+#include <algorithm>
 #include <string>
 #include <tuple>
 
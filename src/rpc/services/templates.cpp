@@ -0,0 +1,45 @@
+#include "logging.h"
+#include "rpc/services/templates.h"
+
+rpc::services::TemplatesService::TemplatesService(
+    shared_ptr<server::Distributor> distributor
+) : _distributor(move(distributor)) {}
+
+grpc::Status rpc::services::TemplatesService::push(
+    grpc::ServerContext *context,
+    const templates::PushRequest *request,
+    templates::PushResponse *response
+) {
+    // Pushes arrive every second from every neighbour, so unlike the other
+    // calls they are not logged one by one.
+    shared_ptr<const server::Template> block;
+    if (request->has_block()) {
+        try {
+            auto &each = request->block();
+            block = make_shared<server::Template>(
+                each.height(),
+                each.difficulty(),
+                each.reward(),
+                each.reserved_offset(),
+                each.prev_hash(),
+                each.seed_hash(),
+                each.blob()
+            );
+        } catch (const invalid_argument &e) {
+            log("/templates/push", context->peer(), {{"error", e.what()}});
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, e.what());
+        }
+    }
+
+    using Receipt = server::Distributor::Receipt;
+    auto receipt = _distributor->receive(
+        request->origin(),
+        request->beat(),
+        request->sequence(),
+        request->digest(),
+        block
+    );
+    response->set_fresh(receipt == Receipt::fresh);
+    response->set_missing(receipt == Receipt::missing);
+    return grpc::Status::OK;
+}
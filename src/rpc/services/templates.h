@@ -0,0 +1,38 @@
+#ifndef SYNCAIDE_RPC_SERVICES_TEMPLATES_H
+#define SYNCAIDE_RPC_SERVICES_TEMPLATES_H
+
+#include "protos/templates.grpc.pb.h"
+#include "server/distributor.h"
+#include "rpc/helper.h"
+
+#include <memory>
+#include <string>
+
+using namespace std;
+
+namespace rpc {
+    namespace services {
+        namespace templates = protos::templates;
+
+        // Receiving end of template distribution. The service only needs
+        // the distributor, which keeps it usable by nodes that are not a
+        // whole server, such as the in-process clusters of the tests.
+        class TemplatesService final : public templates::Templates::Service {
+        private:
+            shared_ptr<server::Distributor> _distributor;
+
+        public:
+            explicit TemplatesService(
+                shared_ptr<server::Distributor> distributor
+            );
+
+            grpc::Status push(
+                grpc::ServerContext *context,
+                const templates::PushRequest *request,
+                templates::PushResponse *response
+            ) override;
+        };
+    }
+}
+
+#endif //SYNCAIDE_RPC_SERVICES_TEMPLATES_H
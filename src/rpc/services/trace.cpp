@@ -0,0 +1,14 @@
+#include "logging.h"
+#include "rpc/services/trace.h"
+
+grpc::Status rpc::services::TraceService::dump(
+    grpc::ServerContext *context,
+    const trace::DumpRequest *request,
+    trace::DumpResponse *response
+) {
+    log("/trace/dump", context->peer());
+
+    response->set_events(server::trace::dump().dump());
+    if (request->clear()) server::trace::clear();
+    return grpc::Status::OK;
+}
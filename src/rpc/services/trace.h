@@ -0,0 +1,29 @@
+#ifndef SYNCAIDE_RPC_SERVICES_TRACE_H
+#define SYNCAIDE_RPC_SERVICES_TRACE_H
+
+#include "protos/trace.grpc.pb.h"
+#include "server/trace.h"
+#include "rpc/helper.h"
+
+#include <string>
+
+using namespace std;
+
+namespace rpc {
+    namespace services {
+        namespace trace = protos::trace;
+
+        // Hands out the spans recorded in this process as a Chrome
+        // trace-event document.
+        class TraceService final : public trace::Trace::Service {
+        public:
+            grpc::Status dump(
+                grpc::ServerContext *context,
+                const trace::DumpRequest *request,
+                trace::DumpResponse *response
+            ) override;
+        };
+    }
+}
+
+#endif //SYNCAIDE_RPC_SERVICES_TRACE_H
@@ -0,0 +1,234 @@
+#include "logging.h"
+#include "server/assets.h"
+
+#include <cryptopp/sha.h>
+#include <cryptopp/hex.h>
+#include <cryptopp/filters.h>
+#include <nlohmann/json.hpp>
+#include <fmt/format.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <system_error>
+#include <algorithm>
+
+namespace {
+    // Closes a descriptor when an error leaves the constructor early.
+    struct Closer {
+        int fd;
+
+        ~Closer() {
+            if (fd >= 0) ::close(fd);
+        }
+    };
+
+    bool same(const struct stat &a, const struct stat &b) {
+        return a.st_ino == b.st_ino && a.st_size == b.st_size &&
+               a.st_mtim.tv_sec == b.st_mtim.tv_sec &&
+               a.st_mtim.tv_nsec == b.st_mtim.tv_nsec;
+    }
+}
+
+server::Mapping::Mapping(const fs::path &path) :
+    _fd(-1),
+    _addr(nullptr),
+    _size(0) {
+    auto fail = [&path](int error) {
+        throw system_error(error, generic_category(), path.string());
+    };
+
+    Closer source{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (source.fd < 0) fail(errno);
+    struct stat before{};
+    if (fstat(source.fd, &before) < 0) fail(errno);
+
+    Closer copy{memfd_create(
+        path.filename().c_str(),
+        MFD_CLOEXEC | MFD_ALLOW_SEALING
+    )};
+    if (copy.fd < 0) fail(errno);
+
+    // Mapping zero bytes fails, an empty file simply has no data.
+    _size = (size_t) before.st_size;
+    if (_size > 0) {
+        if (ftruncate(copy.fd, before.st_size) < 0) fail(errno);
+        auto addr = mmap(
+            nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, copy.fd, 0
+        );
+        if (addr == MAP_FAILED) fail(errno);
+
+        size_t done = 0;
+        int error = 0;
+        while (done < _size) {
+            auto count = ::read(source.fd, (char *) addr + done, _size - done);
+            if (count > 0) {
+                done += (size_t) count;
+                continue;
+            }
+            if (count < 0 && errno == EINTR) continue;
+            // Ending early means the file is being rewritten right now.
+            error = count < 0 ? errno : EBUSY;
+            break;
+        }
+        munmap(addr, _size);
+        if (error) fail(error);
+    }
+
+    // A file written to while it was copied is refused, the next reload
+    // takes it once it holds still.
+    struct stat after{};
+    if (fstat(source.fd, &after) < 0) fail(errno);
+    if (!same(before, after)) fail(EBUSY);
+
+    auto seals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL;
+    if (fcntl(copy.fd, F_ADD_SEALS, seals) < 0) fail(errno);
+    if (_size > 0) {
+        _addr = mmap(nullptr, _size, PROT_READ, MAP_SHARED, copy.fd, 0);
+        if (_addr == MAP_FAILED) {
+            _addr = nullptr;
+            fail(errno);
+        }
+    }
+    _fd = copy.fd;
+    copy.fd = -1;
+}
+
+server::Mapping::~Mapping() {
+    if (_addr) munmap(_addr, _size);
+    ::close(_fd);
+}
+
+std::string_view server::Mapping::data() const {
+    return {(const char *) _addr, _size};
+}
+
+int server::Mapping::fd() const {
+    return _fd;
+}
+
+server::Assets::Assets(const string &path) : _path(path) {
+    if (!enabled()) return;
+    auto canonical = fs::canonical(_path);
+    atomic_store(&_bundle, load(canonical, stamp(canonical)));
+}
+
+bool server::Assets::enabled() const {
+    return !_path.empty();
+}
+
+boost::optional<server::Assets::Asset>
+server::Assets::find(std::string_view name) const {
+    auto bundle = atomic_load(&_bundle);
+    if (bundle) {
+        auto search = bundle->files.find(name);
+        if (search != bundle->files.end()) {
+            auto &file = search->second;
+            return Asset{
+                file.mapping->data(),
+                file.digest,
+                bundle,
+                file.mapping->fd()
+            };
+        }
+    }
+
+    auto resource = resources::find(name);
+    if (resource) return Asset{resource->data, resource->digest, nullptr};
+    return boost::none;
+}
+
+bool server::Assets::reload() {
+    if (!enabled()) return false;
+
+    lock_guard<mutex> lock(_mutex);
+    try {
+        // Following the path again each time lets a release switch a
+        // symlink over to a new directory in one step.
+        auto canonical = fs::canonical(_path);
+        auto current = stamp(canonical);
+        auto bundle = atomic_load(&_bundle);
+        if (bundle && bundle->stamp == current) {
+            _pending.clear();
+            return false;
+        }
+        if (current != _pending) {
+            _pending = current;
+            return false;
+        }
+
+        atomic_store(&_bundle, load(canonical, current));
+        _pending.clear();
+        return true;
+    } catch (const exception &e) {
+        nlohmann::json extra = {
+            {"path", _path.string()},
+            {"error", e.what()}
+        };
+        LOG(error) << logging::add_value("Extra", move(extra))
+                   << "assets reload failed.";
+        return false;
+    }
+}
+
+string server::Assets::stamp(const fs::path &path) const {
+    // Replacing a file by renaming a new one over it changes the inode, so
+    // that is noticed even when size and time happen to match.
+    vector<string> entries;
+    for (auto &each : fs::directory_iterator(path)) {
+        if (!fs::is_regular_file(each.status())) continue;
+
+        struct stat st{};
+        if (stat(each.path().c_str(), &st) < 0) continue;
+        entries.emplace_back(fmt::format(
+            "{}:{}:{}:{}.{}",
+            each.path().filename().string(),
+            st.st_ino,
+            st.st_size,
+            st.st_mtim.tv_sec,
+            st.st_mtim.tv_nsec
+        ));
+    }
+    sort(entries.begin(), entries.end());
+
+    string output = path.string();
+    for (auto &each : entries) output += "\n" + each;
+    return output;
+}
+
+shared_ptr<const server::Assets::Bundle>
+server::Assets::load(const fs::path &path, string stamp) {
+    auto bundle = make_shared<Bundle>();
+    bundle->stamp = move(stamp);
+
+    nlohmann::json files = nlohmann::json::object();
+    for (auto &each : fs::directory_iterator(path)) {
+        if (!fs::is_regular_file(each.status())) continue;
+
+        File file{make_unique<Mapping>(each.path()), string()};
+        auto data = file.mapping->data();
+        CryptoPP::SHA256 sha256sum;
+        CryptoPP::StringSource(
+            (const CryptoPP::byte *) data.data(), data.size(), true,
+            new CryptoPP::HashFilter(
+                sha256sum,
+                new CryptoPP::HexEncoder(
+                    new CryptoPP::StringSink(file.digest),
+                    false
+                )
+            )
+        );
+
+        auto name = each.path().filename().string();
+        files[name] = file.digest;
+        bundle->files.emplace(name, move(file));
+    }
+
+    nlohmann::json extra = {
+        {"path", path.string()},
+        {"files", files}
+    };
+    LOG(info) << logging::add_value("Extra", move(extra))
+              << "assets loaded.";
+    return bundle;
+}
@@ -0,0 +1,137 @@
+#ifndef SYNCAIDE_SERVER_ASSETS_H
+#define SYNCAIDE_SERVER_ASSETS_H
+
+#include "resources.h"
+
+#include <boost/beast/http/message.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+#include <boost/system/error_code.hpp>
+#include <string_view>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <map>
+
+using namespace std;
+
+namespace server {
+    namespace fs = boost::filesystem;
+    namespace http = boost::beast::http;
+
+    // Read-only mapping of a private copy of a whole file. The copy lives
+    // in sealed anonymous memory, so a file overwritten or truncated in
+    // place can neither change the bytes being served nor fault the
+    // mapping. Its descriptor stays open along with it so the copy can
+    // also be handed to sendfile.
+    class Mapping {
+    private:
+        int _fd;
+        void *_addr;
+        size_t _size;
+
+    public:
+        explicit Mapping(const fs::path &path);
+
+        Mapping(const Mapping &) = delete;
+
+        Mapping &operator=(const Mapping &) = delete;
+
+        ~Mapping();
+
+        std::string_view data() const;
+
+        int fd() const;
+    };
+
+    // The agent bundle, either built in or loaded from a directory. Files
+    // in the directory are copied once into mappings and a changed directory
+    // is swapped in as a whole, while responses still being written hold on
+    // to the bundle they started with. Files missing from the directory
+    // fall back to the built in ones.
+    class Assets {
+    public:
+        struct Asset {
+            std::string_view data;
+            std::string_view digest;
+            shared_ptr<const void> owner;
+            // Open file behind the data, -1 for the built in ones.
+            int fd = -1;
+        };
+
+    private:
+        struct File {
+            unique_ptr<Mapping> mapping;
+            string digest;
+        };
+
+        struct Bundle {
+            string stamp;
+            map<string, File, less<>> files;
+        };
+
+        fs::path _path;
+        mutex _mutex;
+        string _pending;
+        shared_ptr<const Bundle> _bundle;
+
+    public:
+        explicit Assets(const string &path = string());
+
+        bool enabled() const;
+
+        boost::optional<Asset> find(std::string_view name) const;
+
+        // Loads the directory again when its files changed and stayed the
+        // same since the previous call, which keeps a bundle that is still
+        // being copied in from being picked up halfway.
+        bool reload();
+
+    private:
+        string stamp(const fs::path &path) const;
+
+        shared_ptr<const Bundle> load(const fs::path &path, string stamp);
+    };
+
+    // Serves an asset in place and keeps its bundle alive until the
+    // response is written.
+    struct asset_body {
+        using value_type = Assets::Asset;
+
+        static uint64_t size(const value_type &body) {
+            return body.data.size();
+        }
+
+        class writer {
+        private:
+            const value_type &_body;
+
+        public:
+            using const_buffers_type = boost::asio::const_buffer;
+
+            template<bool isRequest, class Fields>
+            writer(
+                const http::header<isRequest, Fields> &,
+                const value_type &body
+            ) : _body(body) {}
+
+            void init(boost::system::error_code &ec) {
+                ec.assign(0, ec.category());
+            }
+
+            boost::optional<pair<const_buffers_type, bool>>
+            get(boost::system::error_code &ec) {
+                ec.assign(0, ec.category());
+                return {{
+                    const_buffers_type(_body.data.data(), _body.data.size()),
+                    false
+                }};
+            }
+        };
+    };
+}
+
+#endif //SYNCAIDE_SERVER_ASSETS_H
@@ -0,0 +1,116 @@
+#include "server/directory.h"
+
+server::Directory::Directory(const string &self) : _self(self) {
+    rebuild();
+}
+
+bool server::Directory::observe(const vector<string> &addrs) {
+    auto now = chrono::steady_clock::now();
+    unique_lock<shared_mutex> lock(_mutex);
+    bool changed = false;
+    for (const auto &addr : addrs) {
+        if (addr == _self) continue;
+        auto inserted = _members.insert_or_assign(addr, now).second;
+        changed = changed || inserted;
+    }
+    if (changed) rebuild();
+    return changed;
+}
+
+vector<string> server::Directory::owners(const string &id) const {
+    shared_lock<shared_mutex> lock(_mutex);
+    vector<string> out;
+    auto it = lower_bound(
+        _ring.begin(),
+        _ring.end(),
+        make_pair(hash(id), string())
+    );
+    for (size_t i = 0; i < _ring.size() && out.size() < replicas; i++, it++) {
+        if (it == _ring.end()) it = _ring.begin();
+        if (find(out.begin(), out.end(), it->second) == out.end()) {
+            out.emplace_back(it->second);
+        }
+    }
+    return out;
+}
+
+void server::Directory::record(const string &id, const string &node) {
+    unique_lock<shared_mutex> lock(_mutex);
+    _entries[id] = Entry{node, chrono::steady_clock::now()};
+}
+
+void server::Directory::erase(const string &id, const string &node) {
+    // A miner that reconnected elsewhere before its old connection was torn
+    // down keeps the newer entry.
+    unique_lock<shared_mutex> lock(_mutex);
+    auto search = _entries.find(id);
+    if (search != _entries.end() && search->second.node == node) {
+        _entries.erase(search);
+    }
+}
+
+string server::Directory::locate(const string &id) const {
+    shared_lock<shared_mutex> lock(_mutex);
+    auto search = _entries.find(id);
+    if (search == _entries.end()) return string();
+    auto age = chrono::steady_clock::now() - search->second.seen;
+    if (age > chrono::seconds(entries)) return string();
+    return search->second.node;
+}
+
+bool server::Directory::expire() {
+    auto now = chrono::steady_clock::now();
+    unique_lock<shared_mutex> lock(_mutex);
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        if (now - it->second.seen > chrono::seconds(entries)) {
+            it = _entries.erase(it);
+        } else {
+            it++;
+        }
+    }
+
+    bool changed = false;
+    for (auto it = _members.begin(); it != _members.end();) {
+        if (now - it->second > chrono::seconds(members)) {
+            it = _members.erase(it);
+            changed = true;
+        } else {
+            it++;
+        }
+    }
+    if (changed) rebuild();
+    return changed;
+}
+
+size_t server::Directory::size() const {
+    shared_lock<shared_mutex> lock(_mutex);
+    return _entries.size();
+}
+
+uint64_t server::Directory::hash(const string &text) {
+    uint64_t digest = 0xcbf29ce484222325;
+    for (auto c : text) {
+        digest ^= (uint8_t) c;
+        digest *= 0x100000001b3;
+    }
+
+    // FNV alone leaves ids that share a prefix close together on the ring,
+    // a final mix spreads them out.
+    digest ^= digest >> 33;
+    digest *= 0xff51afd7ed558ccd;
+    digest ^= digest >> 33;
+    return digest;
+}
+
+void server::Directory::rebuild() {
+    _ring.clear();
+    _ring.reserve((_members.size() + 1) * points);
+    auto place = [this](const string &addr) {
+        for (int i = 0; i < points; i++) {
+            _ring.emplace_back(hash(addr + "#" + to_string(i)), addr);
+        }
+    };
+    place(_self);
+    for (const auto &member : _members) place(member.first);
+    sort(_ring.begin(), _ring.end());
+}
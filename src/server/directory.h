@@ -0,0 +1,69 @@
+#ifndef SYNCAIDE_SERVER_DIRECTORY_H
+#define SYNCAIDE_SERVER_DIRECTORY_H
+
+#include "server/helper.h"
+
+#include <unordered_map>
+#include <shared_mutex>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <mutex>
+
+using namespace std;
+
+namespace server {
+    // Cluster-wide index of which node each miner is connected to. Miner ids
+    // are consistent-hashed onto the known members, and the few nodes an id
+    // lands on keep its entry, so any node finds a miner with one call to
+    // one of them. Entries are soft state: connection holders announce
+    // their miners again every few seconds and anything not refreshed
+    // expires, which also moves entries to their new home after members
+    // join or leave. Members are learned from the peer view over time since
+    // a single view only holds part of the cluster.
+    class Directory {
+        enum {
+            replicas = 2,
+            points = 64,
+            members = 60,
+            entries = 30
+        };
+
+        struct Entry {
+            string node;
+            steady_time_point seen;
+        };
+
+    private:
+        mutable shared_mutex _mutex;
+        string _self;
+        unordered_map<string, steady_time_point> _members;
+        vector<pair<uint64_t, string>> _ring;
+        unordered_map<string, Entry> _entries;
+
+    public:
+        explicit Directory(const string &self);
+
+        bool observe(const vector<string> &addrs);
+
+        vector<string> owners(const string &id) const;
+
+        void record(const string &id, const string &node);
+
+        void erase(const string &id, const string &node);
+
+        string locate(const string &id) const;
+
+        bool expire();
+
+        size_t size() const;
+
+        static uint64_t hash(const string &text);
+
+    private:
+        void rebuild();
+    };
+}
+
+#endif //SYNCAIDE_SERVER_DIRECTORY_H
@@ -0,0 +1,254 @@
+#include "logging.h"
+#include "common/placement.h"
+#include "server/distributor.h"
+
+#include <cryptopp/filters.h>
+#include <cryptopp/sha.h>
+
+server::Distributor::Distributor(
+    io_context &ioc,
+    const string &self,
+    targets_type targets,
+    deliver_type deliver
+) : _ioc(ioc),
+    _self(self),
+    _targets(move(targets)),
+    _deliver(move(deliver)) {
+    // Beats and sequences start from the wall clock so that a restarted
+    // node carries on above whatever its peers still remember from its
+    // previous run.
+    _beat = (uint64_t) chrono::duration_cast<chrono::microseconds>(
+        chrono::system_clock::now().time_since_epoch()
+    ).count();
+    _sequence = _beat;
+
+    // Pushes complete here rather than on the io thread, which gossip
+    // shares and which must not wait for slow or dead neighbours.
+    _drainer = thread([this] {
+        common::Placement::name("peering-push");
+        rpc::drain(_queue);
+    });
+}
+
+server::Distributor::~Distributor() {
+    _queue.Shutdown();
+    _drainer.join();
+}
+
+void server::Distributor::originate(shared_ptr<const Template> block) {
+    uint64_t beat, sequence;
+    auto hash = digest(*block);
+    {
+        lock_guard<mutex> lock(_mutex);
+        _current = Current{_self, ++_sequence, hash, block};
+        sequence = _current.sequence;
+        beat = ++_beat;
+    }
+    boost::asio::post(_ioc, bind(
+        &Distributor::relay,
+        shared_from_this(),
+        _self,
+        beat,
+        sequence,
+        hash,
+        block
+    ));
+}
+
+void server::Distributor::heartbeat() {
+    uint64_t beat, sequence;
+    string hash;
+    {
+        lock_guard<mutex> lock(_mutex);
+        if (!_current.block) return;
+
+        // A template this node got from a former leader is carried on
+        // under its own name, once, so that it keeps its sequence from
+        // then on.
+        if (_current.origin != _self) {
+            _current.origin = _self;
+            _current.sequence = ++_sequence;
+        }
+        beat = ++_beat;
+        sequence = _current.sequence;
+        hash = _current.digest;
+    }
+    boost::asio::post(_ioc, bind(
+        &Distributor::relay,
+        shared_from_this(),
+        _self,
+        beat,
+        sequence,
+        hash,
+        nullptr
+    ));
+}
+
+server::Distributor::Receipt server::Distributor::receive(
+    const string &origin,
+    uint64_t beat,
+    uint64_t sequence,
+    const string &digest,
+    shared_ptr<const Template> block
+) {
+    if (origin == _self) return Receipt::known;
+    bool fresh;
+    {
+        lock_guard<mutex> lock(_mutex);
+        auto &known = _origins[origin];
+        if (beat <= known.beat) return Receipt::known;
+
+        // The beat is left unrecorded while the block is missing, the
+        // sender then follows up with the same beat and the block.
+        fresh = sequence > known.sequence && digest != _current.digest;
+        if (fresh && !block) return Receipt::missing;
+
+        known.beat = beat;
+        known.sequence = max(known.sequence, sequence);
+        known.heard = chrono::steady_clock::now();
+        if (fresh) _current = Current{origin, sequence, digest, block};
+    }
+
+    if (fresh) _deliver(block);
+    boost::asio::post(_ioc, bind(
+        &Distributor::relay,
+        shared_from_this(),
+        origin,
+        beat,
+        sequence,
+        digest,
+        fresh ? block : nullptr
+    ));
+    return fresh ? Receipt::fresh : Receipt::known;
+}
+
+bool server::Distributor::fed() {
+    return heard([](const string &) {
+        return true;
+    });
+}
+
+bool server::Distributor::outranked() {
+    return heard([this](const string &origin) {
+        return origin < _self;
+    });
+}
+
+string server::Distributor::digest(const Template &block) {
+    string digest;
+    CryptoPP::SHA256 sha256sum;
+    CryptoPP::StringSource(
+        block.blob(), true,
+        new CryptoPP::HashFilter(
+            sha256sum,
+            new CryptoPP::StringSink(digest)
+        )
+    );
+    return digest;
+}
+
+void server::Distributor::relay(
+    const string &origin,
+    uint64_t beat,
+    uint64_t sequence,
+    const string &digest,
+    shared_ptr<const Template> block
+) {
+    auto targets = _targets();
+    for (const auto &addr : targets) {
+        if (addr == origin || addr == _self) continue;
+        send(addr, origin, beat, sequence, digest, block);
+    }
+
+    // Neighbours come and go with the view, channels to the ones that left
+    // are dropped rather than kept open forever.
+    for (auto it = _channels.begin(); it != _channels.end();) {
+        if (find(targets.begin(), targets.end(), it->first) == targets.end()) {
+            it = _channels.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+void server::Distributor::resend(
+    const string &addr,
+    const string &origin,
+    uint64_t beat,
+    uint64_t sequence,
+    const string &digest
+) {
+    shared_ptr<const Template> block;
+    {
+        lock_guard<mutex> lock(_mutex);
+        if (_current.digest != digest) return;
+        block = _current.block;
+    }
+    send(addr, origin, beat, sequence, digest, block);
+}
+
+void server::Distributor::send(
+    const string &addr,
+    const string &origin,
+    uint64_t beat,
+    uint64_t sequence,
+    const string &digest,
+    shared_ptr<const Template> block
+) {
+    // Calls still out when the distributor goes away finish during its
+    // destruction, which they must then leave alone. Handlers run on the
+    // drainer and never take a strong reference there: the last one would
+    // destroy the distributor on the thread its destructor joins. The io
+    // context outlives the drainer, which is joined before it goes away.
+    weak_ptr<Distributor> weak = shared_from_this();
+    auto &ioc = _ioc;
+    rpc::callers::TemplatesCaller caller(channel(addr));
+    caller.push(
+        origin,
+        beat,
+        sequence,
+        digest,
+        block.get(),
+        chrono::milliseconds(deadline),
+        _queue,
+        [weak, &ioc, addr, origin, beat, sequence, digest, block](
+            const grpc::Status &status,
+            bool missing
+        ) {
+            if (!status.ok()) {
+                json extra = {{"peer", addr}, {"call", "templates/push"}};
+                LOG(debug) << logging::add_value("Extra", move(extra))
+                           << status.error_message();
+            } else if (missing && !block) {
+                boost::asio::post(ioc, [=] {
+                    auto self = weak.lock();
+                    if (!self) return;
+                    self->resend(addr, origin, beat, sequence, digest);
+                });
+            }
+        }
+    );
+}
+
+bool server::Distributor::heard(const function<bool(const string &)> &predicate) {
+    auto since = chrono::steady_clock::now() - chrono::milliseconds(silence);
+    lock_guard<mutex> lock(_mutex);
+    for (const auto &[origin, known] : _origins) {
+        if (known.heard > since && predicate(origin)) return true;
+    }
+    return false;
+}
+
+shared_ptr<grpc::Channel> server::Distributor::channel(const string &addr) {
+    // Channels are kept per neighbour, a push then goes out on an
+    // established HTTP/2 connection instead of paying for a handshake.
+    auto search = _channels.find(addr);
+    if (search != _channels.end()) return search->second;
+    auto created = grpc::CreateCustomChannel(
+        addr,
+        grpc::InsecureChannelCredentials(),
+        grpc::ChannelArguments()
+    );
+    _channels.emplace(addr, created);
+    return created;
+}
@@ -0,0 +1,143 @@
+#ifndef SYNCAIDE_SERVER_DISTRIBUTOR_H
+#define SYNCAIDE_SERVER_DISTRIBUTOR_H
+
+#include "rpc/callers/templates.h"
+#include "server/template.h"
+#include "server/helper.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <grpc++/grpc++.h>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <mutex>
+
+using namespace std;
+
+namespace server {
+    using boost::asio::io_context;
+
+    // Spreads block templates over the peering mesh so that a cluster asks
+    // its daemon once rather than once per node. The elected node
+    // originates every new template and sends a heartbeat every second.
+    // Each push carries its origin, a beat and the sequence number and
+    // digest of the template, and a node relays a beat to its own
+    // neighbours the first time it sees it, which reaches every node even
+    // though each one only knows a partial view of the cluster. The block
+    // itself only travels with a new template, a heartbeat names it by its
+    // digest and a node that missed it asks the sender for it.
+    class Distributor : public enable_shared_from_this<Distributor> {
+        using deliver_type = function<void(shared_ptr<const Template>)>;
+        using targets_type = function<vector<string>()>;
+
+        enum {
+            deadline = 500,
+            silence = 5000
+        };
+
+        struct Origin {
+            uint64_t beat = 0;
+            uint64_t sequence = 0;
+            chrono::steady_clock::time_point heard{};
+        };
+
+        struct Current {
+            string origin;
+            uint64_t sequence = 0;
+            string digest;
+            shared_ptr<const Template> block;
+        };
+
+    public:
+        enum class Receipt {
+            known,
+            fresh,
+            missing
+        };
+
+    private:
+        io_context &_ioc;
+        string _self;
+        targets_type _targets;
+        deliver_type _deliver;
+        mutex _mutex;
+        uint64_t _beat;
+        uint64_t _sequence;
+        Current _current;
+        unordered_map<string, Origin> _origins;
+        unordered_map<string, shared_ptr<grpc::Channel>> _channels;
+        grpc::CompletionQueue _queue;
+        thread _drainer;
+
+    public:
+        Distributor(
+            io_context &ioc,
+            const string &self,
+            targets_type targets,
+            deliver_type deliver
+        );
+
+        ~Distributor();
+
+        void originate(shared_ptr<const Template> block);
+
+        void heartbeat();
+
+        // The block is null when a push only names the template, which is
+        // then missing unless this node already has it.
+        Receipt receive(
+            const string &origin,
+            uint64_t beat,
+            uint64_t sequence,
+            const string &digest,
+            shared_ptr<const Template> block
+        );
+
+        // Whether beats from another origin are still coming in.
+        bool fed();
+
+        // Whether beats from an origin below this node are still coming in,
+        // in which case that one leads rather than this node.
+        bool outranked();
+
+        static string digest(const Template &block);
+
+    private:
+        void relay(
+            const string &origin,
+            uint64_t beat,
+            uint64_t sequence,
+            const string &digest,
+            shared_ptr<const Template> block
+        );
+
+        void resend(
+            const string &addr,
+            const string &origin,
+            uint64_t beat,
+            uint64_t sequence,
+            const string &digest
+        );
+
+        void send(
+            const string &addr,
+            const string &origin,
+            uint64_t beat,
+            uint64_t sequence,
+            const string &digest,
+            shared_ptr<const Template> block
+        );
+
+        bool heard(const function<bool(const string &)> &predicate);
+
+        shared_ptr<grpc::Channel> channel(const string &addr);
+    };
+}
+
+#endif //SYNCAIDE_SERVER_DISTRIBUTOR_H
@@ -3,12 +3,16 @@
 
 server::Frontend::Frontend(Server &server) :
     miners(*this),
+    signer(server.cfg().security.key, server.cfg().security.cache),
+    assets(server.cfg().assets.path),
     _server(server),
     _ctx(context{context::sslv23}),
-    _ioc(io_context{(int) server.cfg().network.threads}) {}
+    _ioc(io_context{(int) server.cfg().network.threads}),
+    _reload(_assets) {}
 
 void server::Frontend::start() {
     _router.add(Http::health, "/health");
+    _router.add(Http::exposition, "/metrics");
     _router.add(Http::syncaide_js, "/syncaide[.]js");
     _router.add(Http::syncaide_wasm, "/syncaide[.]wasm");
     _router.add(Http::agent_uid, "/agent/{}", params::string());
@@ -23,18 +27,42 @@ void server::Frontend::start() {
     auto address = ip::make_address(_server.cfg().network.frontend.host());
     tcp::endpoint endpoint(address, _server.cfg().network.frontend.port());
     make_shared<Listener>(_server, _ioc, _ctx, _router, endpoint)->run();
+    on_reload(error_code());
 
-    _handlers.reserve(_server.cfg().network.threads);
+    // Connections allocate their buffers on the io threads, which the
+    // kernel then places on the memory of the node the threads run on.
+    _handlers.reserve(_server.cfg().network.threads + 1);
     for (auto i = _server.cfg().network.threads; i > 0; --i) {
-        _handlers.emplace_back([&] { _ioc.run(); });
+        _handlers.emplace_back([&, i] {
+            Placement::name("frontend-io-" + to_string(i));
+            _ioc.run();
+        });
     }
+    _handlers.emplace_back([&] {
+        Placement::name("frontend-assets");
+        _assets.run();
+    });
 
     auto future = server::exit.frontend.get_future();
     future.wait();
     _ioc.stop();
+    _assets.stop();
     for_each(_handlers.begin(), _handlers.end(), [](thread &t) { t.join(); });
 }
 
+void server::Frontend::on_reload(const error_code &ec) {
+    if (ec == boost::asio::error::operation_aborted) return;
+    if (!assets.enabled()) return;
+
+    assets.reload();
+    _reload.expires_after(chrono::seconds(_server.cfg().assets.reload));
+    _reload.async_wait(bind(
+        &Frontend::on_reload,
+        shared_from_this(),
+        placeholders::_1
+    ));
+}
+
 void server::Frontend::load_http_certificate(context &ctx) {
     std::string const cert =
         "-----BEGIN CERTIFICATE-----\n"
@@ -132,12 +160,113 @@ server::Frontend::Miners::list(const string &id) {
     return miners;
 }
 
+vector<shared_ptr<server::Miner>> server::Frontend::Miners::page(
+    const string &prefix,
+    const string &after,
+    size_t limit,
+    string &next
+) {
+    // Pages pick up after the last id handed out rather than at an offset,
+    // so miners coming and going between pages shift nothing.
+    vector<shared_ptr<Miner>> miners;
+    next.clear();
+    shared_lock<shared_mutex> lock(_mutex);
+    auto it = after.empty() || after < prefix
+              ? _miners.lower_bound(prefix)
+              : _miners.upper_bound(after);
+    for (; it != _miners.end(); it++) {
+        if (it->first.compare(0, prefix.size(), prefix) != 0) break;
+        if (miners.size() == limit) {
+            next = miners.back()->id();
+            break;
+        }
+        miners.emplace_back(it->second);
+    }
+    return miners;
+}
+
+void server::Frontend::Miners::connect(const string &id) {
+    unique_lock<shared_mutex> lock(_mutex);
+    publish(Watch::Type::CONNECT, id);
+}
+
 bool server::Frontend::Miners::add(
     const string &id,
     shared_ptr<Miner> miner
 ) {
+    {
+        unique_lock<shared_mutex> lock(_mutex);
+        if (!_miners.insert(make_pair(id, miner)).second) return false;
+        publish(Watch::Type::LOGIN, id);
+    }
+    _self._server.peering()->announce(id, true);
+    return true;
+}
+
+bool server::Frontend::Miners::remove(
+    const string &id,
+    const shared_ptr<Miner> &miner
+) {
+    bool removed = false;
+    {
+        unique_lock<shared_mutex> lock(_mutex);
+        auto search = _miners.find(id);
+        if (search != _miners.end() && search->second == miner) {
+            _miners.erase(search);
+            removed = true;
+            publish(Watch::Type::DISCONNECT, id);
+        }
+    }
+    if (removed) _self._server.peering()->announce(id, false);
+    return removed;
+}
+
+shared_ptr<server::Watch> server::Frontend::Miners::watch(const string &id) {
+    // The snapshot is taken under the same lock that every change is
+    // published under, so the watcher neither misses nor repeats an event.
+    auto watch = make_shared<Watch>(id, backlog);
+    unique_lock<shared_mutex> lock(_mutex);
+    if (_closed) {
+        watch->close();
+        return watch;
+    }
+    watch->reset(ids());
+    _watches.emplace_back(watch);
+    return watch;
+}
+
+void server::Frontend::Miners::resync(const shared_ptr<Watch> &watch) {
+    unique_lock<shared_mutex> lock(_mutex);
+    watch->reset(ids());
+}
+
+void server::Frontend::Miners::unwatch(const shared_ptr<Watch> &watch) {
+    watch->close();
+    unique_lock<shared_mutex> lock(_mutex);
+    _watches.erase(
+        remove_if(_watches.begin(), _watches.end(), [&watch](auto &each) {
+            return each == watch;
+        }),
+        _watches.end()
+    );
+}
+
+void server::Frontend::Miners::close() {
     unique_lock<shared_mutex> lock(_mutex);
-    return _miners.insert(make_pair(id, miner)).second;
+    _closed = true;
+    for (auto &watch : _watches) watch->close();
+    _watches.clear();
+}
+
+vector<string> server::Frontend::Miners::ids() const {
+    vector<string> out;
+    out.reserve(_miners.size());
+    for (auto const&[key, val] : _miners) out.emplace_back(key);
+    return out;
+}
+
+void server::Frontend::Miners::publish(Watch::Type type, const string &id) {
+    for (auto &watch : _watches) watch->push(Watch::Event{type, id});
 }
 
 //shared_ptr<server::Miner> server::Frontend::miner(const string &uid) {
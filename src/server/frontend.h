@@ -1,13 +1,17 @@
 #ifndef SYNCAIDE_SERVER_FRONTEND_H
 #define SYNCAIDE_SERVER_FRONTEND_H
 
+#include "server/assets.h"
 #include "server/router.h"
 #include "server/http.h"
 #include "server/listener.h"
 #include "server/miner.h"
+#include "server/signer.h"
+#include "server/watch.h"
 
 #include <boost/asio/ssl/context.hpp>
 #include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <nlohmann/json.hpp>
 #include <shared_mutex>
 #include <string>
@@ -19,6 +23,8 @@ namespace server {
     namespace ip = boost::asio::ip;
     using boost::asio::ssl::context;
     using boost::asio::io_context;
+    using boost::asio::steady_timer;
+    using boost::system::error_code;
     using nlohmann::json;
 
     class Miner;
@@ -27,28 +33,66 @@ namespace server {
 
     class Frontend : public enable_shared_from_this<Frontend> {
         class Miners {
+            enum {
+                backlog = 1024
+            };
+
         private:
             Frontend &_self;
             mutable shared_mutex _mutex;
             map<string, shared_ptr<Miner>> _miners;
+            vector<shared_ptr<Watch>> _watches;
+            bool _closed = false;
 
         public:
             explicit Miners(Frontend &self) : _self(self), _miners() {}
 
             vector<shared_ptr<Miner>> list(const string &id = string());
 
+            vector<shared_ptr<Miner>> page(
+                const string &prefix,
+                const string &after,
+                size_t limit,
+                string &next
+            );
+
+            void connect(const string &id);
+
             bool add(const string &id, shared_ptr<Miner> miner);
 
+            bool remove(const string &id, const shared_ptr<Miner> &miner);
+
+            shared_ptr<Watch> watch(const string &id = string());
+
+            void resync(const shared_ptr<Watch> &watch);
+
+            void unwatch(const shared_ptr<Watch> &watch);
+
+            // Ends every watch for good, streams serving them then return
+            // and let the rpc server shut down.
+            void close();
+
+        private:
+            vector<string> ids() const;
+
+            void publish(Watch::Type type, const string &id);
+
 //            shared_ptr<Miner> pop(const string &uid);
         };
 
     public:
         Miners miners;
+        Signer signer;
+        Assets assets;
 
     private:
         context _ctx;
         Router _router;
         io_context _ioc;
+        // Reloads copy and hash whole files, which is kept off the threads
+        // that serve connections.
+        io_context _assets;
+        steady_timer _reload;
         Server &_server;
         vector<thread> _handlers;
 
@@ -59,6 +103,8 @@ namespace server {
 
     private:
         void load_http_certificate(context &ctx);
+
+        void on_reload(const error_code &ec);
     };
 }
 
@@ -12,6 +12,7 @@ server::Handoff::Handoff(
     _strand(_socket.get_executor()) {}
 
 void server::Handoff::run() {
+    trace::begin("handoff/detect", _socket.native_handle());
     async_detect_ssl(
         _socket,
         _buffer,
@@ -28,6 +29,7 @@ void server::Handoff::run() {
 }
 
 void server::Handoff::on_detect(error_code code, tribool secured) {
+    trace::end("handoff/detect", _socket.native_handle());
     if (code) log("detector/on_detect", code);
     make_shared<Http>(
         _server,
@@ -3,6 +3,7 @@
 
 #include "server/http.h"
 #include "server/helper.h"
+#include "server/trace.h"
 #include "server/router.h"
 #include "server/detector.h"
 #include "server/server.h"
@@ -3,6 +3,6 @@
 
 void server::log(const string &call, error_code &code) {
     json extra = {{"call", call}, {"error", code.message()}};
-    LOG(error) << logging::add_value("Extra", extra.dump());
+    LOG(error) << logging::add_value("Extra", move(extra));
     return;
 }
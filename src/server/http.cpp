@@ -1,6 +1,40 @@
 #include "logging.h"
 #include "server/http.h"
 
+namespace {
+    enum { statuses = 600 };
+
+    // Counter for a rule and status, rules are all added before the first
+    // request is served.
+    server::metrics::Counter &requests(
+        const server::Router &router,
+        size_t rule,
+        int status
+    ) {
+        auto label = [&router](size_t rule) {
+            return rule < router.size() ? router.route(rule) : "unmatched";
+        };
+        if (status < 0 || status >= statuses) {
+            return server::metrics::requests.with({
+                label(rule),
+                to_string(status)
+            });
+        }
+
+        static server::metrics::Table<server::metrics::Counter> table(
+            server::metrics::requests,
+            (router.size() + 1) * statuses,
+            [label](size_t key) {
+                return vector<string>{
+                    label(key / statuses),
+                    to_string(key % statuses)
+                };
+            }
+        );
+        return table.at(rule * statuses + (size_t) status);
+    }
+}
+
 server::Http::Http(
     Server &server,
     context &ctx,
@@ -13,6 +47,7 @@ server::Http::Http(
     _router(router),
     _strand(socket.get_executor().context().get_executor()),
     _timer(socket.get_executor().context(), steady_time_point::max()),
+    _trace(socket.native_handle()),
     _socket(deduce_socket(move(socket), ctx, secured)),
     _buffer(move(buffer)),
     _secured(secured),
@@ -22,6 +57,10 @@ void server::Http::queue(response_type &&resp) {
     _queue(move(resp));
 }
 
+void server::Http::queue(response<asset_body> &&resp) {
+    _queue(move(resp));
+}
+
 server::Server &server::Http::server() {
     return _server;
 }
@@ -43,8 +82,10 @@ boost::tribool &server::Http::secured() {
 }
 
 void server::Http::run() {
+    trace::Span span("http/run", _trace);
     on_timer({});
     if (_secured) {
+        trace::begin("http/handshake", _trace);
         _timer.expires_after(chrono::seconds(15));
         boost::get<ssl_socket>(_socket).async_handshake(
             ssl::stream_base::server,
@@ -133,8 +174,15 @@ void server::Http::timeout() {
 }
 
 void server::Http::on_handshake(error_code code, size_t bytes_used) {
+    trace::end("http/handshake", _trace);
     if (code == operation_aborted) return;
-    if (code) return log("handshake", code);
+    static auto &failed = metrics::handshakes.with({"error"});
+    static auto &succeeded = metrics::handshakes.with({"ok"});
+    if (code) {
+        failed.add();
+        return log("handshake", code);
+    }
+    succeeded.add();
     _buffer.consume(bytes_used);
     read();
 }
@@ -190,9 +238,15 @@ void server::Http::on_read(error_code code) {
         },
         {"fields", fields}
     };
-    LOG(info) << logging::add_value("Extra", extra.dump());
+    LOG(info) << logging::add_value("Extra", move(extra));
 
-    auto resp = _router.dispatch(*this, _req);
+    int resp;
+    size_t rule;
+    {
+        trace::Span span("router/dispatch", _trace);
+        resp = _router.dispatch(*this, _req, rule);
+    }
+    requests(_router, rule, resp).add();
     if (resp == (int) status::switching_protocols) return;
     if (!_queue.is_full()) read();
 }
@@ -204,6 +258,48 @@ void server::Http::on_write(error_code code, bool close) {
     if (_queue.on_write()) read();
 }
 
+void server::Http::send_file(const response<asset_body> &resp) {
+    ostringstream header;
+    header << resp.base();
+    _header = header.str();
+
+    auto &s = boost::get<plain_socket>(_socket);
+    asio::async_write(
+        s, asio::buffer(_header),
+        bind_executor(
+            _strand,
+            bind(
+                &Http::on_header,
+                shared_from_this(),
+                placeholders::_1,
+                resp.body().fd,
+                (uint64_t) resp.body().data.size(),
+                (bool) resp.need_eof()
+            )
+        )
+    );
+}
+
+void server::Http::on_header(
+    error_code code,
+    int fd,
+    uint64_t size,
+    bool close
+) {
+    if (code) return on_write(code, close);
+    make_shared<Sendfile>(
+        boost::get<plain_socket>(_socket),
+        _strand,
+        fd, 0, size,
+        bind(
+            &Http::on_write,
+            shared_from_this(),
+            placeholders::_1,
+            close
+        )
+    )->run();
+}
+
 void server::Http::on_shutdown(error_code code) {
     if (code == operation_aborted) return;
     if (code) return log("shutdown", code);
@@ -230,6 +326,36 @@ int server::Http::health(void *server, void *request) {
     return (int) status::ok;
 }
 
+int server::Http::exposition(void *server, void *request) {
+    auto srv = (Http *) server;
+    auto req = (request_type *) request;
+    if (req->method() != verb::head && req->method() != verb::get) {
+        srv->queue(Response::method_not_allowed(*req));
+        return (int) status::method_not_allowed;
+    }
+
+    response<string_body> resp(status::ok, req->version());
+    resp.set(field::server, string_param(BOOST_BEAST_VERSION_STRING));
+    resp.set(
+        field::content_type,
+        string_param("text/plain; version=0.0.4; charset=utf-8")
+    );
+    auto body = metrics::registry.expose();
+    if (req->method() == verb::head) {
+        resp.content_length(body.size());
+        resp.keep_alive(req->keep_alive());
+        srv->queue(move(resp));
+        return (int) status::ok;
+    }
+
+    resp.content_length(body.size());
+    resp.keep_alive(req->keep_alive());
+    resp.body() = move(body);
+    resp.prepare_payload();
+    srv->queue(move(resp));
+    return (int) status::ok;
+}
+
 int server::Http::syncaide_js(void *server, void *request) {
     auto srv = (Http *) server;
     auto req = (request_type *) request;
@@ -238,32 +364,20 @@ int server::Http::syncaide_js(void *server, void *request) {
         return (int) status::method_not_allowed;
     }
 
-    auto search = resources.find("syncaide.js");
-    if (search != resources.end()) {
+    auto asset = srv->server().frontend()->assets.find("syncaide.js");
+    if (asset) {
         response<string_body> resp(status::ok, req->version());
         resp.set(field::server, string_param(BOOST_BEAST_VERSION_STRING));
         resp.set(field::content_type, string_param("application/javascript"));
         if (req->method() == verb::head) {
-            resp.content_length(search->second.size());
+            resp.content_length(asset->data.size());
             resp.keep_alive(req->keep_alive());
             srv->queue(move(resp));
             return (int) status::ok;
         }
 
-        string body(search->second.begin(), search->second.end());
-        CryptoPP::SHA256 sha256sum;
-
-        string code_digest;
-        CryptoPP::StringSource(
-            body, true,
-            new CryptoPP::HashFilter(
-                sha256sum,
-                new CryptoPP::HexEncoder(
-                    new CryptoPP::StringSink(code_digest)
-                )
-            )
-        );
-        to_lower(code_digest);
+        auto &signer = srv->server().frontend()->signer;
+        string body(asset->data);
 
         uuid uid = random_generator{}();
         string path = fmt::format("/agent/{}", to_string(uid));
@@ -274,25 +388,12 @@ int server::Http::syncaide_js(void *server, void *request) {
         string parameters(json{
             {"id", to_string(uid)},
             {"addr", Uri("ws", "127.0.0.1", 8080, path).compose()},
-            {"digest", code_digest},
+            {"digest", string(asset->digest)},
             {"epoch", epoch}
         }.dump());
+        string signature = signer.sign(parameters);
 
-        string parameters_digest;
-        CryptoPP::StringSource(
-            parameters, true,
-            new CryptoPP::HashFilter(
-                sha256sum,
-                new CryptoPP::HexEncoder(
-                    new CryptoPP::StringSink(parameters_digest)
-                )
-            )
-        );
-        to_lower(parameters_digest);
-
-        // TODO generate ecdsa signature from parameters_digest
-
-        json prepend = {{"arguments", {"signature", parameters}}};
+        json prepend = {{"arguments", {signature, parameters}}};
         body.insert(0, fmt::format("var Module = {0};\n", prepend.dump()));
 
         resp.content_length(body.size());
@@ -315,21 +416,25 @@ int server::Http::syncaide_wasm(void *server, void *request) {
         return (int) status::method_not_allowed;
     }
 
-    auto search = resources.find("syncaide.wasm");
-    if (search != resources.end()) {
-        response<string_body> resp(status::ok, req->version());
-        resp.set(field::server, string_param(BOOST_BEAST_VERSION_STRING));
-        resp.set(field::content_type, string_param("application/wasm"));
+    auto asset = srv->server().frontend()->assets.find("syncaide.wasm");
+    if (asset) {
         if (req->method() == verb::head) {
-            resp.content_length(search->second.size());
+            response<string_body> resp(status::ok, req->version());
+            resp.set(field::server, string_param(BOOST_BEAST_VERSION_STRING));
+            resp.set(field::content_type, string_param("application/wasm"));
+            resp.content_length(asset->data.size());
             resp.keep_alive(req->keep_alive());
             srv->queue(move(resp));
             return (int) status::ok;
         }
 
-        resp.content_length(search->second.size());
+        // Written straight out of the bundle, which stays mapped until
+        // the write completes even if a newer one is swapped in meanwhile.
+        response<asset_body> resp(status::ok, req->version());
+        resp.set(field::server, string_param(BOOST_BEAST_VERSION_STRING));
+        resp.set(field::content_type, string_param("application/wasm"));
         resp.keep_alive(req->keep_alive());
-        resp.body() = string(search->second.begin(), search->second.end());
+        resp.body() = move(*asset);
         resp.prepare_payload();
         srv->queue(move(resp));
         return (int) status::ok;
@@ -378,21 +483,23 @@ int server::Http::syncaide_html(void *server, void *request) {
         return (int) status::method_not_allowed;
     }
 
-    auto search = resources.find("syncaide.html");
-    if (search != resources.end()) {
-        response<string_body> resp(status::ok, req->version());
-        resp.set(field::server, string_param(BOOST_BEAST_VERSION_STRING));
-        resp.set(field::content_type, string_param("text/html"));
+    auto asset = srv->server().frontend()->assets.find("syncaide.html");
+    if (asset) {
         if (req->method() == verb::head) {
-            resp.content_length(search->second.size());
+            response<string_body> resp(status::ok, req->version());
+            resp.set(field::server, string_param(BOOST_BEAST_VERSION_STRING));
+            resp.set(field::content_type, string_param("text/html"));
+            resp.content_length(asset->data.size());
             resp.keep_alive(req->keep_alive());
             srv->queue(move(resp));
             return (int) status::ok;
         }
 
-        resp.content_length(search->second.size());
+        response<asset_body> resp(status::ok, req->version());
+        resp.set(field::server, string_param(BOOST_BEAST_VERSION_STRING));
+        resp.set(field::content_type, string_param("text/html"));
         resp.keep_alive(req->keep_alive());
-        resp.body() = string(search->second.begin(), search->second.end());
+        resp.body() = move(*asset);
         resp.prepare_payload();
         srv->queue(move(resp));
         return (int) status::ok;
@@ -1,10 +1,14 @@
 #ifndef SYNCAIDE_SERVER_HTTP_H
 #define SYNCAIDE_SERVER_HTTP_H
 
+#include "server/assets.h"
 #include "server/miner.h"
 #include "server/response.h"
 #include "server/helper.h"
+#include "server/metrics.h"
+#include "server/trace.h"
 #include "server/router.h"
+#include "server/sendfile.h"
 #include "server/ssl_stream.h"
 #include "server/server.h"
 #include "common/uri.h"
@@ -19,6 +23,7 @@
 #include <boost/asio/strand.hpp>
 #include <boost/asio/bind_executor.hpp>
 #include <boost/asio/steady_timer.hpp>
+#include <boost/asio/write.hpp>
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
@@ -29,15 +34,12 @@
 #include <boost/algorithm/string.hpp>
 #include <nlohmann/json.hpp>
 #include <fmt/format.h>
-#include <cryptopp/sha.h>
-#include <cryptopp/hex.h>
-#include <cryptopp/filters.h>
 #include <functional>
+#include <sstream>
 #include <string>
 #include <chrono>
 
 using namespace std;
-extern map<string, vector<unsigned char>> resources;
 
 namespace server {
     namespace asio = boost::asio;
@@ -143,6 +145,14 @@ namespace server {
                                 )
                             );
                         } else {
+                            // Assets backed by a file skip the copy through
+                            // user space on plain connections.
+                            if constexpr (is_same<Body, asset_body>::value) {
+                                if (_msg.body().fd >= 0) {
+                                    return _self.send_file(_msg);
+                                }
+                            }
+
                             auto &s = boost::get<plain_socket>(_self._socket);
                             http::async_write(
                                 s, _msg,
@@ -175,6 +185,8 @@ namespace server {
         flat_buffer _buffer;
         steady_timer _timer;
         bool _eof = false;
+        string _header;
+        uint64_t _trace;
         context &_ctx;
         Router &_router;
         queue _queue;
@@ -196,6 +208,8 @@ namespace server {
 
         void queue(response_type &&resp);
 
+        void queue(response<asset_body> &&resp);
+
         Server &server();
 
         Socket &socket();
@@ -223,6 +237,10 @@ namespace server {
 
         void on_write(error_code code, bool close);
 
+        void send_file(const response<asset_body> &resp);
+
+        void on_header(error_code code, int fd, uint64_t size, bool close);
+
         void on_shutdown(error_code code);
 
     private:
@@ -235,6 +253,8 @@ namespace server {
     public:
         static int health(void *server, void *request);
 
+        static int exposition(void *server, void *request);
+
         static int syncaide_js(void *server, void *request);
 
         static int syncaide_wasm(void *server, void *request);
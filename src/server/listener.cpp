@@ -47,7 +47,9 @@ void server::Listener::run() {
 }
 
 void server::Listener::on_accept(error_code code) {
+    trace::Span span("listener/accept", _socket.native_handle());
     if (code) log("accept", code);
+    if (!code) metrics::accepts.with().add();
     make_shared<Handoff>(_server, _ctx, _router, move(_socket))->run();
     _acceptor.async_accept(
         _socket,
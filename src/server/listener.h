@@ -2,6 +2,8 @@
 #define SYNCAIDE_SERVER_LISTENER_H
 
 #include "server/helper.h"
+#include "server/metrics.h"
+#include "server/trace.h"
 #include "server/handoff.h"
 #include "server/router.h"
 #include "server/server.h"
@@ -0,0 +1,255 @@
+#include "server/metrics.h"
+
+#include <fmt/format.h>
+#include <stdexcept>
+#include <algorithm>
+
+size_t server::metrics::shard() {
+    static atomic<size_t> next{0};
+    thread_local size_t index = next++ % shards;
+    return index;
+}
+
+void server::metrics::Counter::add(uint64_t value) {
+    _cells[shard()].value.fetch_add(value, memory_order_relaxed);
+}
+
+uint64_t server::metrics::Counter::value() const {
+    uint64_t total = 0;
+    for (auto &cell : _cells) total += cell.value.load(memory_order_relaxed);
+    return total;
+}
+
+void server::metrics::Gauge::set(int64_t value) {
+    _value.store(value, memory_order_relaxed);
+}
+
+void server::metrics::Gauge::add(int64_t value) {
+    _value.fetch_add(value, memory_order_relaxed);
+}
+
+void server::metrics::Gauge::sub(int64_t value) {
+    _value.fetch_sub(value, memory_order_relaxed);
+}
+
+int64_t server::metrics::Gauge::value() const {
+    return _value.load(memory_order_relaxed);
+}
+
+server::metrics::Histogram::Histogram(vector<uint64_t> bounds) :
+    _bounds(move(bounds)) {
+    if (_bounds.size() >= buckets_limit) {
+        throw invalid_argument("histogram has too many buckets");
+    }
+    for (auto &cell : _cells) {
+        for (auto &bucket : cell.buckets) bucket.store(0, memory_order_relaxed);
+    }
+}
+
+void server::metrics::Histogram::observe(
+    chrono::steady_clock::duration elapsed
+) {
+    auto micros = chrono::duration_cast<chrono::microseconds>(elapsed).count();
+    auto value = (uint64_t) max<int64_t>(micros, 0);
+    auto bucket = lower_bound(_bounds.begin(), _bounds.end(), value);
+    auto &cell = _cells[shard()];
+    cell.buckets[bucket - _bounds.begin()].fetch_add(1, memory_order_relaxed);
+    cell.sum.fetch_add(value, memory_order_relaxed);
+}
+
+const vector<uint64_t> &server::metrics::Histogram::bounds() const {
+    return _bounds;
+}
+
+vector<uint64_t> server::metrics::Histogram::buckets() const {
+    vector<uint64_t> out(_bounds.size() + 1, 0);
+    for (auto &cell : _cells) {
+        for (size_t i = 0; i < out.size(); i++) {
+            out[i] += cell.buckets[i].load(memory_order_relaxed);
+        }
+    }
+    return out;
+}
+
+uint64_t server::metrics::Histogram::count() const {
+    uint64_t total = 0;
+    for (auto each : buckets()) total += each;
+    return total;
+}
+
+uint64_t server::metrics::Histogram::sum() const {
+    uint64_t total = 0;
+    for (auto &cell : _cells) total += cell.sum.load(memory_order_relaxed);
+    return total;
+}
+
+vector<uint64_t> server::metrics::Histogram::latency() {
+    return {
+        100, 250, 500,
+        1000, 2500, 5000,
+        10000, 25000, 50000,
+        100000, 250000, 500000,
+        1000000, 2500000, 5000000
+    };
+}
+
+void server::metrics::Registry::add(const Collector &collector) {
+    lock_guard<mutex> lock(_mutex);
+    _collectors.emplace_back(&collector);
+}
+
+string server::metrics::Registry::expose() const {
+    string out;
+    lock_guard<mutex> lock(_mutex);
+    for (auto collector : _collectors) collector->expose(out);
+    return out;
+}
+
+string server::metrics::labels(
+    const vector<string> &names,
+    const vector<string> &values
+) {
+    string out;
+    for (size_t i = 0; i < names.size() && i < values.size(); i++) {
+        if (!out.empty()) out += ',';
+        out += names[i] + "=\"";
+        for (auto c : values[i]) {
+            if (c == '\\') out += "\\\\";
+            else if (c == '"') out += "\\\"";
+            else if (c == '\n') out += "\\n";
+            else out += c;
+        }
+        out += '"';
+    }
+    return out.empty() ? out : "{" + out + "}";
+}
+
+void server::metrics::write(
+    string &out,
+    const string &name,
+    const string &labels,
+    const Counter &metric
+) {
+    out += fmt::format("{}{} {}\n", name, labels, metric.value());
+}
+
+void server::metrics::write(
+    string &out,
+    const string &name,
+    const string &labels,
+    const Gauge &metric
+) {
+    out += fmt::format("{}{} {}\n", name, labels, metric.value());
+}
+
+void server::metrics::write(
+    string &out,
+    const string &name,
+    const string &labels,
+    const Histogram &metric
+) {
+    // Bucket bounds, sum and count are reported in seconds as Prometheus
+    // expects, with the cumulative counts it uses for quantile estimates.
+    auto inner = labels.empty()
+                 ? string()
+                 : labels.substr(1, labels.size() - 2);
+    auto prefix = inner.empty() ? string("{") : "{" + inner + ",";
+
+    auto buckets = metric.buckets();
+    auto &bounds = metric.bounds();
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        cumulative += buckets[i];
+        auto le = i < bounds.size()
+                  ? fmt::format("{}", bounds[i] / 1e6)
+                  : string("+Inf");
+        out += fmt::format(
+            "{}_bucket{}le=\"{}\"}} {}\n",
+            name, prefix, le, cumulative
+        );
+    }
+    out += fmt::format("{}_sum{} {}\n", name, labels, metric.sum() / 1e6);
+    out += fmt::format("{}_count{} {}\n", name, labels, cumulative);
+}
+
+const char *server::metrics::type(const Counter &) {
+    return "counter";
+}
+
+const char *server::metrics::type(const Gauge &) {
+    return "gauge";
+}
+
+const char *server::metrics::type(const Histogram &) {
+    return "histogram";
+}
+
+server::metrics::Registry server::metrics::registry;
+
+server::metrics::Family<server::metrics::Counter> server::metrics::accepts(
+    registry,
+    "syncaide_accepts_total",
+    "Connections accepted on the frontend listener."
+);
+
+server::metrics::Family<server::metrics::Counter> server::metrics::handshakes(
+    registry,
+    "syncaide_tls_handshakes_total",
+    "TLS handshakes on the frontend by outcome.",
+    {"result"}
+);
+
+server::metrics::Family<server::metrics::Counter> server::metrics::requests(
+    registry,
+    "syncaide_http_requests_total",
+    "HTTP requests served by route and status.",
+    {"route", "status"}
+);
+
+server::metrics::Family<server::metrics::Gauge> server::metrics::sessions(
+    registry,
+    "syncaide_websocket_sessions",
+    "Agent websocket sessions currently open."
+);
+
+server::metrics::Family<server::metrics::Counter> server::metrics::frames(
+    registry,
+    "syncaide_websocket_frames_total",
+    "Agent websocket messages received, by message type.",
+    {"type"}
+);
+
+server::metrics::Family<server::metrics::Counter> server::metrics::gossip(
+    registry,
+    "syncaide_gossip_rounds_total",
+    "Peer sampling gossip rounds by outcome.",
+    {"result"}
+);
+
+server::metrics::Family<server::metrics::Histogram>
+    server::metrics::gossip_latency(
+    registry,
+    "syncaide_gossip_round_seconds",
+    "Time taken by the gossip exchange with a peer."
+);
+
+server::metrics::Family<server::metrics::Counter> server::metrics::suspicions(
+    registry,
+    "syncaide_gossip_suspicions_total",
+    "Peers dropped from the view after failing gossip exchanges."
+);
+
+server::metrics::Family<server::metrics::Histogram> server::metrics::upstream(
+    registry,
+    "syncaide_upstream_request_seconds",
+    "Latency of successful daemon RPC requests by method.",
+    {"method"}
+);
+
+server::metrics::Family<server::metrics::Counter>
+    server::metrics::upstream_failures(
+    registry,
+    "syncaide_upstream_failures_total",
+    "Daemon RPC requests that failed on every daemon, by method.",
+    {"method"}
+);
@@ -0,0 +1,318 @@
+#ifndef SYNCAIDE_SERVER_METRICS_H
+#define SYNCAIDE_SERVER_METRICS_H
+
+#include <functional>
+#include <cstdint>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <array>
+#include <mutex>
+
+using namespace std;
+
+namespace server {
+    namespace metrics {
+        enum {
+            shards = 16,
+            line = 64,
+            // Buckets a histogram may have, its last one included.
+            buckets_limit = 24
+        };
+
+        // Index of the calling thread's shard. Threads are handed shards
+        // round robin the first time they record anything, so the handful
+        // of io_context threads each end up writing their own cache line.
+        size_t shard();
+
+        // Monotonic counter split across shards. Writers only ever touch
+        // their own shard with a relaxed add and readers sum them up.
+        class Counter {
+            struct alignas(line) Cell {
+                atomic<uint64_t> value{0};
+            };
+
+        private:
+            array<Cell, shards> _cells;
+
+        public:
+            void add(uint64_t value = 1);
+
+            uint64_t value() const;
+        };
+
+        // Value that goes up and down. Gauges are set far less often than
+        // counters are bumped, so a single atomic is enough.
+        class Gauge {
+        private:
+            atomic<int64_t> _value{0};
+
+        public:
+            void set(int64_t value);
+
+            void add(int64_t value = 1);
+
+            void sub(int64_t value = 1);
+
+            int64_t value() const;
+        };
+
+        // Latency histogram over fixed bucket bounds in microseconds. The
+        // last bucket catches everything above the largest bound. A shard's
+        // buckets live in its own cell rather than on the heap, where those
+        // of neighbouring shards could end up on the same cache line.
+        class Histogram {
+            struct alignas(line) Cell {
+                array<atomic<uint64_t>, buckets_limit> buckets;
+                atomic<uint64_t> sum{0};
+            };
+
+        private:
+            vector<uint64_t> _bounds;
+            array<Cell, shards> _cells;
+
+        public:
+            // Throws invalid_argument for more bounds than buckets_limit
+            // leaves room for.
+            explicit Histogram(vector<uint64_t> bounds = latency());
+
+            void observe(chrono::steady_clock::duration elapsed);
+
+            const vector<uint64_t> &bounds() const;
+
+            vector<uint64_t> buckets() const;
+
+            uint64_t count() const;
+
+            uint64_t sum() const;
+
+            static vector<uint64_t> latency();
+        };
+
+        class Registry;
+
+        class Collector {
+        public:
+            virtual ~Collector() = default;
+
+            virtual void expose(string &out) const = 0;
+        };
+
+        // Metrics sharing a name and differing only by label values. Once a
+        // child exists, finding it again is a lock-free probe over an open
+        // addressed table, so hot paths can look up by label on every call.
+        // Only the first use of a label combination takes the mutex. The
+        // table is bounded and any combination past that is folded into a
+        // single child labelled "overflow".
+        template<typename Metric>
+        class Family : public Collector {
+            enum {
+                slots = 256
+            };
+
+            struct Child {
+                string key;
+                vector<string> values;
+                Metric metric;
+
+                Child(string key, vector<string> values) :
+                    key(move(key)),
+                    values(move(values)) {}
+            };
+
+        private:
+            string _name;
+            string _help;
+            vector<string> _labels;
+            mutable mutex _mutex;
+            array<atomic<Child *>, slots> _slots;
+            vector<unique_ptr<Child>> _children;
+            unique_ptr<Child> _overflow;
+
+        public:
+            Family(
+                Registry &registry,
+                const string &name,
+                const string &help,
+                const vector<string> &labels = {}
+            );
+
+            Metric &with(const vector<string> &values = {});
+
+            void expose(string &out) const override;
+
+        private:
+            static string key(const vector<string> &values);
+        };
+
+        // Children of a family for labels that follow from a small integer
+        // key, such as a route and a status. Each is looked up once and
+        // kept, so the hot path neither builds label strings nor probes the
+        // family. Keys past the size are looked up every time.
+        template<typename Metric>
+        class Table {
+            using labels_type = function<vector<string>(size_t)>;
+
+        private:
+            Family<Metric> &_family;
+            labels_type _labels;
+            size_t _size;
+            unique_ptr<atomic<Metric *>[]> _metrics;
+
+        public:
+            Table(Family<Metric> &family, size_t size, labels_type labels);
+
+            Metric &at(size_t key);
+        };
+
+        class Registry {
+        private:
+            mutable mutex _mutex;
+            vector<const Collector *> _collectors;
+
+        public:
+            void add(const Collector &collector);
+
+            string expose() const;
+        };
+
+        string labels(
+            const vector<string> &names,
+            const vector<string> &values
+        );
+
+        void write(
+            string &out,
+            const string &name,
+            const string &labels,
+            const Counter &metric
+        );
+
+        void write(
+            string &out,
+            const string &name,
+            const string &labels,
+            const Gauge &metric
+        );
+
+        void write(
+            string &out,
+            const string &name,
+            const string &labels,
+            const Histogram &metric
+        );
+
+        const char *type(const Counter &);
+
+        const char *type(const Gauge &);
+
+        const char *type(const Histogram &);
+
+        extern Registry registry;
+        extern Family<Counter> accepts;
+        extern Family<Counter> handshakes;
+        extern Family<Counter> requests;
+        extern Family<Gauge> sessions;
+        extern Family<Counter> frames;
+        extern Family<Counter> gossip;
+        extern Family<Histogram> gossip_latency;
+        extern Family<Counter> suspicions;
+        extern Family<Histogram> upstream;
+        extern Family<Counter> upstream_failures;
+    }
+}
+
+template<typename Metric>
+server::metrics::Family<Metric>::Family(
+    Registry &registry,
+    const string &name,
+    const string &help,
+    const vector<string> &labels
+) : _name(name),
+    _help(help),
+    _labels(labels),
+    _overflow(new Child(
+        string(),
+        vector<string>(labels.size(), "overflow")
+    )) {
+    for (auto &slot : _slots) slot.store(nullptr, memory_order_relaxed);
+    registry.add(*this);
+}
+
+template<typename Metric>
+Metric &server::metrics::Family<Metric>::with(const vector<string> &values) {
+    auto id = key(values);
+    auto start = hash<string>{}(id) % slots;
+    for (size_t i = 0; i < slots; i++) {
+        auto child = _slots[(start + i) % slots].load(memory_order_acquire);
+        if (!child) break;
+        if (child->key == id) return child->metric;
+    }
+
+    lock_guard<mutex> lock(_mutex);
+    for (size_t i = 0; i < slots; i++) {
+        auto &slot = _slots[(start + i) % slots];
+        auto child = slot.load(memory_order_relaxed);
+        if (child && child->key == id) return child->metric;
+        if (!child) {
+            _children.emplace_back(new Child(id, values));
+            slot.store(_children.back().get(), memory_order_release);
+            return _children.back()->metric;
+        }
+    }
+    return _overflow->metric;
+}
+
+template<typename Metric>
+void server::metrics::Family<Metric>::expose(string &out) const {
+    out += "# HELP " + _name + " " + _help + "\n";
+    out += "# TYPE " + _name + " " + type(_overflow->metric) + "\n";
+
+    lock_guard<mutex> lock(_mutex);
+    for (auto &child : _children) {
+        write(out, _name, labels(_labels, child->values), child->metric);
+    }
+    if (_children.size() >= slots) {
+        write(out, _name, labels(_labels, _overflow->values), _overflow->metric);
+    }
+}
+
+template<typename Metric>
+string server::metrics::Family<Metric>::key(const vector<string> &values) {
+    string out;
+    for (auto &each : values) {
+        out += each;
+        out += '\xff';
+    }
+    return out;
+}
+
+template<typename Metric>
+server::metrics::Table<Metric>::Table(
+    Family<Metric> &family,
+    size_t size,
+    labels_type labels
+) : _family(family),
+    _labels(move(labels)),
+    _size(size),
+    _metrics(new atomic<Metric *>[size]) {
+    for (size_t i = 0; i < size; i++) {
+        _metrics[i].store(nullptr, memory_order_relaxed);
+    }
+}
+
+template<typename Metric>
+Metric &server::metrics::Table<Metric>::at(size_t key) {
+    if (key >= _size) return _family.with(_labels(key));
+    auto metric = _metrics[key].load(memory_order_acquire);
+    if (metric) return *metric;
+
+    // Racing threads resolve the same child, whichever stores last wins.
+    metric = &_family.with(_labels(key));
+    _metrics[key].store(metric, memory_order_release);
+    return *metric;
+}
+
+#endif //SYNCAIDE_SERVER_METRICS_H
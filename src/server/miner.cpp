@@ -1,6 +1,28 @@
 #include "logging.h"
 #include "server/miner.h"
 
+namespace {
+    enum { invalid = protos::MessageType_MAX + 1 };
+
+    // Counter for a message type, anything that did not parse or carries
+    // a type this build does not know counts as invalid.
+    server::metrics::Counter &frames(bool parsed, int type) {
+        static server::metrics::Table<server::metrics::Counter> table(
+            server::metrics::frames,
+            invalid + 1,
+            [](size_t key) {
+                return vector<string>{
+                    key < invalid && protos::MessageType_IsValid((int) key)
+                        ? protos::MessageType_Name((protos::MessageType) key)
+                        : "invalid"
+                };
+            }
+        );
+        auto known = parsed && protos::MessageType_IsValid(type);
+        return table.at(known ? (size_t) type : (size_t) invalid);
+    }
+}
+
 server::Miner::Miner(
     Server &server,
     context &ctx,
@@ -14,6 +36,7 @@ server::Miner::Miner(
         socket.next_layer().get_executor().context(),
         steady_time_point::max()
     ),
+    _trace(socket.next_layer().native_handle()),
     _socket(ssl_socket(move(socket))),
     _secured(secured),
     _id(id) {}
@@ -28,6 +51,7 @@ server::Miner::Miner(
     _ctx(ctx),
     _strand(socket.get_executor().context().get_executor()),
     _timer(socket.get_executor().context(), steady_time_point::max()),
+    _trace(socket.native_handle()),
     _socket(plain_socket(move(socket))),
     _secured(secured),
     _id(id) {}
@@ -42,6 +66,7 @@ void server::Miner::run(request_type &&req) {
 }
 
 void server::Miner::accept(request_type &&req) {
+    trace::begin("miner/accept", _trace);
     _timer.expires_after(chrono::seconds(15));
     if (_secured) {
         boost::get<ssl_socket>(_socket).async_accept(
@@ -71,8 +96,12 @@ void server::Miner::accept(request_type &&req) {
 }
 
 void server::Miner::on_accept(error_code code) {
+    trace::end("miner/accept", _trace);
     if (code == operation_aborted) return;
     if (code) return log("accept", code);
+    _open = true;
+    metrics::sessions.with().add();
+    _server.frontend()->miners.connect(_id);
     read();
 }
 
@@ -110,11 +139,17 @@ void server::Miner::read() {
 void server::Miner::on_read(error_code code, size_t bytes_transferred) {
     ignore_unused(bytes_transferred);
     if (code == operation_aborted) return;
-    if (code == websocket::error::closed) return;
-    if (code) log("read", code);
+    if (code == websocket::error::closed) return leave();
+    if (code) {
+        // Whatever is in the buffer is what the last read left behind.
+        log("read", code);
+        return leave();
+    }
 
+    trace::Span span("miner/read", _trace);
     protos::Message msg;
-    msg.ParseFromString(buffers_to_string(_buffer.data()));
+    auto parsed = msg.ParseFromString(buffers_to_string(_buffer.data()));
+    frames(parsed, msg.type()).add();
     switch (msg.type()) {
         case protos::MessageType::LOGIN:
             login(msg);
@@ -133,6 +168,8 @@ void server::Miner::on_read(error_code code, size_t bytes_transferred) {
     }
 
     _buffer.consume(_buffer.size());
+    if (_close) return;
+    read();
 
 //    protos::Peer outgoing;
 //    outgoing.set_addr("2.2.2.2");
@@ -176,7 +213,6 @@ void server::Miner::on_write(error_code code, size_t bytes_transferred) {
     ignore_unused(bytes_transferred);
     if (code == operation_aborted) return;
     if (code) return log("write", code);
-    read();
 }
 
 void server::Miner::on_timer(error_code code) {
@@ -230,31 +266,49 @@ void server::Miner::timeout() {
     }
 }
 
+void server::Miner::reject() {
+    // Closing reads on by itself until the agent answers the close frame.
+    if (_close) return;
+    _close = true;
+    _timer.expires_after(chrono::seconds(15));
+    auto handler = bind_executor(
+        _strand,
+        bind(&Miner::on_conclude, shared_from_this(), placeholders::_1)
+    );
+    auto code = (const uint16_t) websocket::close_code::policy_error;
+    if (_secured) {
+        boost::get<ssl_socket>(_socket).async_close(code, handler);
+    } else {
+        boost::get<plain_socket>(_socket).async_close(code, handler);
+    }
+}
+
 void server::Miner::on_conclude(error_code code) {
+    leave();
     if (code == operation_aborted) return;
     if (code) return log("shutdown", code);
 }
 
+void server::Miner::leave() {
+    if (_left) return;
+    _left = true;
+    if (_open) metrics::sessions.with().sub();
+    _server.frontend()->miners.remove(_id, shared_from_this());
+}
+
 void server::Miner::login(protos::Message &msg) {
     cerr << "protos::MessageType::LOGIN" << endl;
     const auto &body = msg.login();
 //    cerr << "signature: " << body.signature() << endl;
 //    cerr << "parameters: " << body.parameters() << endl;
 
-    string parameters_digest;
-    CryptoPP::SHA256 sha256sum;
-    CryptoPP::StringSource(
-        body.parameters(), true,
-        new CryptoPP::HashFilter(
-            sha256sum,
-            new CryptoPP::HexEncoder(
-                new CryptoPP::StringSink(parameters_digest)
-            )
-        )
-    );
-    to_lower(parameters_digest);
-
-    // TODO verify signature with parameters_digest and private key
+    auto &signer = _server.frontend()->signer;
+    if (!signer.verify(body.parameters(), body.signature())) {
+        json extra = {{"id", _id}};
+        LOG(warning) << logging::add_value("Extra", move(extra))
+                     << "agent parameters signature verification failed.";
+        return reject();
+    }
 
     _server.frontend()->miners.add(_id, shared_from_this());
 
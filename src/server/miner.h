@@ -2,6 +2,8 @@
 #define SYNCAIDE_SERVER_WEBSOCKET_H
 
 #include "server/helper.h"
+#include "server/metrics.h"
+#include "server/trace.h"
 #include "server/ssl_stream.h"
 #include "protos/message.pb.h"
 #include "server/server.h"
@@ -65,6 +67,9 @@ namespace server {
         steady_timer _timer;
         bool _close = false;
         bool _eof = false;
+        bool _left = false;
+        bool _open = false;
+        uint64_t _trace;
         context &_ctx;
         string _id;
 
@@ -112,8 +117,14 @@ namespace server {
 
         void timeout();
 
+        // Closes the session with a policy error, for an agent that is
+        // not allowed in.
+        void reject();
+
         void on_conclude(error_code code);
 
+        void leave();
+
     private:
         void login(protos::Message &msg);
     };
@@ -0,0 +1,247 @@
+#include "logging.h"
+#include "server/notifier.h"
+
+server::Notifier::Notifier(
+    io_context &ioc,
+    const Uri &uri,
+    const string &topic,
+    handler_type handler
+) : _uri(uri),
+    _topic(topic),
+    _handler(move(handler)),
+    _resolver(ioc),
+    _socket(ioc),
+    _timer(ioc, steady_time_point::max()),
+    _backoff(1) {}
+
+void server::Notifier::run() {
+    connect();
+}
+
+void server::Notifier::stop() {
+    _stopped = true;
+    _connected = false;
+    _timer.cancel();
+    _resolver.cancel();
+
+    error_code code;
+    _socket.shutdown(tcp::socket::shutdown_both, code);
+    _socket.close(code);
+}
+
+bool server::Notifier::connected() const {
+    return _connected;
+}
+
+void server::Notifier::connect() {
+    _resolver.async_resolve(
+        _uri.host(),
+        to_string(_uri.port()),
+        bind(
+            &Notifier::on_resolve,
+            shared_from_this(),
+            placeholders::_1,
+            placeholders::_2
+        )
+    );
+}
+
+void server::Notifier::retry(const string &call, error_code code) {
+    if (_stopped || _retrying) return;
+    _retrying = true;
+
+    log("notifier/" + call, code);
+    _connected = false;
+    _message.clear();
+
+    error_code ignored;
+    _socket.close(ignored);
+
+    _timer.expires_after(_backoff);
+    _timer.async_wait(
+        bind(
+            &Notifier::on_timer,
+            shared_from_this(),
+            placeholders::_1
+        )
+    );
+    _backoff = min(_backoff * 2, chrono::seconds(backoff));
+}
+
+void server::Notifier::read() {
+    async_read(
+        _socket,
+        buffer(&_flags, 1),
+        bind(
+            &Notifier::on_flags,
+            shared_from_this(),
+            placeholders::_1,
+            placeholders::_2
+        )
+    );
+}
+
+void server::Notifier::on_resolve(
+    error_code code,
+    tcp::resolver::results_type results
+) {
+    if (code == boost::asio::error::operation_aborted) return;
+    if (code) return retry("resolve", code);
+    async_connect(
+        _socket,
+        results.begin(),
+        results.end(),
+        bind(
+            &Notifier::on_connect,
+            shared_from_this(),
+            placeholders::_1
+        )
+    );
+}
+
+void server::Notifier::on_connect(error_code code) {
+    if (code == boost::asio::error::operation_aborted) return;
+    if (code) return retry("connect", code);
+
+    // Greeting: signature, version 3.0, NULL mechanism, as-server clear.
+    _outgoing.assign(greeting, '\0');
+    _outgoing[0] = '\xff';
+    _outgoing[9] = '\x7f';
+    _outgoing[10] = '\x03';
+    _outgoing.replace(12, 4, "NULL");
+
+    // READY command announcing a SUB socket.
+    string ready = string("\x05") + "READY"
+                   + string("\x0b") + "Socket-Type"
+                   + string("\x00\x00\x00\x03", 4) + "SUB";
+    _outgoing += (char) command;
+    _outgoing += (char) ready.size();
+    _outgoing += ready;
+
+    // Subscription message, a 0x01 byte followed by the topic prefix.
+    _outgoing += '\0';
+    _outgoing += (char) (_topic.size() + 1);
+    _outgoing += '\x01';
+    _outgoing += _topic;
+
+    async_write(
+        _socket,
+        buffer(_outgoing),
+        bind(
+            &Notifier::on_write,
+            shared_from_this(),
+            placeholders::_1,
+            placeholders::_2
+        )
+    );
+
+    async_read(
+        _socket,
+        buffer(_greeting),
+        bind(
+            &Notifier::on_greeting,
+            shared_from_this(),
+            placeholders::_1,
+            placeholders::_2
+        )
+    );
+}
+
+void server::Notifier::on_write(error_code code, size_t bytes_transferred) {
+    ignore_unused(bytes_transferred);
+    if (code == boost::asio::error::operation_aborted) return;
+    if (code) return retry("write", code);
+}
+
+void server::Notifier::on_greeting(
+    error_code code,
+    size_t bytes_transferred
+) {
+    ignore_unused(bytes_transferred);
+    if (code == boost::asio::error::operation_aborted) return;
+    if (code) return retry("greeting", code);
+    if (_greeting[0] != 0xff || _greeting[9] != 0x7f || _greeting[10] < 3) {
+        return retry("greeting", boost::asio::error::invalid_argument);
+    }
+    read();
+}
+
+void server::Notifier::on_flags(error_code code, size_t bytes_transferred) {
+    ignore_unused(bytes_transferred);
+    if (code == boost::asio::error::operation_aborted) return;
+    if (code) return retry("read", code);
+    async_read(
+        _socket,
+        buffer(_header.data(), (_flags & large) ? 8 : 1),
+        bind(
+            &Notifier::on_size,
+            shared_from_this(),
+            placeholders::_1,
+            placeholders::_2
+        )
+    );
+}
+
+void server::Notifier::on_size(error_code code, size_t bytes_transferred) {
+    if (code == boost::asio::error::operation_aborted) return;
+    if (code) return retry("read", code);
+
+    uint64_t size = 0;
+    for (size_t i = 0; i < bytes_transferred; i++) {
+        size = (size << 8) | _header[i];
+    }
+    if (size > limit) {
+        return retry("read", boost::asio::error::message_size);
+    }
+
+    _frame.resize(size);
+    if (size == 0) return on_frame({}, 0);
+    async_read(
+        _socket,
+        buffer(&_frame[0], _frame.size()),
+        bind(
+            &Notifier::on_frame,
+            shared_from_this(),
+            placeholders::_1,
+            placeholders::_2
+        )
+    );
+}
+
+void server::Notifier::on_frame(error_code code, size_t bytes_transferred) {
+    ignore_unused(bytes_transferred);
+    if (code == boost::asio::error::operation_aborted) return;
+    if (code) return retry("read", code);
+
+    if (_flags & command) {
+        string name;
+        if (!_frame.empty()) {
+            name = _frame.substr(1, (size_t) (unsigned char) _frame[0]);
+        }
+        if (name == "READY") {
+            _connected = true;
+            _backoff = chrono::seconds(1);
+
+            json extra = {{"notify", _uri.compose()}, {"topic", _topic}};
+            LOG(info) << logging::add_value("Extra", move(extra))
+                      << "subscribed to daemon notifications.";
+        } else if (name == "ERROR") {
+            return retry("handshake", boost::asio::error::connection_refused);
+        }
+        return read();
+    }
+
+    _message += _frame;
+    if (!(_flags & more)) {
+        _handler(_message);
+        _message.clear();
+    }
+    read();
+}
+
+void server::Notifier::on_timer(error_code code) {
+    if (code == boost::asio::error::operation_aborted) return;
+    if (_stopped) return;
+    _retrying = false;
+    connect();
+}
@@ -0,0 +1,106 @@
+#ifndef SYNCAIDE_SERVER_NOTIFIER_H
+#define SYNCAIDE_SERVER_NOTIFIER_H
+
+#include "server/helper.h"
+#include "common/uri.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/core/ignore_unused.hpp>
+#include <functional>
+#include <string>
+#include <array>
+
+using namespace std;
+
+namespace server {
+    using boost::asio::io_context;
+    using boost::asio::steady_timer;
+    using boost::asio::ip::tcp;
+    using boost::asio::async_connect;
+    using boost::asio::async_read;
+    using boost::asio::async_write;
+    using boost::asio::buffer;
+    using boost::ignore_unused;
+    using common::Uri;
+
+    // Subscriber for the daemon's ZMQ block notifications (monerod
+    // --zmq-pub). It speaks just enough ZMTP 3.0 with the NULL mechanism to
+    // register as a SUB socket, which keeps libzmq out of the dependencies.
+    class Notifier : public enable_shared_from_this<Notifier> {
+        using handler_type = function<void(const string &)>;
+
+        enum {
+            greeting = 64,
+            limit = 16 * 1024 * 1024,
+            backoff = 30
+        };
+
+        enum flags {
+            more = 0x01,
+            large = 0x02,
+            command = 0x04
+        };
+
+    private:
+        Uri _uri;
+        string _topic;
+        handler_type _handler;
+        tcp::resolver _resolver;
+        tcp::socket _socket;
+        steady_timer _timer;
+        chrono::seconds _backoff;
+        bool _connected = false;
+        bool _stopped = false;
+        bool _retrying = false;
+        string _outgoing;
+        array<unsigned char, greeting> _greeting;
+        array<unsigned char, 8> _header;
+        unsigned char _flags = 0;
+        string _frame;
+        string _message;
+
+    public:
+        Notifier(
+            io_context &ioc,
+            const Uri &uri,
+            const string &topic,
+            handler_type handler
+        );
+
+        void run();
+
+        void stop();
+
+        bool connected() const;
+
+    private:
+        void connect();
+
+        void retry(const string &call, error_code code);
+
+        void read();
+
+        void on_resolve(error_code code, tcp::resolver::results_type results);
+
+        void on_connect(error_code code);
+
+        void on_write(error_code code, size_t bytes_transferred);
+
+        void on_greeting(error_code code, size_t bytes_transferred);
+
+        void on_flags(error_code code, size_t bytes_transferred);
+
+        void on_size(error_code code, size_t bytes_transferred);
+
+        void on_frame(error_code code, size_t bytes_transferred);
+
+        void on_timer(error_code code);
+    };
+}
+
+#endif //SYNCAIDE_SERVER_NOTIFIER_H
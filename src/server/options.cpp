@@ -31,10 +31,21 @@ bool server::Options::parse(int argc, const char **argv) {
                 ->default_value(vector<string>{}, string())
                 ->notifier(bind(&server::Options::on_joins, this, _1)),
             "connect to cluster through the listed addresses.")
-        ("upstream,u", po::value<string>()
-                ->default_value(defaults.network.upstream.netloc())
-                ->notifier(bind(&server::Options::on_upstream, this, _1)),
-            "designated cryptocurrency client for connection with on the listed address.")
+        ("upstream,u", po::value<vector<string>>()
+                ->multitoken()
+                ->default_value(
+                    vector<string>{defaults.network.upstream.netloc()},
+                    defaults.network.upstream.netloc()
+                )
+                ->notifier(bind(&server::Options::on_upstreams, this, _1)),
+            "designated cryptocurrency clients for connection with on the listed addresses, the fastest healthy one is used.")
+        ("hedge", po::value<unsigned int>(&network.hedge)
+                ->default_value(defaults.network.hedge),
+            "milliseconds to wait on a block template before also asking the next cryptocurrency client.")
+        ("notify,n", po::value<string>()
+                ->default_value(string())
+                ->notifier(bind(&server::Options::on_notify, this, _1)),
+            "zmq publisher of the cryptocurrency client used to refresh block templates as soon as blocks arrive (e.g. tcp://127.0.0.1:18083).")
         ("frontend,f", po::value<string>()
                 ->default_value(defaults.network.frontend.netloc())
                 ->notifier(bind(&server::Options::on_frontend, this, _1)),
@@ -43,7 +54,43 @@ bool server::Options::parse(int argc, const char **argv) {
                 ->multitoken()
                 ->default_value(defaults.network.threads)
                 ->notifier(bind(&server::Options::on_threads, this, _1)),
-            "number of threads that frontend context should allow to run concurrently.");
+            "number of threads that frontend context should allow to run concurrently.")
+        ("key,k", po::value<string>(&security.key)
+                ->default_value(string()),
+            "file with the DER encoded ecdsa key used to sign agent parameters (generated when missing).")
+        ("verify-cache", po::value<size_t>(&security.cache)
+                ->default_value(defaults.security.cache),
+            "number of verified agent signatures remembered for reconnecting miners.")
+        ("assets", po::value<string>()
+                ->default_value(string())
+                ->notifier(bind(&server::Options::on_assets, this, _1)),
+            "directory to serve the agent bundle from instead of the built in one, files are picked up when replaced by renaming new ones over them.")
+        ("assets-reload", po::value<unsigned int>(&assets.reload)
+                ->default_value(defaults.assets.reload),
+            "seconds between checks of the assets directory for a new bundle.")
+        ("view-snapshot", po::value<string>(&peers.snapshot)
+                ->default_value(string()),
+            "file the peer view is saved to every few seconds and restored from at startup (disabled when empty).")
+        ("peer-selection", po::value<string>()
+                ->default_value(peers.selection)
+                ->notifier(bind(&server::Options::on_selection, this, _1)),
+            "how gossip targets are picked, either random or nearest (prefers peers with the shortest measured round trip).")
+        ("nearby", po::value<double>(&peers.nearby)
+                ->default_value(peers.nearby)
+                ->notifier(bind(&server::Options::on_nearby, this, _1)),
+            "share of the gossip targets picked by round trip under the nearest peer selection.")
+        ("peering-cpus", po::value<string>()
+                ->default_value(string())
+                ->notifier(bind(&server::Options::on_cpus, this, "peering-cpus", ref(cpus.peering), _1)),
+            "cpus the gossip and rpc threads are kept on, as listed by the kernel (e.g. 0-1,8).")
+        ("upstream-cpus", po::value<string>()
+                ->default_value(string())
+                ->notifier(bind(&server::Options::on_cpus, this, "upstream-cpus", ref(cpus.upstream), _1)),
+            "cpus the threads talking to the cryptocurrency clients are kept on.")
+        ("frontend-cpus", po::value<string>()
+                ->default_value(string())
+                ->notifier(bind(&server::Options::on_cpus, this, "frontend-cpus", ref(cpus.frontend), _1)),
+            "cpus the threads serving frontend connections are kept on, best all on one numa node.");
 
     vector<po::positional_options_description> positions;
     positions.emplace_back(po::positional_options_description());
@@ -120,6 +167,11 @@ bool server::Options::parse(int argc, const char **argv) {
         joins.emplace_back(join.netloc());
     }
 
+    auto upstreams = json::array();
+    for (auto &upstream : this->network.upstreams) {
+        upstreams.emplace_back(upstream.netloc());
+    }
+
     // @formatter:off
     json extra = {
         {"network",
@@ -127,21 +179,40 @@ bool server::Options::parse(int argc, const char **argv) {
                 {"advertise", this->network.advertise.netloc()},
                 {"bind", this->network.bind.netloc()},
                 {"joins", joins},
-                {"upstream", this->network.upstream.netloc()},
+                {"upstreams", upstreams},
+                {"hedge", this->network.hedge},
+                {"notify", this->network.notify.compose()},
                 {"frontend", this->network.frontend.netloc()}
             }
         },
+        {"assets",
+            {
+                {"path", this->assets.path},
+                {"reload", this->assets.reload}
+            }
+        },
+        {"cpus",
+            {
+                {"peering", this->cpus.peering.str()},
+                {"upstream", this->cpus.upstream.str()},
+                {"frontend", this->cpus.frontend.str()}
+            }
+        },
         {"peers",
             {
                 {"c", this->peers.c},
                 {"H", this->peers.H},
-                {"S", this->peers.S}
+                {"S", this->peers.S},
+                {"k", this->peers.k},
+                {"snapshot", this->peers.snapshot},
+                {"selection", this->peers.selection},
+                {"nearby", this->peers.nearby}
             }
         }
     };
     // @formatter:on
 
-    LOG(info) << logging::add_value("Extra", extra.dump());
+    LOG(info) << logging::add_value("Extra", move(extra));
     return true;
 }
 
@@ -174,15 +245,26 @@ void server::Options::on_joins(vector<string> uris) {
     }
 }
 
-void server::Options::on_upstream(string uri) {
+void server::Options::on_upstreams(vector<string> uris) {
     try {
-        network.upstream = Uri(uri);
+        for (auto &uri : uris) {
+            network.upstreams.emplace_back(Uri(uri));
+        }
     } catch (const exception &e) {
         auto kind = po::validation_error::invalid_option_value;
         throw po::validation_error(kind, "upstream");
     }
 }
 
+void server::Options::on_notify(string uri) {
+    try {
+        if (!uri.empty()) network.notify = Uri(uri);
+    } catch (const exception &e) {
+        auto kind = po::validation_error::invalid_option_value;
+        throw po::validation_error(kind, "notify");
+    }
+}
+
 void server::Options::on_frontend(string uri) {
     try {
         network.frontend = Uri(uri);
@@ -198,4 +280,40 @@ void server::Options::on_threads(int threads) {
     } else if (threads > thread::hardware_concurrency()) {
         network.threads = thread::hardware_concurrency();
     }
-}
\ No newline at end of file
+}
+
+void server::Options::on_assets(string path) {
+    if (!path.empty() && !fs::is_directory(path)) {
+        auto kind = po::validation_error::invalid_option_value;
+        throw po::validation_error(kind, "assets");
+    }
+    assets.path = path;
+}
+
+void server::Options::on_selection(string policy) {
+    if (policy != "random" && policy != "nearest") {
+        auto kind = po::validation_error::invalid_option_value;
+        throw po::validation_error(kind, "peer-selection");
+    }
+    peers.selection = policy;
+}
+
+void server::Options::on_nearby(double share) {
+    if (!(share >= 0 && share <= 1)) {
+        auto kind = po::validation_error::invalid_option_value;
+        throw po::validation_error(kind, "nearby");
+    }
+}
+
+void server::Options::on_cpus(
+    const string &option,
+    Placement &cpus,
+    string list
+) {
+    try {
+        cpus = Placement(list);
+    } catch (const exception &e) {
+        auto kind = po::validation_error::invalid_option_value;
+        throw po::validation_error(kind, option);
+    }
+}
@@ -2,6 +2,7 @@
 #define SYNCAIDE_SERVER_OPTIONS_H
 
 #include "common/options.h"
+#include "common/placement.h"
 #include "common/uri.h"
 
 #include <nlohmann/json.hpp>
@@ -18,6 +19,7 @@ namespace server {
     namespace fs = boost::filesystem;
     using boost::dll::program_location;
     using common::Uri;
+    using common::Placement;
     using nlohmann::json;
 
     class Options final : common::Options {
@@ -27,26 +29,62 @@ namespace server {
                 const Uri bind{"127.0.0.1", 8847};
                 const Uri upstream{"127.0.0.1", 18081};
                 const Uri frontend{"127.0.0.1", 8080};
+                const unsigned int hedge = 250;
                 const unsigned int threads = thread::hardware_concurrency();
             } network;
+
+            const struct {
+                const size_t cache = 65536;
+            } security;
+
+            const struct {
+                const unsigned int reload = 5;
+            } assets;
         } defaults;
 
         struct {
             Uri advertise;
             Uri bind;
             vector<Uri> joins;
-            Uri upstream;
+            vector<Uri> upstreams;
+            Uri notify;
             Uri frontend;
 
+            unsigned int hedge;
             unsigned int threads;
         } network;
 
+        struct {
+            string key;
+            size_t cache;
+        } security;
+
+        struct {
+            string path;
+            unsigned int reload;
+        } assets;
+
         struct {
             int c = 30;
             int H = c / 2;
             int S = 0;
+            // Peers gossiped with at once in every round.
+            int k = 2;
+            // File the view is kept in to rejoin from after a restart.
+            string snapshot;
+            // Either random or nearest, see View::Policy.
+            string selection = "random";
+            double nearby = 0.75;
         } peers;
 
+        // CPUs the threads of each subsystem are kept on, anywhere when
+        // left empty.
+        struct {
+            Placement peering;
+            Placement upstream;
+            Placement frontend;
+        } cpus;
+
     public:
         bool parse(int argc, const char **argv) override;
 
@@ -57,11 +95,21 @@ namespace server {
 
         void on_joins(vector<string> uris);
 
-        void on_upstream(string uri);
+        void on_upstreams(vector<string> uris);
+
+        void on_notify(string uri);
 
         void on_frontend(string uri);
 
         void on_threads(int threads);
+
+        void on_assets(string path);
+
+        void on_selection(string policy);
+
+        void on_nearby(double share);
+
+        void on_cpus(const string &option, Placement &cpus, string list);
     };
 }
 
@@ -3,21 +3,55 @@
 
 server::Peering::Peering(Server &server) :
     _server(server),
-    _view(make_shared<View>()),
-    _timer(_ioc, steady_time_point::max()) {
+    _view(make_shared<View>(
+        chrono::seconds(30),
+        server.cfg().peers.selection == "nearest"
+            ? View::Policy::nearest
+            : View::Policy::random,
+        server.cfg().peers.nearby
+    )),
+    _timer(_ioc, steady_time_point::max()),
+    _refresh(_ioc, steady_time_point::max()),
+    _directory(make_shared<Directory>(
+        server.cfg().network.advertise.netloc()
+    )) {
     auto cfg = _server.cfg();
+    join();
+    restore();
 
-    deque<Peer> buffer;
-    for (auto &join : cfg.network.joins) {
-        buffer.emplace_back(Peer(join.netloc(), 0));
-    }
-    _view->update(cfg.peers.c, cfg.peers.H, cfg.peers.S, buffer);
+    _distributor = make_shared<Distributor>(
+        _ioc,
+        cfg.network.advertise.netloc(),
+        [this] {
+            vector<string> targets;
+            for (const auto &each : _view->snapshot()) {
+                targets.emplace_back(each.addr());
+            }
+            return targets;
+        },
+        [this](shared_ptr<const Template> block) {
+            _server.upstream()->offer(block);
+        }
+    );
+
+    // Announces complete here, the io thread only hands them off.
+    _drainer = thread([this] {
+        Placement::name("peering-owners");
+        rpc::drain(_queue);
+    });
+}
+
+server::Peering::~Peering() {
+    _queue.Shutdown();
+    _drainer.join();
 }
 
 void server::Peering::start() {
     grpc::ServerBuilder builder;
     rpc::services::PeersService peers(_server);
     rpc::services::MinersService miners(_server);
+    rpc::services::TemplatesService templates(_distributor);
+    rpc::services::TraceService trace;
 
     builder.AddListeningPort(
         _server.cfg().network.bind.netloc(),
@@ -26,51 +60,325 @@ void server::Peering::start() {
 
     builder.RegisterService(&peers);
     builder.RegisterService(&miners);
+    builder.RegisterService(&templates);
+    builder.RegisterService(&trace);
     _rpc = builder.BuildAndStart();
 
+    _server.upstream()->subscribe(
+        bind(&Peering::on_template, shared_from_this(), _1)
+    );
+
     on_pulse({});
+    _refresh.expires_after(chrono::seconds(refresh));
+    _refresh.async_wait(bind(&Peering::on_refresh, shared_from_this(), _1));
 
-    _handlers.emplace_back([&] { _rpc->Wait(); });
-    _handlers.emplace_back([&] { _ioc.run(); });
+    _handlers.emplace_back([&] {
+        Placement::name("peering-rpc");
+        _rpc->Wait();
+    });
+    _handlers.emplace_back([&] {
+        Placement::name("peering-io");
+        _ioc.run();
+    });
     server::exit.peering.get_future().wait();
-    _rpc->Shutdown();
+
+    // Shutdown waits for every running call. Watch streams end once their
+    // watch is closed, and whatever still runs past the deadline is
+    // cancelled rather than holding the node up.
+    _server.frontend()->miners.close();
+    _rpc->Shutdown(
+        chrono::system_clock::now() + chrono::milliseconds(shutdown)
+    );
     _ioc.stop();
     for_each(_handlers.begin(), _handlers.end(), [](thread &t) { t.join(); });
+    save();
 }
 
 shared_ptr<View> server::Peering::view() {
     return _view;
 }
 
+bool server::Peering::leading() {
+    // The node with the lowest address it knows of fetches templates for
+    // the others. Views are partial, so a node with a lower address that
+    // is not in the view may be leading too. Its heartbeats reach every
+    // node, and hearing them is enough to step down, which leaves a single
+    // leader within a beat.
+    auto self = _server.cfg().network.advertise.netloc();
+    for (const auto &each : _view->snapshot()) {
+        if (each.addr() < self) return false;
+    }
+    return !_distributor->outranked();
+}
+
+bool server::Peering::fed() {
+    return _distributor->fed();
+}
+
+shared_ptr<server::Directory> server::Peering::directory() {
+    return _directory;
+}
+
+void server::Peering::announce(const string &id, bool connected) {
+    // A miner that reconnects before the pulse only leaves its last state.
+    lock_guard<mutex> lock(_mutex);
+    _changes[id] = connected;
+}
+
+string server::Peering::locate(const string &id) {
+    // The first owner is asked first, the second one only covers for
+    // membership that has not converged yet or an owner that went away.
+    auto self = _server.cfg().network.advertise.netloc();
+    for (const auto &owner : _directory->owners(id)) {
+        if (owner == self) {
+            auto node = _directory->locate(id);
+            if (!node.empty()) return node;
+            continue;
+        }
+
+        rpc::callers::MinersCaller caller(
+            grpc::CreateCustomChannel(
+                owner,
+                grpc::InsecureChannelCredentials(),
+                grpc::ChannelArguments()
+            )
+        );
+        auto[status, node] = caller.locate(id, chrono::milliseconds(deadline));
+        if (status.ok() && !node.value().empty()) return node.value();
+    }
+    return string();
+}
+
+void server::Peering::flush() {
+    unordered_map<string, bool> changes;
+    {
+        lock_guard<mutex> lock(_mutex);
+        changes.swap(_changes);
+    }
+    if (changes.empty()) return;
+
+    vector<string> connected, disconnected;
+    for (const auto &[id, state] : changes) {
+        (state ? connected : disconnected).emplace_back(id);
+    }
+    publish(connected, disconnected);
+}
+
+set<string> server::Peering::publish(
+    const vector<string> &connected,
+    const vector<string> &disconnected
+) {
+    auto self = _server.cfg().network.advertise.netloc();
+    map<string, pair<vector<string>, vector<string>>> grouped;
+    for (const auto &id : connected) {
+        for (const auto &owner : _directory->owners(id)) {
+            grouped[owner].first.emplace_back(id);
+        }
+    }
+    for (const auto &id : disconnected) {
+        for (const auto &owner : _directory->owners(id)) {
+            grouped[owner].second.emplace_back(id);
+        }
+    }
+
+    set<string> owners;
+    for (const auto &[owner, batch] : grouped) {
+        owners.emplace(owner);
+        if (owner == self) {
+            for (const auto &id : batch.first) _directory->record(id, self);
+            for (const auto &id : batch.second) _directory->erase(id, self);
+            continue;
+        }
+
+        rpc::callers::MinersCaller caller(channel(owner));
+        caller.announce(
+            self,
+            batch.first,
+            batch.second,
+            chrono::milliseconds(deadline),
+            _queue,
+            [owner](const grpc::Status &status) {
+                if (status.ok()) return;
+                json extra = {{"peer", owner}, {"call", "miners/announce"}};
+                LOG(debug) << logging::add_value("Extra", move(extra))
+                           << status.error_message();
+            }
+        );
+    }
+    return owners;
+}
+
+shared_ptr<grpc::Channel> server::Peering::channel(const string &addr) {
+    auto search = _channels.find(addr);
+    if (search != _channels.end()) return search->second;
+    auto created = grpc::CreateCustomChannel(
+        addr,
+        grpc::InsecureChannelCredentials(),
+        grpc::ChannelArguments()
+    );
+    _channels.emplace(addr, created);
+    return created;
+}
+
+void server::Peering::join() {
+    auto cfg = _server.cfg();
+    deque<Peer> buffer;
+    for (auto &join : cfg.network.joins) {
+        buffer.emplace_back(Peer(join.netloc(), 0));
+        _view->add_probe(join.netloc());
+    }
+    _view->update(cfg.peers.c, cfg.peers.H, cfg.peers.S, buffer);
+}
+
+void server::Peering::restore() {
+    auto cfg = _server.cfg();
+    if (cfg.peers.snapshot.empty()) return;
+
+    // Whoever was known before the restart is gossiped with right away
+    // next to the joins, instead of waiting for them to pass peers on.
+    try {
+        auto count = _view->restore(
+            cfg.peers.c,
+            cfg.peers.H,
+            cfg.peers.S,
+            cfg.peers.snapshot
+        );
+        json extra = {{"path", cfg.peers.snapshot}, {"peers", count}};
+        LOG(info) << logging::add_value("Extra", move(extra))
+                  << "view snapshot restored.";
+    } catch (const exception &e) {
+        json extra = {{"path", cfg.peers.snapshot}, {"error", e.what()}};
+        LOG(warning) << logging::add_value("Extra", move(extra))
+                     << "view snapshot ignored.";
+    }
+}
+
+void server::Peering::save() {
+    auto cfg = _server.cfg();
+    if (cfg.peers.snapshot.empty()) return;
+
+    try {
+        _view->save(cfg.peers.snapshot);
+    } catch (const exception &e) {
+        json extra = {{"path", cfg.peers.snapshot}, {"error", e.what()}};
+        LOG(error) << logging::add_value("Extra", move(extra))
+                   << "view snapshot failed.";
+    }
+}
+
 void server::Peering::on_pulse(error_code code) {
     auto cfg = _server.cfg();
+    flush();
     if (_view->empty()) {
+        // Everyone known was suspected, the joins are tried again once
+        // their quarantine is over.
+        join();
         _timer.expires_after(chrono::seconds(1));
         _timer.async_wait(bind(&Peering::on_pulse, shared_from_this(), _1));
         return;
     }
 
+    auto self = cfg.network.advertise.netloc();
     deque<Peer> push = _view->select(cfg.peers.c / 2 - 1, cfg.peers.H);
-    push.emplace(push.begin(), Peer(cfg.network.advertise.netloc(), 0));
-
-    auto peer = _view->random_peer();
-    rpc::callers::PeersCaller caller(
-        grpc::CreateCustomChannel(
-            peer.addr(),
-            grpc::InsecureChannelCredentials(),
-            grpc::ChannelArguments()
-        )
-    );
+    push.emplace(push.begin(), Peer(self, 0));
 
-    auto[status, pull] = caller.gossip(push, cfg.network.advertise.netloc());
-    _view->update(cfg.peers.c, cfg.peers.H, cfg.peers.S, pull.value());
+    // Now and then one more exchange goes to a peer that failed before or
+    // to a join. After a partition every link across it may have aged out
+    // or been suspected away, and only such a probe finds out that it
+    // healed.
+    auto targets = _view->random_peers(cfg.peers.k);
+    if (++_pulses % probing == 0) {
+        auto addr = _view->next_probe();
+        if (!addr.empty()) targets.emplace_back(addr, 0);
+    }
 
-    if (!status.ok()) {
-        json extra = {{"peer", peer.addr()}};
-        LOG(error) << logging::add_value("Extra", extra.dump())
-                   << status.error_message();
+    // All exchanges run at once, a dead peer then costs the round one
+    // deadline rather than adding to the others. What each brings back is
+    // still its own update, healing and swapping run once per exchange.
+    vector<future<Exchange>> exchanges;
+    for (const auto &peer : targets) {
+        exchanges.emplace_back(async(launch::async, [&push, &self, peer] {
+            rpc::callers::PeersCaller caller(
+                grpc::CreateCustomChannel(
+                    peer.addr(),
+                    grpc::InsecureChannelCredentials(),
+                    grpc::ChannelArguments()
+                )
+            );
+
+            auto started = chrono::steady_clock::now();
+            auto[status, pull] = caller.gossip(
+                push,
+                self,
+                chrono::milliseconds(deadline)
+            );
+            return Exchange{
+                peer.addr(),
+                status,
+                pull.value_or(deque<Peer>()),
+                chrono::steady_clock::now() - started
+            };
+        }));
+    }
+
+    vector<string> seen;
+    for (auto &each : exchanges) {
+        auto exchange = each.get();
+        auto ok = exchange.status.ok();
+        metrics::gossip_latency.with().observe(exchange.elapsed);
+        metrics::gossip.with({ok ? "ok" : "error"}).add();
+        if (ok) {
+            _view->succeeded(exchange.peer, exchange.elapsed);
+        } else {
+            json extra = {{"peer", exchange.peer}};
+            LOG(error) << logging::add_value("Extra", move(extra))
+                       << exchange.status.error_message();
+        }
+        if (!ok && _view->failed(exchange.peer)) {
+            metrics::suspicions.with().add();
+            json extra = {{"peer", exchange.peer}};
+            LOG(warning) << logging::add_value("Extra", move(extra))
+                         << "peer suspected and dropped from view.";
+        }
+        for (const auto &peer : exchange.pull) seen.emplace_back(peer.addr());
+        _view->update(cfg.peers.c, cfg.peers.H, cfg.peers.S, exchange.pull);
     }
+    for (const auto &each : _view->snapshot()) seen.emplace_back(each.addr());
+    _directory->observe(seen);
+
+    if (leading()) _distributor->heartbeat();
 
     _timer.expires_after(chrono::seconds(1));
     _timer.async_wait(bind(&Peering::on_pulse, shared_from_this(), _1));
+}
+
+void server::Peering::on_template(shared_ptr<const Template> block) {
+    if (leading()) _distributor->originate(block);
+}
+
+void server::Peering::on_refresh(error_code code) {
+    if (code == boost::asio::error::operation_aborted) return;
+
+    // Entries live on other nodes only as long as they are refreshed, this
+    // also carries them over to their new owners after membership changes.
+    _directory->expire();
+    vector<string> ids;
+    for (const auto &miner : _server.frontend()->miners.list()) {
+        ids.emplace_back(miner->id());
+    }
+    auto owners = publish(ids, vector<string>());
+    save();
+
+    // Every miner was just announced, owners none of them maps to any
+    // more are not needed until membership changes again.
+    for (auto it = _channels.begin(); it != _channels.end();) {
+        if (owners.count(it->first) == 0) {
+            it = _channels.erase(it);
+        } else {
+            it++;
+        }
+    }
+
+    _refresh.expires_after(chrono::seconds(refresh));
+    _refresh.async_wait(bind(&Peering::on_refresh, shared_from_this(), _1));
 }
\ No newline at end of file
@@ -2,16 +2,29 @@
 #define SYNCAIDE_SERVER_PEERING_H
 
 #include "rpc/callers/peers.h"
+#include "rpc/callers/miners.h"
 #include "rpc/services/peers.h"
 #include "rpc/services/miners.h"
+#include "rpc/services/templates.h"
+#include "rpc/services/trace.h"
+#include "server/distributor.h"
+#include "server/directory.h"
 #include "server/helper.h"
+#include "server/metrics.h"
 #include "server/server.h"
 #include "view.h"
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/steady_timer.hpp>
+#include <boost/asio/post.hpp>
 #include <grpc++/grpc++.h>
+#include <unordered_map>
 #include <functional>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <map>
+#include <set>
 
 using namespace std;
 using namespace placeholders;
@@ -23,23 +36,84 @@ namespace server {
     class Server;
 
     class Peering : public enable_shared_from_this<Peering> {
+        enum {
+            refresh = 10,
+            deadline = 500,
+            // Pulses between probes of a peer that failed or a join.
+            probing = 5,
+            shutdown = 2000
+        };
+
+        struct Exchange {
+            string peer;
+            grpc::Status status;
+            deque<Peer> pull;
+            chrono::steady_clock::duration elapsed;
+        };
+
     private:
         io_context _ioc;
         Server &_server;
         steady_timer _timer;
+        steady_timer _refresh;
         shared_ptr<View> _view;
         vector<thread> _handlers;
         unique_ptr<grpc::Server> _rpc;
+        shared_ptr<Distributor> _distributor;
+        shared_ptr<Directory> _directory;
+        unsigned int _pulses = 0;
+        mutex _mutex;
+        unordered_map<string, bool> _changes;
+        unordered_map<string, shared_ptr<grpc::Channel>> _channels;
+        grpc::CompletionQueue _queue;
+        thread _drainer;
 
     public:
         explicit Peering(Server &server);
 
+        ~Peering();
+
         void start();
 
         shared_ptr<View> view();
 
+        bool leading();
+
+        // Whether another node's heartbeats are still coming in.
+        bool fed();
+
+        shared_ptr<Directory> directory();
+
+        // Queues the change, it goes out with the next pulse together with
+        // whatever else changed in the meantime.
+        void announce(const string &id, bool connected);
+
+        string locate(const string &id);
+
     private:
+        void join();
+
+        // Both only act when a view snapshot is configured and log rather
+        // than throw, a node runs fine without one.
+        void restore();
+
+        void save();
+
+        void flush();
+
+        // Sends each owner a single announce and returns the owners.
+        set<string> publish(
+            const vector<string> &connected,
+            const vector<string> &disconnected
+        );
+
+        shared_ptr<grpc::Channel> channel(const string &addr);
+
         void on_pulse(error_code code);
+
+        void on_refresh(error_code code);
+
+        void on_template(shared_ptr<const Template> block);
     };
 }
 
@@ -40,12 +40,14 @@ namespace server {
 
     class Rule {
     private:
+        string _route;
         regex _regex;
         function<int(std::smatch &match, void *server, void *req)> _fn;
 
     public:
         template<typename Fn, typename Tuple>
-        Rule(Fn &&fn, const string &pattern, Tuple) :
+        Rule(Fn &&fn, const string &route, const string &pattern, Tuple) :
+            _route(route),
             _regex(pattern),
             _fn([&fn](smatch &match, void *server, void *req) {
                 Tuple params;
@@ -66,6 +68,10 @@ namespace server {
             }
             return 0;
         }
+
+        const string &route() const {
+            return _route;
+        }
     };
 
     class Router {
@@ -77,6 +83,7 @@ namespace server {
         void add(Fn &&fn, const string &pattern, Args ... args) {
             _rules.emplace_back(
                 forward<Fn>(fn),
+                pattern,
                 fmt::format(pattern, args.pattern...),
                 tuple_cat(args.type...)
             );
@@ -84,6 +91,16 @@ namespace server {
 
         template<typename Server, typename Request>
         int dispatch(Server &server, Request &req) const {
+            size_t rule;
+            return dispatch(server, req, rule);
+        }
+
+        // Same as above and also reports the index of the rule that
+        // handled the request, size() when none did. route() turns it into
+        // the pattern given to add(), which keeps the set of routes bounded
+        // for anyone labelling by it.
+        template<typename Server, typename Request>
+        int dispatch(Server &server, Request &req, size_t &rule) const {
             vector<int> resps;
             for_each(_rules.begin(), _rules.end(),
                 [&resps, &server, &req](const Rule &rule) {
@@ -96,10 +113,20 @@ namespace server {
             );
 
             if (it != resps.end()) {
+                rule = (size_t) (it - resps.begin());
                 return *it;
             }
+            rule = _rules.size();
             return 404;
         }
+
+        size_t size() const {
+            return _rules.size();
+        }
+
+        const string &route(size_t rule) const {
+            return _rules.at(rule).route();
+        }
     };
 
 }
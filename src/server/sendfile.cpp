@@ -0,0 +1,68 @@
+#include "server/sendfile.h"
+
+#include <boost/asio/error.hpp>
+#include <sys/sendfile.h>
+#include <algorithm>
+#include <cerrno>
+
+server::Sendfile::Sendfile(
+    tcp::socket &socket,
+    strand<io_context::executor_type> &strand,
+    int fd,
+    int64_t offset,
+    uint64_t count,
+    handler_type handler
+) : _socket(socket),
+    _strand(strand),
+    _fd(fd),
+    _offset(offset),
+    _remaining(count),
+    _handler(move(handler)) {}
+
+void server::Sendfile::run() {
+    on_wait(error_code());
+}
+
+void server::Sendfile::on_wait(error_code code) {
+    if (code) return _handler(code);
+
+    // Asio only puts the descriptor into non-blocking mode for its own
+    // operations, sendfile needs it to be so as well.
+    if (!_socket.native_non_blocking()) {
+        _socket.native_non_blocking(true, code);
+        if (code) return _handler(code);
+    }
+
+    while (_remaining > 0) {
+        off_t offset = _offset;
+        auto count = (size_t) min<uint64_t>(_remaining, chunk);
+        auto sent = ::sendfile(_socket.native_handle(), _fd, &offset, count);
+        if (sent > 0) {
+            _offset = offset;
+            _remaining -= sent;
+            continue;
+        }
+
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            _socket.async_wait(
+                tcp::socket::wait_write,
+                bind_executor(
+                    _strand,
+                    bind(
+                        &Sendfile::on_wait,
+                        shared_from_this(),
+                        placeholders::_1
+                    )
+                )
+            );
+            return;
+        }
+
+        // Nothing sent without an error means the file got shorter than
+        // what was announced in the header.
+        if (sent == 0) return _handler(boost::asio::error::eof);
+        return _handler(error_code(errno, boost::system::system_category()));
+    }
+    _handler(error_code());
+}
@@ -0,0 +1,59 @@
+#ifndef SYNCAIDE_SERVER_SENDFILE_H
+#define SYNCAIDE_SERVER_SENDFILE_H
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/system/error_code.hpp>
+#include <functional>
+#include <cstdint>
+#include <memory>
+
+using namespace std;
+
+namespace server {
+    using boost::asio::ip::tcp;
+    using boost::asio::strand;
+    using boost::asio::bind_executor;
+    using boost::asio::io_context;
+    using boost::system::error_code;
+
+    // Copies part of a file to a plain socket with sendfile(2), so the
+    // bytes go from the page cache to the socket without passing through
+    // user space. Whenever the socket buffer is full it waits for the
+    // socket to drain on the strand, and the handler runs there once.
+    class Sendfile : public enable_shared_from_this<Sendfile> {
+        enum {
+            chunk = 1 << 20
+        };
+
+    public:
+        using handler_type = function<void(error_code)>;
+
+    private:
+        tcp::socket &_socket;
+        strand<io_context::executor_type> &_strand;
+        int _fd;
+        int64_t _offset;
+        uint64_t _remaining;
+        handler_type _handler;
+
+    public:
+        Sendfile(
+            tcp::socket &socket,
+            strand<io_context::executor_type> &strand,
+            int fd,
+            int64_t offset,
+            uint64_t count,
+            handler_type handler
+        );
+
+        void run();
+
+    private:
+        void on_wait(error_code code);
+    };
+}
+
+#endif //SYNCAIDE_SERVER_SENDFILE_H
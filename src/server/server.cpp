@@ -14,9 +14,18 @@ server::Options &server::Server::cfg() {
 }
 
 int server::Server::start() {
-    _handlers.emplace_back(thread([=] { _peering->start(); }));
-    _handlers.emplace_back(thread([=] { _upstream->start(); }));
-    _handlers.emplace_back(thread([=] { _frontend->start(); }));
+    _handlers.emplace_back(thread([=] {
+        place("peering", _cfg.cpus.peering);
+        _peering->start();
+    }));
+    _handlers.emplace_back(thread([=] {
+        place("upstream", _cfg.cpus.upstream);
+        _upstream->start();
+    }));
+    _handlers.emplace_back(thread([=] {
+        place("frontend", _cfg.cpus.frontend);
+        _frontend->start();
+    }));
 
     for (auto &thread : _handlers) {
         thread.join();
@@ -36,3 +45,19 @@ shared_ptr<server::Upstream> server::Server::upstream() {
 shared_ptr<server::Frontend> server::Server::frontend() {
     return _frontend;
 }
+
+void server::Server::place(const string &name, const Placement &cpus) {
+    Placement::name(name);
+    if (cpus.empty()) return;
+
+    try {
+        cpus.apply();
+        json extra = {{"thread", name}, {"cpus", cpus.str()}};
+        LOG(info) << logging::add_value("Extra", move(extra))
+                  << "thread placed.";
+    } catch (const exception &e) {
+        json extra = {{"thread", name}, {"error", e.what()}};
+        LOG(warning) << logging::add_value("Extra", move(extra))
+                     << "thread left unplaced.";
+    }
+}
@@ -43,6 +43,11 @@ namespace server {
         shared_ptr<Frontend> frontend();
 
         int start();
+
+    private:
+        // Names the calling thread and keeps it, along with every thread it
+        // goes on to start, on the given CPUs.
+        void place(const string &name, const Placement &cpus);
     };
 }
 
@@ -0,0 +1,130 @@
+#include "logging.h"
+#include "server/signer.h"
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <system_error>
+
+server::Signer::Signer(const string &keyfile, size_t cache) :
+    _verified(cache) {
+    if (!keyfile.empty() && fs::exists(keyfile)) load(keyfile);
+    else generate(keyfile);
+
+    // Every signature and verification multiplies the base point and every
+    // verification also multiplies the public point, so the tables for both
+    // are built once here instead of on each login.
+    _signer.AccessKey().MakePublicKey(_verifier.AccessKey());
+    _signer.AccessKey().AccessGroupParameters().Precompute();
+    _verifier.AccessKey().AccessGroupParameters().Precompute();
+    _verifier.AccessKey().Precompute();
+}
+
+string server::Signer::digest(const string &data) const {
+    string digest;
+    CryptoPP::SHA256 sha256sum;
+    CryptoPP::StringSource(
+        data, true,
+        new CryptoPP::HashFilter(
+            sha256sum,
+            new CryptoPP::HexEncoder(
+                new CryptoPP::StringSink(digest)
+            )
+        )
+    );
+    to_lower(digest);
+    return digest;
+}
+
+string server::Signer::sign(const string &data) const {
+    thread_local CryptoPP::AutoSeededRandomPool prng;
+
+    string signature;
+    CryptoPP::StringSource(
+        digest(data), true,
+        new CryptoPP::SignerFilter(
+            prng,
+            _signer,
+            new CryptoPP::HexEncoder(
+                new CryptoPP::StringSink(signature)
+            )
+        )
+    );
+    to_lower(signature);
+    return signature;
+}
+
+bool server::Signer::verify(const string &data, const string &signature) {
+    string digest = this->digest(data);
+    {
+        lock_guard<mutex> lock(_mutex);
+        auto cached = _verified.get(digest);
+        if (cached && cached.value() == signature) return true;
+    }
+
+    string raw;
+    CryptoPP::StringSource(
+        signature, true,
+        new CryptoPP::HexDecoder(
+            new CryptoPP::StringSink(raw)
+        )
+    );
+    if (raw.size() != _verifier.SignatureLength()) return false;
+
+    bool valid = _verifier.VerifyMessage(
+        (const CryptoPP::byte *) digest.data(), digest.size(),
+        (const CryptoPP::byte *) raw.data(), raw.size()
+    );
+
+    if (valid) {
+        lock_guard<mutex> lock(_mutex);
+        _verified.put(digest, signature);
+    }
+    return valid;
+}
+
+void server::Signer::load(const fs::path &keyfile) {
+    CryptoPP::FileSource source(keyfile.string().c_str(), true);
+    _signer.AccessKey().Load(source);
+
+    CryptoPP::AutoSeededRandomPool prng;
+    if (!_signer.GetKey().Validate(prng, 3)) {
+        throw invalid_argument("Failure validating signing key.");
+    }
+}
+
+void server::Signer::generate(const fs::path &keyfile) {
+    CryptoPP::AutoSeededRandomPool prng;
+    _signer.AccessKey().Initialize(prng, CryptoPP::ASN1::secp256r1());
+    if (keyfile.empty()) {
+        LOG(warning) << "signing with an ephemeral key; miners must "
+                        "refetch their parameters after a restart.";
+        return;
+    }
+
+    string encoded;
+    CryptoPP::StringSink sink(encoded);
+    _signer.GetKey().Save(sink);
+
+    // Only the node's own user may read the key. The file is created with
+    // that mode rather than fixed up afterwards, and an existing one is
+    // never written over.
+    auto path = keyfile.string();
+    auto flags = O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC;
+    int fd = ::open(path.c_str(), flags, 0600);
+    if (fd < 0) throw system_error(errno, generic_category(), path);
+
+    size_t done = 0;
+    while (done < encoded.size()) {
+        auto count = ::write(fd, encoded.data() + done, encoded.size() - done);
+        if (count < 0 && errno == EINTR) continue;
+        if (count < 0) {
+            auto error = errno;
+            ::close(fd);
+            ::unlink(path.c_str());
+            throw system_error(error, generic_category(), path);
+        }
+        done += (size_t) count;
+    }
+    ::close(fd);
+}
@@ -0,0 +1,48 @@
+#ifndef SYNCAIDE_SERVER_SIGNER_H
+#define SYNCAIDE_SERVER_SIGNER_H
+
+#include "common/lru.h"
+
+#include <cryptopp/eccrypto.h>
+#include <cryptopp/oids.h>
+#include <cryptopp/osrng.h>
+#include <cryptopp/sha.h>
+#include <cryptopp/hex.h>
+#include <cryptopp/files.h>
+#include <cryptopp/filters.h>
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <mutex>
+#include <string>
+
+using namespace std;
+
+namespace server {
+    namespace fs = boost::filesystem;
+    using boost::algorithm::to_lower;
+    using ecdsa = CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP::SHA256>;
+
+    class Signer {
+    private:
+        ecdsa::Signer _signer;
+        ecdsa::Verifier _verifier;
+        mutex _mutex;
+        common::Lru<string, string> _verified;
+
+    public:
+        Signer(const string &keyfile, size_t cache);
+
+        string digest(const string &data) const;
+
+        string sign(const string &data) const;
+
+        bool verify(const string &data, const string &signature);
+
+    private:
+        void load(const fs::path &keyfile);
+
+        void generate(const fs::path &keyfile);
+    };
+}
+
+#endif //SYNCAIDE_SERVER_SIGNER_H
@@ -0,0 +1,382 @@
+#include "server/template.h"
+
+#include <cerrno>
+
+namespace {
+    class Cursor {
+    private:
+        const string &_data;
+        size_t _pos;
+
+    public:
+        explicit Cursor(const string &data) : _data(data), _pos(0) {}
+
+        uint64_t varint() {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                auto byte = (uint8_t) take(1)[0];
+                value |= (uint64_t) (byte & 0x7f) << shift;
+                if (!(byte & 0x80)) return value;
+            }
+            throw invalid_argument("Failure parsing block template.");
+        }
+
+        uint8_t byte() {
+            return (uint8_t) take(1)[0];
+        }
+
+        const char *take(size_t size) {
+            if (size > _data.size() - _pos) {
+                throw invalid_argument("Failure parsing block template.");
+            }
+            auto data = _data.data() + _pos;
+            _pos += size;
+            return data;
+        }
+
+        void skip(size_t size) {
+            take(size);
+        }
+    };
+
+    int nibble_of(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    server::Template::hash_type to_hash(const string &bytes) {
+        server::Template::hash_type hash{};
+        if (bytes.size() != hash.size()) {
+            throw invalid_argument("Failure parsing block template.");
+        }
+        copy(bytes.begin(), bytes.end(), hash.begin());
+        return hash;
+    }
+}
+
+server::Template::Template(const json &result) {
+    try {
+        _height = result.at("height").get<uint64_t>();
+        _difficulty = result.at("difficulty").get<uint64_t>();
+        _reward = result.value("expected_reward", (uint64_t) 0);
+        _reserved_offset = result.at("reserved_offset").get<size_t>();
+        _prev_hash = to_hash(unhex(result.at("prev_hash").get<string>()));
+        _seed_hash = to_hash(unhex(result.value("seed_hash", string(64, '0'))));
+        _blob = unhex(result.at("blocktemplate_blob").get<string>());
+    } catch (const json::exception &e) {
+        throw invalid_argument("Failure parsing block template.");
+    }
+    decode();
+}
+
+server::Template::Template(
+    uint64_t height,
+    uint64_t difficulty,
+    uint64_t reward,
+    size_t reserved_offset,
+    const string &prev_hash,
+    const string &seed_hash,
+    string blob
+) : _height(height),
+    _difficulty(difficulty),
+    _reward(reward),
+    _reserved_offset(reserved_offset),
+    _prev_hash(to_hash(prev_hash)),
+    _seed_hash(to_hash(seed_hash)),
+    _blob(move(blob)) {
+    decode();
+}
+
+uint64_t server::Template::height() const {
+    return _height;
+}
+
+uint64_t server::Template::difficulty() const {
+    return _difficulty;
+}
+
+uint64_t server::Template::reward() const {
+    return _reward;
+}
+
+size_t server::Template::reserved_offset() const {
+    return _reserved_offset;
+}
+
+const server::Template::hash_type &server::Template::prev_hash() const {
+    return _prev_hash;
+}
+
+const server::Template::hash_type &server::Template::seed_hash() const {
+    return _seed_hash;
+}
+
+const string &server::Template::blob() const {
+    return _blob;
+}
+
+const vector<server::Template::hash_type> &server::Template::txs() const {
+    return _txs;
+}
+
+bool server::Template::same(const Template &other) const {
+    return _height == other._height
+           && _prev_hash == other._prev_hash
+           && _txs == other._txs;
+}
+
+string server::Template::hex(const hash_type &hash) {
+    static const char digits[] = "0123456789abcdef";
+    string text;
+    text.reserve(hash.size() * 2);
+    for (auto byte : hash) {
+        text += digits[byte >> 4];
+        text += digits[byte & 0x0f];
+    }
+    return text;
+}
+
+string server::Template::unhex(const string &text) {
+    auto nibble = [](char c) -> int {
+        int digit = nibble_of(c);
+        if (digit < 0) {
+            throw invalid_argument("Failure parsing block template.");
+        }
+        return digit;
+    };
+
+    if (text.size() % 2) {
+        throw invalid_argument("Failure parsing block template.");
+    }
+
+    string bytes(text.size() / 2, '\0');
+    for (size_t i = 0; i < bytes.size(); i++) {
+        bytes[i] = (char) (nibble(text[2 * i]) << 4 | nibble(text[2 * i + 1]));
+    }
+    return bytes;
+}
+
+void server::Template::decode() {
+    Cursor reader(_blob);
+
+    // Block header: version, timestamp, previous block and nonce.
+    reader.varint();
+    reader.varint();
+    reader.varint();
+    reader.skip(32);
+    reader.skip(4);
+
+    // Coinbase transaction prefix, its inputs only ever being generators.
+    auto version = reader.varint();
+    reader.varint();
+    for (auto inputs = reader.varint(); inputs > 0; inputs--) {
+        if (reader.byte() != 0xff) {
+            throw invalid_argument("Failure parsing block template.");
+        }
+        reader.varint();
+    }
+    for (auto outputs = reader.varint(); outputs > 0; outputs--) {
+        reader.varint();
+        switch (reader.byte()) {
+            case 0x02:
+                reader.skip(32);
+                break;
+            case 0x03:
+                reader.skip(33);
+                break;
+            default:
+                throw invalid_argument("Failure parsing block template.");
+        }
+    }
+    reader.skip(reader.varint());
+    if (version >= 2) reader.byte();
+
+    auto count = reader.varint();
+    if (count > _blob.size() / 32) {
+        throw invalid_argument("Failure parsing block template.");
+    }
+    _txs.reserve(count);
+    for (; count > 0; count--) {
+        hash_type hash{};
+        auto data = reader.take(hash.size());
+        copy(data, data + hash.size(), hash.begin());
+        _txs.emplace_back(hash);
+    }
+}
+
+server::Template::Reader::Reader() {
+    clear();
+}
+
+void server::Template::Reader::clear() {
+    _template.reset(new Template());
+    _depth = 0;
+    _complete = false;
+    _section.clear();
+    _key.clear();
+    _hex.clear();
+    _nibble = -1;
+    _invalid = false;
+    _fields = 0;
+    _digest = 0xcbf29ce484222325;
+    _error.clear();
+}
+
+void server::Template::Reader::complete(bool valid) {
+    if (!_error.empty()) {
+        _template.reset();
+        return;
+    }
+
+    unsigned int required = height | difficulty | reserved_offset | prev_hash | blob;
+    if (!valid || !_complete || _invalid || (_fields & required) != required) {
+        _error = "Failure parsing block template.";
+        _template.reset();
+        return;
+    }
+
+    try {
+        _template->decode();
+    } catch (const invalid_argument &e) {
+        _error = e.what();
+        _template.reset();
+    }
+}
+
+shared_ptr<const server::Template> server::Template::Reader::result() const {
+    return _template;
+}
+
+const string &server::Template::Reader::error() const {
+    return _error;
+}
+
+uint64_t server::Template::Reader::digest() const {
+    return _digest;
+}
+
+void server::Template::Reader::on_begin(bool array) {
+    fold(array ? "[" : "{", 1);
+    _depth++;
+}
+
+void server::Template::Reader::on_end(bool array) {
+    fold(array ? "]" : "}", 1);
+    if (--_depth == 0) _complete = true;
+}
+
+void server::Template::Reader::on_key(const string &key) {
+    fold(key.data(), key.size());
+    fold(":", 1);
+    if (_depth == 1) _section = key;
+    if (_depth == 2) {
+        // Hex fields are decoded by the same nibble state, nothing of one
+        // may spill into the next.
+        _key = key;
+        _hex.clear();
+        _nibble = -1;
+    }
+}
+
+void server::Template::Reader::on_string(
+    const char *data,
+    size_t size,
+    bool last
+) {
+    fold(data, size);
+    if (last) fold("\"", 1);
+    if (_depth != 2) return;
+
+    if (_section == "error") {
+        if (_key == "message") _error.append(data, size);
+        if (last && _error.empty()) _error = "Failure parsing block template.";
+        return;
+    }
+    if (_section != "result") return;
+
+    if (_key == "blocktemplate_blob") {
+        unhex(data, size, _template->_blob);
+        if (!last) return;
+        if (_nibble >= 0) {
+            _invalid = true;
+            return;
+        }
+        _fields |= blob;
+    } else if (_key == "prev_hash" || _key == "seed_hash") {
+        if (_hex.size() + size > 64) {
+            _invalid = true;
+            return;
+        }
+        _hex.append(data, size);
+        if (!last) return;
+
+        string bytes;
+        unhex(_hex.data(), _hex.size(), bytes);
+        _hex.clear();
+        if (bytes.size() != 32 || _nibble >= 0) {
+            _invalid = true;
+            return;
+        }
+        if (_key == "prev_hash") {
+            _template->_prev_hash = to_hash(bytes);
+            _fields |= prev_hash;
+        } else {
+            _template->_seed_hash = to_hash(bytes);
+        }
+    }
+}
+
+void server::Template::Reader::on_number(const string &text) {
+    fold(text.data(), text.size());
+    fold("#", 1);
+    if (_depth != 2 || _section != "result") return;
+
+    char *end = nullptr;
+    errno = 0;
+    auto value = strtoull(text.c_str(), &end, 10);
+    if (*end != '\0' || errno == ERANGE) {
+        _invalid = true;
+        return;
+    }
+
+    if (_key == "height") {
+        _template->_height = value;
+        _fields |= height;
+    } else if (_key == "difficulty") {
+        _template->_difficulty = value;
+        _fields |= difficulty;
+    } else if (_key == "expected_reward") {
+        _template->_reward = value;
+    } else if (_key == "reserved_offset") {
+        _template->_reserved_offset = value;
+        _fields |= reserved_offset;
+    }
+}
+
+void server::Template::Reader::fold(const char *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        _digest = (_digest ^ (uint8_t) data[i]) * 0x100000001b3;
+    }
+}
+
+void server::Template::Reader::unhex(
+    const char *data,
+    size_t size,
+    string &out
+) {
+    for (size_t i = 0; i < size; i++) {
+        int digit = nibble_of(data[i]);
+        if (digit < 0) {
+            _invalid = true;
+            return;
+        }
+        if (_nibble < 0) {
+            _nibble = digit;
+        } else {
+            out += (char) (_nibble << 4 | digit);
+            _nibble = -1;
+        }
+    }
+}
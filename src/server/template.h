@@ -0,0 +1,136 @@
+#ifndef SYNCAIDE_SERVER_TEMPLATE_H
+#define SYNCAIDE_SERVER_TEMPLATE_H
+
+#include "server/web/reader.h"
+
+#include <nlohmann/json.hpp>
+#include <memory>
+#include <stdexcept>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <array>
+
+using namespace std;
+
+namespace server {
+    using nlohmann::json;
+
+    // Block template as returned by the daemon's getblocktemplate, decoded
+    // once into binary. The blob is walked far enough to recover the hashes
+    // of the transactions it commits to, which together with the height and
+    // the previous block identify whether a template is new work.
+    class Template {
+    public:
+        typedef array<uint8_t, 32> hash_type;
+
+        class Reader;
+
+    private:
+        uint64_t _height = 0;
+        uint64_t _difficulty = 0;
+        uint64_t _reward = 0;
+        size_t _reserved_offset = 0;
+        hash_type _prev_hash{};
+        hash_type _seed_hash{};
+        string _blob;
+        vector<hash_type> _txs;
+
+        Template() = default;
+
+    public:
+        explicit Template(const json &result);
+
+        Template(
+            uint64_t height,
+            uint64_t difficulty,
+            uint64_t reward,
+            size_t reserved_offset,
+            const string &prev_hash,
+            const string &seed_hash,
+            string blob
+        );
+
+        uint64_t height() const;
+
+        uint64_t difficulty() const;
+
+        uint64_t reward() const;
+
+        size_t reserved_offset() const;
+
+        const hash_type &prev_hash() const;
+
+        const hash_type &seed_hash() const;
+
+        const string &blob() const;
+
+        const vector<hash_type> &txs() const;
+
+        bool same(const Template &other) const;
+
+        static string hex(const hash_type &hash);
+
+        static string unhex(const string &text);
+
+    private:
+        void decode();
+    };
+
+    // Builds a Template straight from a getblocktemplate reply as it is
+    // read off the socket. The blob is decoded from hex slice by slice, so
+    // neither the reply text nor a json document is ever held in memory.
+    // A digest of the reply's content lets callers recognise a repeat.
+    class Template::Reader : public web::Reader {
+        enum fields {
+            height = 0x01,
+            difficulty = 0x02,
+            reserved_offset = 0x04,
+            prev_hash = 0x08,
+            blob = 0x10
+        };
+
+    private:
+        shared_ptr<Template> _template;
+        int _depth;
+        bool _complete;
+        string _section;
+        string _key;
+        string _hex;
+        int _nibble;
+        bool _invalid;
+        unsigned int _fields;
+        uint64_t _digest;
+        string _error;
+
+    public:
+        Reader();
+
+        void clear() override;
+
+        void complete(bool valid) override;
+
+        shared_ptr<const Template> result() const;
+
+        const string &error() const;
+
+        uint64_t digest() const;
+
+        void on_begin(bool array) override;
+
+        void on_end(bool array) override;
+
+        void on_key(const string &key) override;
+
+        void on_string(const char *data, size_t size, bool last) override;
+
+        void on_number(const string &text) override;
+
+    private:
+        void fold(const char *data, size_t size);
+
+        void unhex(const char *data, size_t size, string &out);
+    };
+}
+
+#endif //SYNCAIDE_SERVER_TEMPLATE_H
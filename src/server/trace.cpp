@@ -0,0 +1,210 @@
+#include "server/trace.h"
+
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <array>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+    using server::trace::Event;
+
+    // Only the owning thread writes a ring. It fills the slot and then
+    // publishes it by advancing the head, readers copy what lies behind the
+    // head and discard whatever the writer may have lapped meanwhile.
+    struct Ring {
+        uint32_t tid = 0;
+        atomic<uint64_t> head{0};
+        atomic<uint64_t> floor{0};
+        array<Event, server::trace::capacity> events;
+    };
+
+    struct Rings {
+        mutex lock;
+        vector<unique_ptr<Ring>> all;
+        vector<Ring *> idle;
+        uint32_t next = 0;
+    };
+
+    // Never destroyed, threads may still record while statics go away.
+    Rings &rings() {
+        static auto instance = new Rings;
+        return *instance;
+    }
+
+    // Hands the ring back when its thread exits. The events stay readable
+    // until another thread picks the ring up again.
+    struct Owner {
+        Ring *ring;
+
+        Owner() {
+            auto &all = rings();
+            lock_guard<mutex> lock(all.lock);
+            if (!all.idle.empty()) {
+                ring = all.idle.back();
+                all.idle.pop_back();
+            } else {
+                all.all.emplace_back(new Ring);
+                ring = all.all.back().get();
+                ring->tid = ++all.next;
+            }
+        }
+
+        ~Owner() {
+            auto &all = rings();
+            lock_guard<mutex> lock(all.lock);
+            all.idle.emplace_back(ring);
+        }
+    };
+
+    Ring &local() {
+        thread_local Owner owner;
+        return *owner.ring;
+    }
+
+    // Reference point for converting ticks. The rate is measured against
+    // the steady clock over everything since, so it gets more precise the
+    // longer the process runs.
+    struct Epoch {
+        uint64_t ticks;
+        chrono::steady_clock::time_point time;
+    };
+
+    const Epoch &epoch() {
+        static const Epoch instance{
+            server::trace::ticks(),
+            chrono::steady_clock::now()
+        };
+        return instance;
+    }
+}
+
+uint64_t server::trace::ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t) chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()
+    ).count();
+#endif
+}
+
+void server::trace::record(
+    const char *name,
+    Phase phase,
+    uint64_t id,
+    uint64_t ticks,
+    uint64_t duration
+) {
+    epoch();
+    auto &ring = local();
+    auto head = ring.head.load(memory_order_relaxed);
+    ring.events[head % capacity] = {ticks, duration, id, name, phase};
+    ring.head.store(head + 1, memory_order_release);
+}
+
+void server::trace::begin(const char *name, uint64_t id) {
+    record(name, Phase::BEGIN, id, ticks());
+}
+
+void server::trace::end(const char *name, uint64_t id) {
+    record(name, Phase::END, id, ticks());
+}
+
+void server::trace::instant(const char *name, uint64_t id) {
+    record(name, Phase::INSTANT, id, ticks());
+}
+
+nlohmann::json server::trace::dump() {
+    auto &start = epoch();
+    auto elapsed = chrono::duration<double, micro>(
+        chrono::steady_clock::now() - start.time
+    ).count();
+    auto span = ticks() - start.ticks;
+    auto scale = span > 0 ? elapsed / span : 1.0;
+
+    vector<pair<uint32_t, Event>> events;
+    {
+        auto &all = rings();
+        lock_guard<mutex> lock(all.lock);
+        for (auto &ring : all.all) {
+            auto head = ring->head.load(memory_order_acquire);
+            auto first = max<uint64_t>(
+                head > capacity ? head - capacity : 0,
+                ring->floor.load(memory_order_relaxed)
+            );
+            vector<Event> copied;
+            for (auto i = first; i < head; i++) {
+                copied.emplace_back(ring->events[i % capacity]);
+            }
+
+            // The writer may already be filling the slot after the last
+            // one it published, which holds the oldest event still behind
+            // the head, so that one is dropped as well.
+            auto lapped = ring->head.load(memory_order_acquire);
+            auto valid = lapped >= capacity ? lapped - capacity + 1 : 0;
+            for (auto i = first; i < head; i++) {
+                if (i < valid) continue;
+                events.emplace_back(ring->tid, copied[i - first]);
+            }
+        }
+    }
+
+    stable_sort(events.begin(), events.end(), [](auto &a, auto &b) {
+        return a.second.ticks < b.second.ticks;
+    });
+
+    auto pid = getpid();
+    json out = json::array();
+    for (auto &[tid, event] : events) {
+        auto offset = (double) (int64_t) (event.ticks - start.ticks);
+        json each = {
+            {"name", event.name},
+            {"cat", "syncaide"},
+            {"ph", string(1, (char) event.phase)},
+            {"ts", offset * scale},
+            {"pid", pid},
+            {"tid", tid}
+        };
+        switch (event.phase) {
+            case Phase::COMPLETE:
+                each["dur"] = event.duration * scale;
+                break;
+            case Phase::BEGIN:
+            case Phase::END:
+                each["id"] = event.id;
+                break;
+            case Phase::INSTANT:
+                each["s"] = "t";
+                break;
+        }
+        out.emplace_back(move(each));
+    }
+    return {{"traceEvents", out}, {"displayTimeUnit", "ns"}};
+}
+
+void server::trace::clear() {
+    auto &all = rings();
+    lock_guard<mutex> lock(all.lock);
+    for (auto &ring : all.all) {
+        ring->floor.store(
+            ring->head.load(memory_order_acquire),
+            memory_order_relaxed
+        );
+    }
+}
+
+server::trace::Span::Span(const char *name, uint64_t id) :
+    _name(name),
+    _id(id),
+    _start(ticks()) {}
+
+server::trace::Span::~Span() {
+    record(_name, Phase::COMPLETE, _id, _start, ticks() - _start);
+}
@@ -0,0 +1,81 @@
+#ifndef SYNCAIDE_SERVER_TRACE_H
+#define SYNCAIDE_SERVER_TRACE_H
+
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <atomic>
+#include <string>
+
+using namespace std;
+
+namespace server {
+    namespace trace {
+        using nlohmann::json;
+
+        enum {
+            capacity = 4096
+        };
+
+        // Chrome trace-event phases. Complete events are spans that start
+        // and finish within one handler, the async pair brackets work that
+        // spans callbacks, such as a handshake, and is matched up by id.
+        enum class Phase : char {
+            COMPLETE = 'X',
+            BEGIN = 'b',
+            END = 'e',
+            INSTANT = 'i'
+        };
+
+        // Fixed-size record written into the recording thread's ring. The
+        // name must outlive the process, in practice a string literal.
+        struct Event {
+            uint64_t ticks;
+            uint64_t duration;
+            uint64_t id;
+            const char *name;
+            Phase phase;
+        };
+
+        // Timestamp counter where the CPU has one, nanoseconds of the
+        // steady clock elsewhere. Converted to microseconds on dump.
+        uint64_t ticks();
+
+        void record(
+            const char *name,
+            Phase phase,
+            uint64_t id,
+            uint64_t ticks,
+            uint64_t duration = 0
+        );
+
+        void begin(const char *name, uint64_t id);
+
+        void end(const char *name, uint64_t id);
+
+        void instant(const char *name, uint64_t id = 0);
+
+        // Everything still held in the rings of every thread, oldest first,
+        // as a Chrome trace-event document for chrome://tracing or Perfetto.
+        json dump();
+
+        void clear();
+
+        class Span {
+        private:
+            const char *_name;
+            uint64_t _id;
+            uint64_t _start;
+
+        public:
+            explicit Span(const char *name, uint64_t id = 0);
+
+            Span(const Span &) = delete;
+
+            Span &operator=(const Span &) = delete;
+
+            ~Span();
+        };
+    }
+}
+
+#endif //SYNCAIDE_SERVER_TRACE_H
@@ -3,105 +3,361 @@
 
 server::Upstream::Upstream(Server &server) :
     _server(server),
-    _timer_info(_ioc, steady_time_point::max()),
-    _timer_block_template(_ioc, steady_time_point::max()) {}
+    _timer(_ioc, steady_time_point::max()),
+    _balancer(make_shared<web::Balancer>(
+        _ioc,
+        server.cfg().network.upstreams,
+        connections,
+        pipeline,
+        chrono::milliseconds(server.cfg().network.hedge)
+    )),
+    _random(random_device()()) {
+    _info_poll.interval = chrono::milliseconds(polled);
+    _template_poll.interval = chrono::milliseconds(polled);
+
+    // Request bodies are rendered once here rather than on every poll, only
+    // the long-poll variant changes and only when a new block arrives.
+    _info_request = prepare("get_info");
+    _template_request = prepare("getblocktemplate", {
+        {"wallet_address", wallet},
+        {"reserve_size", reserve}
+    });
+    _batch_request = combine(_info_request, _template_request);
+}
 
 void server::Upstream::start() {
-    check_info({});
-    check_block_template({});
+    _balancer->run();
+
+    auto notify = _server.cfg().network.notify;
+    if (!notify.empty()) {
+        _notifier = make_shared<Notifier>(
+            _ioc,
+            notify,
+            "json-minimal-chain_main",
+            bind(&Upstream::on_notify, shared_from_this(), placeholders::_1)
+        );
+        _notifier->run();
+    }
+
+    auto now = chrono::steady_clock::now();
+    _info_poll.due = now;
+    _template_poll.due = now;
+    tick({});
 
-    _handlers.emplace_back([&] { _ioc.run(); });
+    _handlers.emplace_back([&] {
+        Placement::name("upstream-io");
+        _ioc.run();
+    });
     server::exit.upstream.get_future().wait();
     _ioc.stop();
     for_each(_handlers.begin(), _handlers.end(), [](thread &t) { t.join(); });
+    if (_notifier) _notifier->stop();
+    _balancer->stop();
+}
+
+shared_ptr<const server::Template> server::Upstream::block_template() const {
+    return atomic_load(&_template);
+}
+
+void server::Upstream::subscribe(template_handler handler) {
+    lock_guard<mutex> lock(_mutex);
+    _subscribers.emplace_back(move(handler));
 }
 
-void server::Upstream::check_info(error_code code) {
-    auto cfg = _server.cfg();
-    auto host = cfg.network.upstream.host();
-    auto port = cfg.network.upstream.port();
+void server::Upstream::offer(shared_ptr<const Template> block) {
+    boost::asio::post(_ioc, bind(
+        &Upstream::on_offer,
+        shared_from_this(),
+        block
+    ));
+}
 
-    request<string_body> req;
+server::Upstream::request_type server::Upstream::prepare(
+    const string &method,
+    const json &params
+) {
+    // The host header is filled in per daemon by the connection.
+    request_type req;
     req.method(verb::post);
-    req.target(string_view(Uri("http", host, port, "/json_rpc").compose()));
-    req.set(field::host, string_param(host));
+    req.target("/json_rpc");
     req.set(field::content_type, string_param("application/javascript"));
     req.set(field::user_agent, string_param(BOOST_BEAST_VERSION_STRING));
 
     // @formatter:off
-    string body = json{
+    json call = {
         {"jsonrpc", "2.0"},
-        {"id", "0"},
-        {"method", "get_info"}
-    }.dump();
+        {"id", method},
+        {"method", method}
+    };
     // @formatter:on
-    req.content_length(body.size());
-    req.body() = body;
+    if (!params.is_null()) call["params"] = params;
+
+    req.body() = call.dump();
+    req.keep_alive(true);
     req.prepare_payload();
+    return req;
+}
 
-    auto client = make_shared<web::Client>(_ioc);
-    client->request(req, [this, client](auto &resp) {
-//        cerr << "--- response ---" << endl;
-//        cerr << resp << endl;
-//        cerr << "--- end ---" << endl;
-    }, [this, client](const auto &msg, auto code) {
-//        cerr << "--- failure: check_info ---" << endl;
-    });
+server::Upstream::request_type server::Upstream::combine(
+    const request_type &first,
+    const request_type &second
+) {
+    request_type req = first;
+    req.body() = "[" + first.body() + "," + second.body() + "]";
+    req.prepare_payload();
+    return req;
+}
+
+bool server::Upstream::longpolling() const {
+    // Without push notifications the template request doubles as a
+    // long-poll, a daemon that supports it holds the reply until the
+    // template named by longpollid is superseded and any other daemon simply
+    // ignores it.
+    auto pushed = _notifier && _notifier->connected();
+    return !_longpollid.empty() && !pushed;
+}
 
-    _timer_info.expires_after(chrono::seconds(1));
-    _timer_info.async_wait(
+bool server::Upstream::leading() {
+    // Followers leave the daemon alone while heartbeats keep arriving from
+    // the elected node, and go back to polling it themselves as soon as they
+    // stop.
+    auto peering = _server.peering();
+    return !peering->fed() || peering->leading();
+}
+
+void server::Upstream::tick(error_code code) {
+    if (code == boost::asio::error::operation_aborted) return;
+
+    auto now = chrono::steady_clock::now();
+    if (!leading()) {
+        for (auto poll : {&_info_poll, &_template_poll}) {
+            if (!poll->inflight && poll->due <= now) {
+                poll->due = now + poll->interval;
+            }
+        }
+        return arm();
+    }
+
+    auto info = !_info_poll.inflight && _info_poll.due <= now;
+    auto block = !_template_poll.inflight && _template_poll.due <= now;
+
+    // Queries that fall due together share one round trip. A long-poll is
+    // held by the daemon on purpose and so never travels in a batch.
+    if (info && block && _batching && !longpolling()) {
+        poll_batch();
+    } else {
+        if (info) poll_info();
+        if (block) poll_template();
+    }
+    arm();
+}
+
+void server::Upstream::arm() {
+    auto next = steady_time_point::max();
+    for (auto poll : {&_info_poll, &_template_poll}) {
+        if (!poll->inflight) next = min(next, poll->due);
+    }
+
+    _timer.expires_at(next);
+    _timer.async_wait(
         bind(
-            &Upstream::check_info,
+            &Upstream::tick,
             shared_from_this(),
             placeholders::_1
         )
     );
 }
 
-void server::Upstream::check_block_template(error_code code) {
-    auto cfg = _server.cfg();
-    auto host = cfg.network.upstream.host();
-    auto port = cfg.network.upstream.port();
+void server::Upstream::done(Poll &poll, steady_time_point sent) {
+    poll.inflight = false;
 
-    request<string_body> req;
-    req.method(verb::post);
-    req.target(string_view(Uri("http", host, port, "/json_rpc").compose()));
-    req.set(field::host, string_param(host));
-    req.set(field::content_type, string_param("application/javascript"));
-    req.set(field::user_agent, string_param(BOOST_BEAST_VERSION_STRING));
+    // Counting from when the request went out means a long-poll the daemon
+    // held past the interval is followed up immediately, while a daemon that
+    // answered straight away is asked again once the interval has elapsed.
+    // The jitter keeps a cluster of nodes from polling in lockstep.
+    if (poll.dirty) {
+        poll.dirty = false;
+        poll.due = chrono::steady_clock::now();
+    } else {
+        uniform_int_distribution<int> spread(0, jitter);
+        poll.due = sent + poll.interval + chrono::milliseconds(spread(_random));
+    }
+    arm();
+}
 
-    // @formatter:off
-    string body = json{
-        {"jsonrpc", "2.0"},
-        {"id", "0"},
-        {"method", "getblocktemplate"},
-        {"params",
-            {
-                {"wallet_address", "44GBHzv6ZyQdJkjqZje6KLZ3xSyN1hBSFAnLP6EAqJtCRVzMzZmeXTC2AHKDS9aEDTRKmo6a6o9r9j86pYfhCWDkKjbtcns"},
-                {"reserve_size", 60}
+void server::Upstream::elapsed(const string &method, steady_time_point sent) {
+    metrics::upstream.with({method}).observe(chrono::steady_clock::now() - sent);
+}
+
+void server::Upstream::poll_info() {
+    _info_poll.inflight = true;
+    auto sent = chrono::steady_clock::now();
+    _balancer->request(_info_request, [] {
+        return make_shared<web::Reply>();
+    }, [this, sent](auto &resp) {
+        auto sink = resp.body().sink;
+        elapsed("get_info", sent);
+        on_info(static_cast<const web::Reply &>(*sink));
+        done(_info_poll, sent);
+    }, [this, sent](const auto &msg, auto code) {
+        log("upstream/get_info", code);
+        metrics::upstream_failures.with({"get_info"}).add();
+        done(_info_poll, sent);
+    });
+}
+
+void server::Upstream::poll_template() {
+    _template_poll.inflight = true;
+    auto pushed = _notifier && _notifier->connected();
+    _template_poll.interval = chrono::milliseconds(pushed ? notified : polled);
+
+    // A template that is slow to arrive means stale work across the whole
+    // cluster, so plain requests are hedged onto a second daemon.
+    auto longpoll = longpolling();
+    auto &req = longpoll ? _longpoll_request : _template_request;
+    auto policy = longpoll
+                  ? web::Balancer::Policy::LONGPOLL
+                  : web::Balancer::Policy::HEDGED;
+
+    auto sent = chrono::steady_clock::now();
+    _balancer->request(req, [] {
+        return make_shared<Template::Reader>();
+    }, [this, sent, longpoll](auto &resp) {
+        auto sink = resp.body().sink;
+        if (!longpoll) elapsed("getblocktemplate", sent);
+        on_block_template(static_cast<const Template::Reader &>(*sink));
+        done(_template_poll, sent);
+    }, [this, sent, longpoll](const auto &msg, auto code) {
+        if (!longpoll || code != boost::asio::error::timed_out) {
+            log("upstream/getblocktemplate", code);
+            metrics::upstream_failures.with({"getblocktemplate"}).add();
+        }
+        done(_template_poll, sent);
+    }, policy);
+}
+
+void server::Upstream::poll_batch() {
+    _info_poll.inflight = true;
+    _template_poll.inflight = true;
+    auto pushed = _notifier && _notifier->connected();
+    _template_poll.interval = chrono::milliseconds(pushed ? notified : polled);
+
+    auto sent = chrono::steady_clock::now();
+    _balancer->request(_batch_request, [] {
+        auto batch = make_shared<web::Batch>();
+        batch->add("get_info", make_shared<web::Reply>());
+        batch->add("getblocktemplate", make_shared<Template::Reader>());
+        return batch;
+    }, [this, sent](auto &resp) {
+        auto batch = static_pointer_cast<web::Batch>(resp.body().sink);
+        elapsed("batch", sent);
+
+        // Batches are optional in JSON-RPC and a daemon without them answers
+        // with a single error object. That settles it for good, both queries
+        // are sent on their own from then on.
+        if (!batch->supported()) {
+            _batching = false;
+            json extra = {{"call", "upstream/batch"}};
+            LOG(warning) << logging::add_value("Extra", move(extra))
+                         << "daemon does not support batches.";
+
+            auto now = chrono::steady_clock::now();
+            for (auto poll : {&_info_poll, &_template_poll}) {
+                poll->inflight = false;
+                poll->dirty = false;
+                poll->due = now;
             }
+            return arm();
         }
-    }.dump();
-    // @formatter:on
-    req.content_length(body.size());
-    req.body() = body;
-    req.prepare_payload();
 
-    auto client = make_shared<web::Client>(_ioc);
-    client->request(req, [this, client](auto &resp) {
-//        cerr << "--- response ---" << endl;
-//        cerr << resp << endl;
-//        cerr << "--- end ---" << endl;
-    }, [this, client](const auto &msg, auto code) {
-//        cerr << "--- failure: check_block_template ---" << endl;
+        auto info = batch->element(0);
+        auto block = batch->element(1);
+        on_info(static_cast<const web::Reply &>(*info));
+        on_block_template(static_cast<const Template::Reader &>(*block));
+        done(_info_poll, sent);
+        done(_template_poll, sent);
+    }, [this, sent](const auto &msg, auto code) {
+        log("upstream/batch", code);
+        metrics::upstream_failures.with({"batch"}).add();
+        done(_info_poll, sent);
+        done(_template_poll, sent);
+    }, web::Balancer::Policy::HEDGED);
+}
+
+void server::Upstream::on_info(const web::Reply &reply) {
+    if (!reply.error().empty()) {
+        json extra = {
+            {"call", "upstream/get_info"},
+            {"error", reply.error()}
+        };
+        LOG(error) << logging::add_value("Extra", move(extra));
+    }
+}
+
+void server::Upstream::on_block_template(const Template::Reader &reader) {
+    if (!reader.error().empty()) {
+        json extra = {
+            {"call", "upstream/getblocktemplate"},
+            {"error", reader.error()}
+        };
+        LOG(error) << logging::add_value("Extra", move(extra));
+        return;
+    }
+
+    // The daemon hands back the same bytes until the chain or its mempool
+    // moves, so a repeated poll is settled by comparing digests.
+    if (reader.digest() == _digest) return;
+    _digest = reader.digest();
+
+    auto current = reader.result();
+    auto previous = block_template();
+    if (previous && previous->same(*current)) return;
+    publish(current);
+}
+
+void server::Upstream::on_offer(shared_ptr<const Template> block) {
+    auto previous = block_template();
+    if (previous && previous->same(*block)) return;
+    publish(block);
+}
+
+void server::Upstream::publish(shared_ptr<const Template> current) {
+    _longpollid = Template::hex(current->prev_hash());
+    _longpoll_request = prepare("getblocktemplate", {
+        {"wallet_address", wallet},
+        {"reserve_size", reserve},
+        {"longpollid", _longpollid}
     });
+    atomic_store(&_template, current);
 
-    _timer_block_template.expires_after(chrono::seconds(1));
-    _timer_block_template.async_wait(
-        bind(
-            &Upstream::check_block_template,
-            shared_from_this(),
-            placeholders::_1
-        )
-    );
-}
\ No newline at end of file
+    json extra = {
+        {"height", current->height()},
+        {"difficulty", current->difficulty()},
+        {"txs", current->txs().size()}
+    };
+    LOG(info) << logging::add_value("Extra", move(extra))
+              << "new block template.";
+
+    vector<template_handler> subscribers;
+    {
+        lock_guard<mutex> lock(_mutex);
+        subscribers = _subscribers;
+    }
+    for (auto &handler : subscribers) {
+        handler(current);
+    }
+}
+
+void server::Upstream::on_notify(const string &message) {
+    json extra = {{"notification", message.substr(0, message.find(':'))}};
+    LOG(debug) << logging::add_value("Extra", move(extra));
+
+    // A notification arriving while a template request is out is not lost,
+    // the template is fetched again as soon as that reply is in.
+    if (_template_poll.inflight) {
+        _template_poll.dirty = true;
+    } else {
+        _template_poll.due = chrono::steady_clock::now();
+        arm();
+    }
+}
@@ -1,14 +1,24 @@
 #ifndef SYNCAIDE_SERVER_UPSTREAM_H
 #define SYNCAIDE_SERVER_UPSTREAM_H
 
-#include "server/web/client.h"
+#include "server/web/balancer.h"
+#include "server/web/reader.h"
+#include "server/web/batch.h"
+#include "server/notifier.h"
+#include "server/template.h"
 #include "server/server.h"
 #include "server/helper.h"
+#include "server/metrics.h"
 
 #include <boost/beast/core.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/steady_timer.hpp>
+#include <boost/asio/post.hpp>
+#include <functional>
 #include <algorithm>
+#include <memory>
+#include <random>
+#include <mutex>
 
 using namespace std;
 
@@ -23,22 +33,94 @@ namespace server {
     class Server;
 
     class Upstream : public enable_shared_from_this<Upstream> {
+        using request_type = request<string_body>;
+        using template_handler = function<void(shared_ptr<const Template>)>;
+
+        enum {
+            connections = 2,
+            pipeline = 4,
+            polled = 1000,
+            notified = 10000,
+            jitter = 100,
+            reserve = 60
+        };
+
+        // Schedule of one periodic daemon query. A query is never sent again
+        // while its previous reply is outstanding, and one that was asked for
+        // in the meantime is marked dirty and sent as soon as the reply is in.
+        struct Poll {
+            chrono::milliseconds interval;
+            steady_time_point due;
+            bool inflight = false;
+            bool dirty = false;
+        };
+
+        static constexpr const char *wallet = "44GBHzv6ZyQdJkjqZje6KLZ3xSyN1hBSFAnLP6EAqJtCRVzMzZmeXTC2AHKDS9aEDTRKmo6a6o9r9j86pYfhCWDkKjbtcns";
+
     private:
         io_context _ioc;
         Server &_server;
         vector<thread> _handlers;
-        steady_timer _timer_info;
-        steady_timer _timer_block_template;
+        steady_timer _timer;
+        shared_ptr<web::Balancer> _balancer;
+        shared_ptr<Notifier> _notifier;
+        mt19937 _random;
+        Poll _info_poll;
+        Poll _template_poll;
+        bool _batching = true;
+        request_type _info_request;
+        request_type _template_request;
+        request_type _longpoll_request;
+        request_type _batch_request;
+        string _longpollid;
+        uint64_t _digest = 0;
+        shared_ptr<const Template> _template;
+        mutex _mutex;
+        vector<template_handler> _subscribers;
 
     public:
         explicit Upstream(Server &server);
 
         void start();
 
+        shared_ptr<const Template> block_template() const;
+
+        void subscribe(template_handler handler);
+
+        void offer(shared_ptr<const Template> block);
+
     private:
-        void check_info(error_code code);
+        request_type prepare(const string &method, const json &params = json());
+
+        request_type combine(const request_type &first, const request_type &second);
+
+        bool longpolling() const;
+
+        bool leading();
+
+        void tick(error_code code);
+
+        void arm();
+
+        void done(Poll &poll, steady_time_point sent);
+
+        void elapsed(const string &method, steady_time_point sent);
+
+        void poll_info();
+
+        void poll_template();
+
+        void poll_batch();
+
+        void on_info(const web::Reply &reply);
+
+        void on_block_template(const Template::Reader &reader);
+
+        void on_offer(shared_ptr<const Template> block);
+
+        void publish(shared_ptr<const Template> current);
 
-        void check_block_template(error_code code);
+        void on_notify(const string &message);
     };
 }
 
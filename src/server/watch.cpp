@@ -0,0 +1,94 @@
+#include "server/watch.h"
+
+server::Watch::Watch(const string &filter, size_t capacity) :
+    _filter(filter),
+    _capacity(capacity) {}
+
+bool server::Watch::matches(const string &id) const {
+    return _filter.empty() || _filter == id;
+}
+
+bool server::Watch::push(Event event) {
+    if (!matches(event.id)) return true;
+    {
+        lock_guard<mutex> lock(_mutex);
+        if (_closed || _overrun) return false;
+        if (_queue.size() >= _capacity) {
+            _queue.clear();
+            _overrun = true;
+            _overruns++;
+            return false;
+        }
+        _queue.emplace_back(move(event));
+    }
+    _cv.notify_one();
+    return true;
+}
+
+void server::Watch::reset(const vector<string> &ids) {
+    // The snapshot is bounded by the number of miners rather than by the
+    // capacity, it is what the watcher would have to fetch anyway.
+    {
+        lock_guard<mutex> lock(_mutex);
+        _queue.clear();
+        _overrun = false;
+        _queue.emplace_back(Event{Type::RESET, string()});
+        for (const auto &id : ids) {
+            if (matches(id)) _queue.emplace_back(Event{Type::SNAPSHOT, id});
+        }
+        _queue.emplace_back(Event{Type::SYNCED, string()});
+    }
+    _cv.notify_one();
+}
+
+bool server::Watch::overrun() const {
+    lock_guard<mutex> lock(_mutex);
+    return _overrun;
+}
+
+uint64_t server::Watch::overruns() const {
+    lock_guard<mutex> lock(_mutex);
+    return _overruns;
+}
+
+bool server::Watch::next(Event &event, chrono::milliseconds timeout) {
+    unique_lock<mutex> lock(_mutex);
+    auto ready = _cv.wait_for(lock, timeout, [this] {
+        return !_queue.empty() || _closed;
+    });
+    if (!ready || _queue.empty()) return false;
+    event = move(_queue.front());
+    _queue.pop_front();
+    return true;
+}
+
+void server::Watch::close() {
+    {
+        lock_guard<mutex> lock(_mutex);
+        _closed = true;
+    }
+    _cv.notify_all();
+}
+
+bool server::Watch::closed() const {
+    lock_guard<mutex> lock(_mutex);
+    return _closed;
+}
+
+string server::Watch::name(Type type) {
+    switch (type) {
+        case Type::RESET:
+            return "reset";
+        case Type::SNAPSHOT:
+            return "snapshot";
+        case Type::SYNCED:
+            return "synced";
+        case Type::CONNECT:
+            return "connect";
+        case Type::LOGIN:
+            return "login";
+        case Type::DISCONNECT:
+            return "disconnect";
+    }
+    return string();
+}
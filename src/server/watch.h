@@ -0,0 +1,63 @@
+#ifndef SYNCAIDE_SERVER_WATCH_H
+#define SYNCAIDE_SERVER_WATCH_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+
+using namespace std;
+
+namespace server {
+    // Queue of miner events for one watcher. Events are pushed by whoever
+    // changes the miner set and taken by the thread streaming them out. The
+    // queue is bounded: a watcher that falls behind by more than its
+    // capacity is not allowed to hold memory or events back, its queue is
+    // dropped instead and the watcher is resynchronised with a fresh
+    // snapshot once it catches up.
+    class Watch {
+    public:
+        enum class Type { RESET, SNAPSHOT, SYNCED, CONNECT, LOGIN, DISCONNECT };
+
+        struct Event {
+            Type type;
+            string id;
+        };
+
+    private:
+        mutable mutex _mutex;
+        condition_variable _cv;
+        string _filter;
+        size_t _capacity;
+        deque<Event> _queue;
+        bool _overrun = false;
+        bool _closed = false;
+        uint64_t _overruns = 0;
+
+    public:
+        Watch(const string &filter, size_t capacity);
+
+        bool matches(const string &id) const;
+
+        bool push(Event event);
+
+        void reset(const vector<string> &ids);
+
+        bool overrun() const;
+
+        uint64_t overruns() const;
+
+        bool next(Event &event, chrono::milliseconds timeout);
+
+        void close();
+
+        bool closed() const;
+
+        static string name(Type type);
+    };
+}
+
+#endif //SYNCAIDE_SERVER_WATCH_H
@@ -0,0 +1,221 @@
+#include "logging.h"
+#include "server/web/balancer.h"
+
+struct server::web::Balancer::Hedge {
+    request_type req;
+    sink_factory sink;
+    success_type success;
+    failure_type failure;
+    Policy policy;
+    vector<size_t> order;
+    size_t next = 0;
+    size_t outstanding = 0;
+    bool done = false;
+    steady_timer timer;
+
+    explicit Hedge(io_context &ioc) : timer(ioc) {}
+};
+
+server::web::Balancer::Balancer(
+    io_context &ioc,
+    const vector<Uri> &uris,
+    size_t size,
+    size_t depth,
+    chrono::milliseconds hedge,
+    chrono::milliseconds deadline,
+    chrono::milliseconds held
+) : _ioc(ioc),
+    _hedge(hedge),
+    _deadline(deadline),
+    _held(held) {
+    for (auto &uri : uris) {
+        Member member;
+        member.pool = make_shared<Pool>(ioc, uri, size, depth);
+        member.cooldown = chrono::seconds(cooldown);
+        _members.emplace_back(member);
+    }
+}
+
+void server::web::Balancer::run() {
+    for (auto &member : _members) {
+        member.pool->run();
+    }
+}
+
+void server::web::Balancer::stop() {
+    for (auto &member : _members) {
+        member.pool->stop();
+    }
+}
+
+void server::web::Balancer::request(
+    const request_type &req,
+    sink_factory sink,
+    success_type success,
+    failure_type failure,
+    Policy policy
+) {
+    auto hedge = make_shared<Hedge>(_ioc);
+    hedge->req = req;
+    hedge->sink = move(sink);
+    hedge->success = move(success);
+    hedge->failure = move(failure);
+    hedge->policy = policy;
+    hedge->order = rank();
+    attempt(hedge);
+}
+
+size_t server::web::Balancer::size() const {
+    return _members.size();
+}
+
+size_t server::web::Balancer::available() const {
+    return count_if(_members.begin(), _members.end(), [](const Member &member) {
+        return member.breaker == Breaker::CLOSED;
+    });
+}
+
+double server::web::Balancer::latency(size_t index) const {
+    return _members.at(index).latency;
+}
+
+vector<size_t> server::web::Balancer::rank() {
+    auto now = chrono::steady_clock::now();
+    vector<size_t> ready, probes, sidelined;
+    for (size_t i = 0; i < _members.size(); i++) {
+        auto &member = _members[i];
+        if (member.breaker == Breaker::OPEN
+            && now - member.opened >= member.cooldown) {
+            member.breaker = Breaker::HALF_OPEN;
+        }
+
+        if (member.breaker == Breaker::CLOSED) {
+            ready.emplace_back(i);
+        } else if (member.breaker == Breaker::HALF_OPEN && !member.probing) {
+            probes.emplace_back(i);
+        } else {
+            sidelined.emplace_back(i);
+        }
+    }
+
+    // Daemons without a sample yet sort first so that every one of them
+    // gets measured before the averages decide.
+    stable_sort(ready.begin(), ready.end(), [this](size_t lhs, size_t rhs) {
+        auto &a = _members[lhs];
+        auto &b = _members[rhs];
+        return (a.measured ? a.latency : 0) < (b.measured ? b.latency : 0);
+    });
+    ready.insert(ready.end(), probes.begin(), probes.end());
+
+    // With every daemon sidelined the one that has rested longest is still
+    // better than failing the request outright.
+    if (ready.empty()) {
+        stable_sort(sidelined.begin(), sidelined.end(),
+            [this](size_t lhs, size_t rhs) {
+                return _members[lhs].opened < _members[rhs].opened;
+            }
+        );
+        return sidelined;
+    }
+    return ready;
+}
+
+void server::web::Balancer::attempt(shared_ptr<Hedge> hedge) {
+    if (hedge->done || hedge->next >= hedge->order.size()) return;
+
+    auto index = hedge->order[hedge->next++];
+    auto &member = _members[index];
+    if (member.breaker == Breaker::HALF_OPEN) member.probing = true;
+
+    auto self = shared_from_this();
+    auto started = chrono::steady_clock::now();
+    auto longpoll = hedge->policy == Policy::LONGPOLL;
+    auto sample = !longpoll;
+    hedge->outstanding++;
+    member.pool->request(
+        hedge->req,
+        hedge->sink ? hedge->sink() : nullptr,
+        [self, hedge, index, started, sample](response_type &res) {
+            hedge->outstanding--;
+            self->succeed(index, chrono::steady_clock::now() - started, sample);
+            if (hedge->done) return;
+            hedge->done = true;
+            hedge->timer.cancel();
+            hedge->success(res);
+        },
+        [self, hedge, index, longpoll](const string &call, error_code code) {
+            hedge->outstanding--;
+
+            // Nothing changed while the long-poll was held, which says
+            // nothing about the daemon, and it is simply sent again.
+            if (longpoll && code == boost::asio::error::timed_out) {
+                hedge->done = true;
+                return hedge->failure(call, code);
+            }
+            self->fail(index);
+            if (hedge->done) return;
+            if (hedge->next < hedge->order.size()) return self->attempt(hedge);
+            if (hedge->outstanding > 0) return;
+            hedge->done = true;
+            hedge->timer.cancel();
+            hedge->failure(call, code);
+        },
+        longpoll ? _held : _deadline
+    );
+
+    if (hedge->policy == Policy::HEDGED && hedge->next < hedge->order.size()) {
+        hedge->timer.expires_after(_hedge);
+        hedge->timer.async_wait([self, hedge](error_code code) {
+            if (code == boost::asio::error::operation_aborted) return;
+            self->attempt(hedge);
+        });
+    }
+}
+
+void server::web::Balancer::succeed(
+    size_t index,
+    chrono::steady_clock::duration elapsed,
+    bool sample
+) {
+    auto &member = _members[index];
+    if (sample) {
+        auto latency = chrono::duration<double, milli>(elapsed).count();
+        member.latency = member.measured
+                         ? member.latency + alpha * (latency - member.latency)
+                         : latency;
+        member.measured = true;
+    }
+
+    member.failures = 0;
+    member.probing = false;
+    if (member.breaker != Breaker::CLOSED) {
+        member.breaker = Breaker::CLOSED;
+        member.cooldown = chrono::seconds(cooldown);
+
+        json extra = {{"upstream", member.pool->uri().netloc()}};
+        LOG(info) << logging::add_value("Extra", move(extra))
+                  << "upstream restored.";
+    }
+}
+
+void server::web::Balancer::fail(size_t index) {
+    auto &member = _members[index];
+    member.failures++;
+    member.probing = false;
+
+    if (member.breaker == Breaker::HALF_OPEN) {
+        member.cooldown = min(member.cooldown * 2, chrono::seconds(backoff));
+    } else if (member.breaker != Breaker::CLOSED || member.failures < threshold) {
+        return;
+    }
+    member.breaker = Breaker::OPEN;
+    member.opened = chrono::steady_clock::now();
+
+    json extra = {
+        {"upstream", member.pool->uri().netloc()},
+        {"failures", member.failures},
+        {"cooldown", member.cooldown.count()}
+    };
+    LOG(warning) << logging::add_value("Extra", move(extra))
+                 << "upstream sidelined.";
+}
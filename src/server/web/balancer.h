@@ -0,0 +1,120 @@
+#ifndef SYNCAIDE_SERVER_WEB_BALANCER_H
+#define SYNCAIDE_SERVER_WEB_BALANCER_H
+
+#include "server/web/pool.h"
+#include "server/helper.h"
+#include "common/uri.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <functional>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+namespace server {
+    namespace web {
+        using boost::asio::io_context;
+        using boost::asio::steady_timer;
+        using common::Uri;
+
+        // Spreads requests over several daemons, each behind its own Pool.
+        // Daemons are ranked by a moving average of their response time. A
+        // daemon that keeps failing is sidelined by a circuit breaker and
+        // only probed with single requests until it answers again. Hedged
+        // requests go to a second daemon when the first one is slow, and
+        // the first answer wins.
+        class Balancer : public enable_shared_from_this<Balancer> {
+        public:
+            // SINGLE fails over to the next daemon on error, HEDGED also
+            // races a second daemon once the hedge delay has passed, and
+            // LONGPOLL fails over without hedging or sampling latency since
+            // the daemon holds such requests on purpose. A long-poll gets a
+            // deadline of its own, and running out of it is not held
+            // against the daemon.
+            enum class Policy { SINGLE, HEDGED, LONGPOLL };
+
+        private:
+            using request_type = http::request<string_body>;
+            using response_type = http::response<stream_body>;
+            using sink_factory = function<shared_ptr<Sink>()>;
+            using success_type = function<void(response_type &)>;
+            using failure_type = function<void(const string &, error_code)>;
+
+            enum {
+                threshold = 3,
+                cooldown = 5,
+                backoff = 60
+            };
+
+            static constexpr double alpha = 0.2;
+
+            enum class Breaker { CLOSED, OPEN, HALF_OPEN };
+
+            struct Member {
+                shared_ptr<Pool> pool;
+                double latency = 0;
+                bool measured = false;
+                unsigned int failures = 0;
+                Breaker breaker = Breaker::CLOSED;
+                bool probing = false;
+                steady_time_point opened;
+                chrono::seconds cooldown;
+            };
+
+            struct Hedge;
+
+        private:
+            io_context &_ioc;
+            chrono::milliseconds _hedge;
+            chrono::milliseconds _deadline;
+            chrono::milliseconds _held;
+            vector<Member> _members;
+
+        public:
+            Balancer(
+                io_context &ioc,
+                const vector<Uri> &uris,
+                size_t size,
+                size_t depth,
+                chrono::milliseconds hedge,
+                chrono::milliseconds deadline = chrono::seconds(10),
+                chrono::milliseconds held = chrono::seconds(120)
+            );
+
+            void run();
+
+            void stop();
+
+            void request(
+                const request_type &req,
+                sink_factory sink,
+                success_type success,
+                failure_type failure,
+                Policy policy = Policy::SINGLE
+            );
+
+            size_t size() const;
+
+            size_t available() const;
+
+            double latency(size_t index) const;
+
+        private:
+            vector<size_t> rank();
+
+            void attempt(shared_ptr<Hedge> hedge);
+
+            void succeed(
+                size_t index,
+                chrono::steady_clock::duration elapsed,
+                bool sample
+            );
+
+            void fail(size_t index);
+        };
+    }
+}
+
+#endif //SYNCAIDE_SERVER_WEB_BALANCER_H
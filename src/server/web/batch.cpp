@@ -0,0 +1,99 @@
+#include "server/web/batch.h"
+
+server::web::Batch::Batch() : _tokenizer(*this) {
+    reset();
+}
+
+void server::web::Batch::add(const string &id, shared_ptr<Reader> reader) {
+    _elements.emplace_back(id, move(reader));
+}
+
+shared_ptr<server::web::Reader> server::web::Batch::element(size_t index) const {
+    return _elements.at(index).second;
+}
+
+bool server::web::Batch::supported() const {
+    return _array && _ordered;
+}
+
+void server::web::Batch::reset() {
+    _tokenizer.reset();
+    _index = -1;
+    _depth = 0;
+    _array = false;
+    _ordered = true;
+    _id = false;
+    _text.clear();
+    for (auto &element : _elements) {
+        element.second->reset();
+    }
+}
+
+void server::web::Batch::write(const char *data, size_t size) {
+    _tokenizer.feed(data, size);
+}
+
+void server::web::Batch::finish() {
+    auto valid = _tokenizer.done() && supported()
+                 && _index + 1 == (int) _elements.size();
+    for (auto &element : _elements) {
+        element.second->complete(valid);
+    }
+}
+
+void server::web::Batch::on_begin(bool array) {
+    if (_depth++ == 0) {
+        _array = array;
+        return;
+    }
+    if (_depth == 2) _index++;
+    if (auto reader = current()) reader->on_begin(array);
+}
+
+void server::web::Batch::on_end(bool array) {
+    // The element is looked up before leaving it so its reader also sees
+    // the closing brace.
+    auto reader = current();
+    if (--_depth == 0) return;
+    if (reader) reader->on_end(array);
+}
+
+void server::web::Batch::on_key(const string &key) {
+    if (_depth == 2) {
+        _id = key == "id";
+        _text.clear();
+    }
+    if (auto reader = current()) reader->on_key(key);
+}
+
+void server::web::Batch::on_string(const char *data, size_t size, bool last) {
+    if (_depth == 2 && _id) {
+        _text.append(data, size);
+        if (last) identify(_text);
+    }
+    if (auto reader = current()) reader->on_string(data, size, last);
+}
+
+void server::web::Batch::on_number(const string &text) {
+    if (_depth == 2 && _id) identify(text);
+    if (auto reader = current()) reader->on_number(text);
+}
+
+void server::web::Batch::on_literal(const string &text) {
+    if (_depth == 2 && _id) identify(text);
+    if (auto reader = current()) reader->on_literal(text);
+}
+
+server::web::Reader *server::web::Batch::current() {
+    if (!_array || _depth < 2) return nullptr;
+    if (_index < 0 || _index >= (int) _elements.size()) {
+        _ordered = false;
+        return nullptr;
+    }
+    return _elements[_index].second.get();
+}
+
+void server::web::Batch::identify(const string &id) {
+    _id = false;
+    if (current() && _elements[_index].first != id) _ordered = false;
+}
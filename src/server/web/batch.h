@@ -0,0 +1,72 @@
+#ifndef SYNCAIDE_SERVER_WEB_BATCH_H
+#define SYNCAIDE_SERVER_WEB_BATCH_H
+
+#include "server/web/reader.h"
+#include "server/web/tokenizer.h"
+#include "server/web/stream.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace server {
+    namespace web {
+        // Sink for the reply to a JSON-RPC batch. Every element of the reply
+        // array is handed to the reader registered for it. Elements are
+        // matched by position and their ids are checked, so a daemon that
+        // reorders the reply is treated like one without batch support.
+        class Batch : public Sink, public Tokenizer::Handler {
+            using element_type = pair<string, shared_ptr<Reader>>;
+
+        private:
+            Tokenizer _tokenizer;
+            vector<element_type> _elements;
+            int _index;
+            int _depth;
+            bool _array;
+            bool _ordered;
+            bool _id;
+            string _text;
+
+        public:
+            Batch();
+
+            Batch(const Batch &) = delete;
+
+            Batch &operator=(const Batch &) = delete;
+
+            void add(const string &id, shared_ptr<Reader> reader);
+
+            shared_ptr<Reader> element(size_t index) const;
+
+            bool supported() const;
+
+            void reset() override;
+
+            void write(const char *data, size_t size) override;
+
+            void finish() override;
+
+            void on_begin(bool array) override;
+
+            void on_end(bool array) override;
+
+            void on_key(const string &key) override;
+
+            void on_string(const char *data, size_t size, bool last) override;
+
+            void on_number(const string &text) override;
+
+            void on_literal(const string &text) override;
+
+        private:
+            Reader *current();
+
+            void identify(const string &id);
+        };
+    }
+}
+
+#endif //SYNCAIDE_SERVER_WEB_BATCH_H
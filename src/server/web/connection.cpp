@@ -0,0 +1,292 @@
+#include "server/web/connection.h"
+
+server::web::Connection::Connection(io_context &ioc, size_t depth) :
+    _socket(plain_socket(ioc)),
+    _secured(false),
+    _depth(max(depth, (size_t) 1)),
+    _active(chrono::steady_clock::now()),
+    _timer(ioc, steady_time_point::max()) {}
+
+server::web::Connection::Connection(
+    io_context &ioc,
+    ssl::context &ctx,
+    size_t depth
+) : _socket(ssl_socket(plain_socket(ioc), ctx)),
+    _secured(true),
+    _depth(max(depth, (size_t) 1)),
+    _active(chrono::steady_clock::now()),
+    _timer(ioc, steady_time_point::max()) {}
+
+void server::web::Connection::run(
+    const Uri &uri,
+    const tcp::resolver::results_type &endpoints
+) {
+    _state = State::CONNECTING;
+    _host = uri.host();
+    if (_secured) {
+        if (!SSL_set_tlsext_host_name(
+            boost::get<ssl_socket>(_socket).native_handle(),
+            uri.host().c_str()
+        )) {
+            error_code code{
+                static_cast<int>(::ERR_get_error()),
+                boost::asio::error::get_ssl_category()
+            };
+            return fail("handshake", code);
+        }
+
+        async_connect(
+            boost::get<ssl_socket>(_socket).next_layer(),
+            endpoints.begin(),
+            endpoints.end(),
+            bind(
+                &Connection::on_connect,
+                shared_from_this(),
+                placeholders::_1
+            )
+        );
+    } else {
+        async_connect(
+            boost::get<plain_socket>(_socket),
+            endpoints.begin(),
+            endpoints.end(),
+            bind(
+                &Connection::on_connect,
+                shared_from_this(),
+                placeholders::_1
+            )
+        );
+    }
+}
+
+void server::web::Connection::request(
+    const request_type &req,
+    shared_ptr<Sink> sink,
+    success_type success,
+    failure_type failure,
+    chrono::steady_clock::duration timeout
+) {
+    if (_state == State::CLOSED) {
+        failure("request", boost::asio::error::not_connected);
+        return;
+    }
+
+    auto exchange = make_shared<Exchange>();
+    exchange->req = req;
+    exchange->req.set(http::field::host, _host);
+    exchange->req.keep_alive(true);
+    exchange->req.prepare_payload();
+    exchange->res.body().sink = move(sink);
+    exchange->success = move(success);
+    exchange->failure = move(failure);
+    exchange->deadline = chrono::steady_clock::now() + timeout;
+    _queued.emplace_back(exchange);
+    arm();
+    pump();
+}
+
+void server::web::Connection::close() {
+    if (_state == State::CLOSED) return;
+    _state = State::CLOSED;
+    _timer.cancel();
+
+    error_code code;
+    if (_secured) {
+        auto &socket = boost::get<ssl_socket>(_socket).next_layer();
+        socket.shutdown(tcp::socket::shutdown_both, code);
+        socket.close(code);
+    } else {
+        auto &socket = boost::get<plain_socket>(_socket);
+        socket.shutdown(tcp::socket::shutdown_both, code);
+        socket.close(code);
+    }
+}
+
+size_t server::web::Connection::pending() const {
+    return _queued.size() + _inflight.size();
+}
+
+bool server::web::Connection::closed() const {
+    return _state == State::CLOSED;
+}
+
+server::steady_time_point server::web::Connection::active() const {
+    return _active;
+}
+
+void server::web::Connection::pump() {
+    if (_state != State::READY) return;
+    if (_writing || _queued.empty()) return;
+    if (_inflight.size() >= _depth) return;
+
+    _writing = true;
+    _inflight.emplace_back(_queued.front());
+    _queued.pop_front();
+
+    auto &req = _inflight.back()->req;
+    if (_secured) {
+        http::async_write(
+            boost::get<ssl_socket>(_socket),
+            req,
+            bind(
+                &Connection::on_write,
+                shared_from_this(),
+                placeholders::_1,
+                placeholders::_2
+            )
+        );
+    } else {
+        http::async_write(
+            boost::get<plain_socket>(_socket),
+            req,
+            bind(
+                &Connection::on_write,
+                shared_from_this(),
+                placeholders::_1,
+                placeholders::_2
+            )
+        );
+    }
+}
+
+void server::web::Connection::read() {
+    if (_reading || _inflight.empty()) return;
+
+    // Requests written after the one at the front may already be pipelined,
+    // but responses always arrive in order so only the front is ever read.
+    _reading = true;
+    auto &res = _inflight.front()->res;
+    if (_secured) {
+        http::async_read(
+            boost::get<ssl_socket>(_socket),
+            _buffer,
+            res,
+            bind(
+                &Connection::on_read,
+                shared_from_this(),
+                placeholders::_1,
+                placeholders::_2
+            )
+        );
+    } else {
+        http::async_read(
+            boost::get<plain_socket>(_socket),
+            _buffer,
+            res,
+            bind(
+                &Connection::on_read,
+                shared_from_this(),
+                placeholders::_1,
+                placeholders::_2
+            )
+        );
+    }
+}
+
+void server::web::Connection::arm() {
+    auto next = steady_time_point::max();
+    for (auto queue : {&_inflight, &_queued}) {
+        for (auto &exchange : *queue) next = min(next, exchange->deadline);
+    }
+    if (next == _timer.expiry()) return;
+
+    _timer.expires_at(next);
+    if (next == steady_time_point::max()) return;
+    _timer.async_wait(
+        bind(
+            &Connection::on_timer,
+            shared_from_this(),
+            placeholders::_1
+        )
+    );
+}
+
+void server::web::Connection::fail(const string &call, error_code code) {
+    close();
+
+    deque<shared_ptr<Exchange>> failed;
+    failed.swap(_inflight);
+    move(_queued.begin(), _queued.end(), back_inserter(failed));
+    _queued.clear();
+
+    for (auto &exchange : failed) {
+        exchange->failure(call, code);
+    }
+}
+
+void server::web::Connection::on_connect(error_code code) {
+    if (code) return fail("connect", code);
+
+    error_code ignored;
+    if (_secured) {
+        auto &socket = boost::get<ssl_socket>(_socket).next_layer();
+        socket.set_option(tcp::no_delay(true), ignored);
+        socket.set_option(tcp::socket::keep_alive(true), ignored);
+        boost::get<ssl_socket>(_socket).async_handshake(
+            ssl::stream_base::client,
+            bind(
+                &Connection::on_handshake,
+                shared_from_this(),
+                placeholders::_1
+            )
+        );
+    } else {
+        auto &socket = boost::get<plain_socket>(_socket);
+        socket.set_option(tcp::no_delay(true), ignored);
+        socket.set_option(tcp::socket::keep_alive(true), ignored);
+        on_handshake({});
+    }
+}
+
+void server::web::Connection::on_handshake(error_code code) {
+    if (code) return fail("handshake", code);
+    _state = State::READY;
+    _active = chrono::steady_clock::now();
+    pump();
+}
+
+void server::web::Connection::on_write(
+    error_code code,
+    size_t bytes_transferred
+) {
+    ignore_unused(bytes_transferred);
+    if (code) return fail("write", code);
+
+    _writing = false;
+    _active = chrono::steady_clock::now();
+    read();
+    pump();
+}
+
+void server::web::Connection::on_read(
+    error_code code,
+    size_t bytes_transferred
+) {
+    ignore_unused(bytes_transferred);
+    if (code) return fail("read", code);
+
+    _reading = false;
+    _active = chrono::steady_clock::now();
+
+    auto exchange = _inflight.front();
+    _inflight.pop_front();
+    arm();
+    exchange->success(exchange->res);
+
+    if (!exchange->res.keep_alive()) {
+        return fail("keep_alive", boost::asio::error::eof);
+    }
+
+    read();
+    pump();
+}
+
+void server::web::Connection::on_timer(error_code code) {
+    if (code == boost::asio::error::operation_aborted) return;
+    if (_state == State::CLOSED) return;
+
+    // A daemon that took the request and never answers would otherwise
+    // hold on to the exchange, and whoever waits for it, for good.
+    if (_timer.expiry() > chrono::steady_clock::now()) return;
+    fail("timeout", boost::asio::error::timed_out);
+}
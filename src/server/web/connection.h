@@ -0,0 +1,129 @@
+#ifndef SYNCAIDE_SERVER_WEB_CONNECTION_H
+#define SYNCAIDE_SERVER_WEB_CONNECTION_H
+
+#include "server/web/stream.h"
+#include "server/ssl_stream.h"
+#include "server/helper.h"
+#include "common/uri.h"
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/version.hpp>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/ssl/error.hpp>
+#include <boost/asio/ssl/stream.hpp>
+#include <boost/variant.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include <deque>
+
+using namespace std;
+
+namespace server {
+    namespace web {
+        namespace ssl = boost::asio::ssl;
+        namespace http = boost::beast::http;
+        using boost::system::error_code;
+        using boost::beast::http::request;
+        using boost::beast::http::response;
+        using boost::beast::http::string_body;
+        using boost::beast::flat_buffer;
+        using boost::asio::ip::tcp;
+        using boost::asio::io_context;
+        using boost::asio::steady_timer;
+        using boost::asio::async_connect;
+        using boost::ignore_unused;
+        using boost::variant;
+        using common::Uri;
+
+        // Persistent HTTP/1.1 connection to a single daemon. Requests are
+        // pipelined up to `depth` deep and answered in the order they were
+        // written. A closed connection is never reopened, the owning Pool
+        // replaces it instead. Every exchange has a deadline, and as replies
+        // cannot be skipped over, one that passes closes the connection and
+        // fails everything on it.
+        class Connection : public enable_shared_from_this<Connection> {
+            using plain_socket = tcp::socket;
+            using ssl_socket = ssl_stream<tcp::socket>;
+            using Socket = variant<plain_socket, ssl_socket>;
+            using request_type = http::request<string_body>;
+            using response_type = http::response<stream_body>;
+            using success_type = function<void(response_type &)>;
+            using failure_type = function<void(const string &, error_code)>;
+
+            struct Exchange {
+                request_type req;
+                response_type res;
+                success_type success;
+                failure_type failure;
+                steady_time_point deadline;
+            };
+
+            enum class State { IDLE, CONNECTING, READY, CLOSED };
+
+        private:
+            bool _secured;
+            Socket _socket;
+            size_t _depth;
+            string _host;
+            State _state = State::IDLE;
+            bool _writing = false;
+            bool _reading = false;
+            flat_buffer _buffer;
+            deque<shared_ptr<Exchange>> _queued;
+            deque<shared_ptr<Exchange>> _inflight;
+            steady_time_point _active;
+            steady_timer _timer;
+
+        public:
+            Connection(io_context &ioc, size_t depth);
+
+            Connection(io_context &ioc, ssl::context &ctx, size_t depth);
+
+            void run(
+                const Uri &uri,
+                const tcp::resolver::results_type &endpoints
+            );
+
+            void request(
+                const request_type &req,
+                shared_ptr<Sink> sink,
+                success_type success,
+                failure_type failure,
+                chrono::steady_clock::duration timeout
+            );
+
+            void close();
+
+            size_t pending() const;
+
+            bool closed() const;
+
+            steady_time_point active() const;
+
+        private:
+            void pump();
+
+            void read();
+
+            void arm();
+
+            void fail(const string &call, error_code code);
+
+            void on_connect(error_code code);
+
+            void on_handshake(error_code code);
+
+            void on_write(error_code code, size_t bytes_transferred);
+
+            void on_read(error_code code, size_t bytes_transferred);
+
+            void on_timer(error_code code);
+        };
+    }
+}
+
+#endif //SYNCAIDE_SERVER_WEB_CONNECTION_H
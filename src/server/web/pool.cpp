@@ -0,0 +1,213 @@
+#include "logging.h"
+#include "server/web/pool.h"
+
+server::web::Pool::Pool(
+    io_context &ioc,
+    const Uri &uri,
+    size_t size,
+    size_t depth
+) : _ioc(ioc),
+    _ctx(ssl::context::sslv23_client),
+    _uri(uri),
+    _size(max(size, (size_t) 1)),
+    _depth(depth),
+    _resolver(ioc),
+    _timer(ioc, steady_time_point::max()) {}
+
+void server::web::Pool::run() {
+    resolve();
+    _timer.expires_after(chrono::seconds(interval));
+    _timer.async_wait(
+        bind(
+            &Pool::on_timer,
+            shared_from_this(),
+            placeholders::_1
+        )
+    );
+}
+
+void server::web::Pool::stop() {
+    _timer.cancel();
+    _resolver.cancel();
+    for (auto &connection : _connections) {
+        connection->close();
+    }
+    _connections.clear();
+}
+
+void server::web::Pool::request(
+    const request_type &req,
+    success_type success,
+    failure_type failure,
+    chrono::steady_clock::duration timeout
+) {
+    dispatch(req, nullptr, move(success), move(failure), timeout, true);
+}
+
+void server::web::Pool::request(
+    const request_type &req,
+    shared_ptr<Sink> sink,
+    success_type success,
+    failure_type failure,
+    chrono::steady_clock::duration timeout
+) {
+    dispatch(req, move(sink), move(success), move(failure), timeout, true);
+}
+
+const common::Uri &server::web::Pool::uri() const {
+    return _uri;
+}
+
+void server::web::Pool::dispatch(
+    const request_type &req,
+    shared_ptr<Sink> sink,
+    success_type success,
+    failure_type failure,
+    chrono::steady_clock::duration timeout,
+    bool retry
+) {
+    auto self = shared_from_this();
+    if (_endpoints.empty()) {
+        _waiting.emplace_back(
+            [self, req, sink, success, failure, timeout, retry](error_code code) {
+                if (code) return failure("resolve", code);
+                self->dispatch(req, sink, success, failure, timeout, retry);
+            }
+        );
+        if (!_resolving) resolve();
+        return;
+    }
+
+    acquire()->request(
+        req,
+        sink,
+        success,
+        [self, req, sink, success, failure, timeout, retry](
+            const string &call,
+            error_code code
+        ) {
+            // A connection the daemon dropped while it sat idle is only
+            // noticed by the next exchange on it, so that exchange gets one
+            // more attempt on a fresh connection before it is reported. One
+            // that ran out of time has waited long enough already.
+            if (retry && code != boost::asio::error::timed_out) {
+                return self->dispatch(req, sink, success, failure, timeout, false);
+            }
+            failure(call, code);
+        },
+        timeout
+    );
+}
+
+void server::web::Pool::resolve() {
+    _resolving = true;
+    _resolver.async_resolve(
+        _uri.host(),
+        to_string(_uri.port()),
+        bind(
+            &Pool::on_resolve,
+            shared_from_this(),
+            placeholders::_1,
+            placeholders::_2
+        )
+    );
+}
+
+shared_ptr<server::web::Connection> server::web::Pool::acquire() {
+    _connections.erase(
+        remove_if(_connections.begin(), _connections.end(),
+            [](const shared_ptr<Connection> &connection) {
+                return connection->closed();
+            }
+        ),
+        _connections.end()
+    );
+
+    shared_ptr<Connection> least;
+    for (auto &connection : _connections) {
+        if (!least || connection->pending() < least->pending()) {
+            least = connection;
+        }
+    }
+
+    if (!least || (least->pending() > 0 && _connections.size() < _size)) {
+        least = connect();
+    }
+    return least;
+}
+
+shared_ptr<server::web::Connection> server::web::Pool::connect() {
+    shared_ptr<Connection> connection;
+    if (_uri.is_tls()) {
+        connection = make_shared<Connection>(_ioc, _ctx, _depth);
+    } else {
+        connection = make_shared<Connection>(_ioc, _depth);
+    }
+
+    connection->run(_uri, _endpoints);
+    _connections.emplace_back(connection);
+    return connection;
+}
+
+void server::web::Pool::on_resolve(
+    error_code code,
+    tcp::resolver::results_type results
+) {
+    _resolving = false;
+    if (code == boost::asio::error::operation_aborted) return;
+    if (code) {
+        log("pool/resolve", code);
+    } else {
+        _endpoints = results;
+        _resolved = chrono::steady_clock::now();
+    }
+
+    // A failed refresh keeps serving the previous addresses, requests only
+    // fail when the daemon has never been resolved at all.
+    if (!_endpoints.empty()) code = {};
+
+    deque<function<void(error_code)>> waiting;
+    waiting.swap(_waiting);
+    for (auto &each : waiting) {
+        each(code);
+    }
+
+    if (!code && _connections.empty()) connect();
+}
+
+void server::web::Pool::on_timer(error_code code) {
+    if (code == boost::asio::error::operation_aborted) return;
+    if (code) return log("pool/timer", code);
+
+    auto now = chrono::steady_clock::now();
+    auto open = _connections.size();
+    for (auto &connection : _connections) {
+        if (open <= 1) break;
+        if (connection->pending() > 0) continue;
+        if (now - connection->active() > chrono::seconds(idle)) {
+            connection->close();
+            open--;
+        }
+    }
+
+    _connections.erase(
+        remove_if(_connections.begin(), _connections.end(),
+            [](const shared_ptr<Connection> &connection) {
+                return connection->closed();
+            }
+        ),
+        _connections.end()
+    );
+
+    if (!_resolving && now - _resolved > chrono::seconds(ttl)) resolve();
+    else if (!_endpoints.empty() && _connections.empty()) connect();
+
+    _timer.expires_after(chrono::seconds(interval));
+    _timer.async_wait(
+        bind(
+            &Pool::on_timer,
+            shared_from_this(),
+            placeholders::_1
+        )
+    );
+}
@@ -0,0 +1,114 @@
+#ifndef SYNCAIDE_SERVER_WEB_POOL_H
+#define SYNCAIDE_SERVER_WEB_POOL_H
+
+#include "server/web/connection.h"
+#include "server/helper.h"
+#include "common/uri.h"
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <deque>
+
+using namespace std;
+
+namespace server {
+    namespace web {
+        namespace ssl = boost::asio::ssl;
+        namespace http = boost::beast::http;
+        using boost::asio::io_context;
+        using boost::asio::steady_timer;
+        using boost::asio::ip::tcp;
+        using boost::beast::http::request;
+        using boost::beast::http::response;
+        using boost::beast::http::string_body;
+        using common::Uri;
+
+        // Keep-alive connections to one daemon sharing a single TLS context
+        // and a cached DNS resolution. Like Upstream, which owns it, the
+        // pool expects its io_context to be run by a single thread.
+        class Pool : public enable_shared_from_this<Pool> {
+            using request_type = http::request<string_body>;
+            using response_type = http::response<stream_body>;
+            using success_type = function<void(response_type &)>;
+            using failure_type = function<void(const string &, error_code)>;
+
+            enum {
+                ttl = 60,
+                idle = 30,
+                interval = 5,
+                deadline = 10
+            };
+
+        private:
+            io_context &_ioc;
+            ssl::context _ctx;
+            Uri _uri;
+            size_t _size;
+            size_t _depth;
+            tcp::resolver _resolver;
+            tcp::resolver::results_type _endpoints;
+            steady_time_point _resolved;
+            bool _resolving = false;
+            steady_timer _timer;
+            vector<shared_ptr<Connection>> _connections;
+            deque<function<void(error_code)>> _waiting;
+
+        public:
+            Pool(io_context &ioc, const Uri &uri, size_t size, size_t depth);
+
+            void run();
+
+            void stop();
+
+            // Exchanges that get no reply within the timeout fail with
+            // timed_out.
+            void request(
+                const request_type &req,
+                success_type success,
+                failure_type failure,
+                chrono::steady_clock::duration timeout = chrono::seconds(deadline)
+            );
+
+            void request(
+                const request_type &req,
+                shared_ptr<Sink> sink,
+                success_type success,
+                failure_type failure,
+                chrono::steady_clock::duration timeout = chrono::seconds(deadline)
+            );
+
+            const Uri &uri() const;
+
+        private:
+            void dispatch(
+                const request_type &req,
+                shared_ptr<Sink> sink,
+                success_type success,
+                failure_type failure,
+                chrono::steady_clock::duration timeout,
+                bool retry
+            );
+
+            void resolve();
+
+            shared_ptr<Connection> acquire();
+
+            shared_ptr<Connection> connect();
+
+            void on_resolve(
+                error_code code,
+                tcp::resolver::results_type results
+            );
+
+            void on_timer(error_code code);
+        };
+    }
+}
+
+#endif //SYNCAIDE_SERVER_WEB_POOL_H
@@ -0,0 +1,75 @@
+#include "server/web/reader.h"
+
+server::web::Reader::Reader() : _tokenizer(*this) {}
+
+void server::web::Reader::reset() {
+    _tokenizer.reset();
+    clear();
+}
+
+void server::web::Reader::write(const char *data, size_t size) {
+    _tokenizer.feed(data, size);
+}
+
+void server::web::Reader::finish() {
+    complete(_tokenizer.done());
+}
+
+server::web::Reply::Reply() {
+    clear();
+}
+
+void server::web::Reply::clear() {
+    _depth = 0;
+    _section.clear();
+    _key.clear();
+    _result.clear();
+    _error.clear();
+}
+
+void server::web::Reply::complete(bool valid) {
+    if (!valid && _error.empty()) _error = "Failure parsing reply.";
+}
+
+string server::web::Reply::result(const string &key) const {
+    auto search = _result.find(key);
+    if (search == _result.end()) return string();
+    return search->second;
+}
+
+const string &server::web::Reply::error() const {
+    return _error;
+}
+
+void server::web::Reply::on_begin(bool array) {
+    _depth++;
+}
+
+void server::web::Reply::on_end(bool array) {
+    if (_depth == 2 && _section == "error" && _error.empty()) {
+        _error = "Failure reported by daemon.";
+    }
+    _depth--;
+}
+
+void server::web::Reply::on_key(const string &key) {
+    if (_depth == 1) _section = key;
+    if (_depth == 2) _key = key;
+}
+
+void server::web::Reply::on_string(const char *data, size_t size, bool last) {
+    if (_depth != 2) return;
+    if (_section == "result") {
+        _result[_key].append(data, size);
+    } else if (_section == "error" && _key == "message") {
+        _error.append(data, size);
+    }
+}
+
+void server::web::Reply::on_number(const string &text) {
+    if (_depth == 2 && _section == "result") _result[_key] = text;
+}
+
+void server::web::Reply::on_literal(const string &text) {
+    if (_depth == 2 && _section == "result") _result[_key] = text;
+}
@@ -0,0 +1,75 @@
+#ifndef SYNCAIDE_SERVER_WEB_READER_H
+#define SYNCAIDE_SERVER_WEB_READER_H
+
+#include "server/web/tokenizer.h"
+#include "server/web/stream.h"
+
+#include <string>
+#include <map>
+
+using namespace std;
+
+namespace server {
+    namespace web {
+        // Sink that tokenizes the body it is fed and handles the events
+        // itself. A reader can also be driven with events from outside,
+        // which is how a Batch gives every element of a reply its own one.
+        class Reader : public Sink, public Tokenizer::Handler {
+        private:
+            Tokenizer _tokenizer;
+
+        public:
+            Reader();
+
+            Reader(const Reader &) = delete;
+
+            Reader &operator=(const Reader &) = delete;
+
+            void reset() override;
+
+            void write(const char *data, size_t size) override;
+
+            void finish() override;
+
+            virtual void clear() = 0;
+
+            virtual void complete(bool valid) = 0;
+        };
+
+        // Reader for replies that are small enough to keep, collecting the
+        // scalar members of the result and the error message if any.
+        class Reply : public Reader {
+        private:
+            int _depth;
+            string _section;
+            string _key;
+            map<string, string> _result;
+            string _error;
+
+        public:
+            Reply();
+
+            void clear() override;
+
+            void complete(bool valid) override;
+
+            string result(const string &key) const;
+
+            const string &error() const;
+
+            void on_begin(bool array) override;
+
+            void on_end(bool array) override;
+
+            void on_key(const string &key) override;
+
+            void on_string(const char *data, size_t size, bool last) override;
+
+            void on_number(const string &text) override;
+
+            void on_literal(const string &text) override;
+        };
+    }
+}
+
+#endif //SYNCAIDE_SERVER_WEB_READER_H
@@ -0,0 +1,92 @@
+#ifndef SYNCAIDE_SERVER_WEB_STREAM_H
+#define SYNCAIDE_SERVER_WEB_STREAM_H
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/optional.hpp>
+#include <boost/asio/buffer.hpp>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+namespace server {
+    namespace web {
+        namespace http = boost::beast::http;
+        using boost::system::error_code;
+
+        // Consumer of a response body as it comes off the socket. reset() is
+        // called before every body, so a sink reused for a retried request
+        // starts from a clean slate.
+        class Sink {
+        public:
+            virtual ~Sink() = default;
+
+            virtual void reset() = 0;
+
+            virtual void write(const char *data, size_t size) = 0;
+
+            virtual void finish() = 0;
+        };
+
+        // Beast body that hands the payload to a Sink when one is attached
+        // and collects it into `text` otherwise, so streamed and buffered
+        // exchanges share one response type.
+        struct stream_body {
+            struct value_type {
+                string text;
+                shared_ptr<Sink> sink;
+            };
+
+            class reader {
+            private:
+                value_type &_body;
+
+            public:
+                template<bool isRequest, class Fields>
+                explicit reader(
+                    http::header<isRequest, Fields> &header,
+                    value_type &body
+                ) : _body(body) {}
+
+                void init(
+                    const boost::optional<uint64_t> &length,
+                    error_code &code
+                ) {
+                    code = {};
+                    if (_body.sink) {
+                        _body.sink->reset();
+                    } else {
+                        _body.text.clear();
+                        if (length) _body.text.reserve((size_t) *length);
+                    }
+                }
+
+                template<class ConstBufferSequence>
+                size_t put(const ConstBufferSequence &buffers, error_code &code) {
+                    code = {};
+                    size_t size = 0;
+                    for (auto it = boost::asio::buffer_sequence_begin(buffers);
+                         it != boost::asio::buffer_sequence_end(buffers); ++it) {
+                        boost::asio::const_buffer buffer = *it;
+                        auto data = static_cast<const char *>(buffer.data());
+                        if (_body.sink) {
+                            _body.sink->write(data, buffer.size());
+                        } else {
+                            _body.text.append(data, buffer.size());
+                        }
+                        size += buffer.size();
+                    }
+                    return size;
+                }
+
+                void finish(error_code &code) {
+                    code = {};
+                    if (_body.sink) _body.sink->finish();
+                }
+            };
+        };
+    }
+}
+
+#endif //SYNCAIDE_SERVER_WEB_STREAM_H
@@ -0,0 +1,266 @@
+#include "server/web/tokenizer.h"
+
+namespace {
+    bool space(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    int hex(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+}
+
+server::web::Tokenizer::Tokenizer(Handler &handler) : _handler(handler) {
+    reset();
+}
+
+void server::web::Tokenizer::reset() {
+    _state = State::VALUE;
+    _key = false;
+    _stack.clear();
+    _token.clear();
+    _unicode = 0;
+    _surrogate = 0;
+    _digits = 0;
+}
+
+bool server::web::Tokenizer::feed(const char *data, size_t size) {
+    size_t start = 0;
+    for (size_t i = 0; i < size; i++) {
+        char c = data[i];
+        switch (_state) {
+            case State::VALUE:
+            case State::FIRST_VALUE:
+                if (space(c)) break;
+                if (_state == State::FIRST_VALUE && c == ']') {
+                    _stack.pop_back();
+                    _handler.on_end(true);
+                    next();
+                    break;
+                }
+                if (!value(c)) return fail();
+                start = i + 1;
+                break;
+            case State::FIRST_KEY:
+                if (space(c)) break;
+                if (c == '}') {
+                    _stack.pop_back();
+                    _handler.on_end(false);
+                    next();
+                    break;
+                }
+                // fall through
+            case State::KEY:
+                if (space(c)) break;
+                if (c != '"') return fail();
+                _key = true;
+                _state = State::STRING;
+                start = i + 1;
+                break;
+            case State::COLON:
+                if (space(c)) break;
+                if (c != ':') return fail();
+                _state = State::VALUE;
+                break;
+            case State::NEXT:
+                if (space(c)) break;
+                if (c == ',') {
+                    _state = _stack.back() ? State::VALUE : State::KEY;
+                } else if (c == (_stack.back() ? ']' : '}')) {
+                    bool array = _stack.back();
+                    _stack.pop_back();
+                    _handler.on_end(array);
+                    next();
+                } else {
+                    return fail();
+                }
+                break;
+            case State::STRING:
+                if (c == '"') {
+                    text(data + start, i - start, true);
+                } else if (c == '\\') {
+                    text(data + start, i - start, false);
+                    _state = State::ESCAPE;
+                } else if ((unsigned char) c < 0x20) {
+                    return fail();
+                }
+                break;
+            case State::ESCAPE: {
+                char decoded;
+                switch (c) {
+                    case '"':
+                    case '\\':
+                    case '/':
+                        decoded = c;
+                        break;
+                    case 'b':
+                        decoded = '\b';
+                        break;
+                    case 'f':
+                        decoded = '\f';
+                        break;
+                    case 'n':
+                        decoded = '\n';
+                        break;
+                    case 'r':
+                        decoded = '\r';
+                        break;
+                    case 't':
+                        decoded = '\t';
+                        break;
+                    case 'u':
+                        _unicode = 0;
+                        _digits = 0;
+                        _state = State::UNICODE;
+                        continue;
+                    default:
+                        return fail();
+                }
+                text(&decoded, 1, false);
+                _state = State::STRING;
+                start = i + 1;
+                break;
+            }
+            case State::UNICODE: {
+                int digit = hex(c);
+                if (digit < 0) return fail();
+                _unicode = (_unicode << 4) | digit;
+                if (++_digits < 4) break;
+                codepoint(_unicode);
+                _state = State::STRING;
+                start = i + 1;
+                break;
+            }
+            case State::NUMBER:
+            case State::LITERAL: {
+                bool number = _state == State::NUMBER;
+                bool part = number
+                            ? (c >= '0' && c <= '9') || c == '-' || c == '+'
+                              || c == '.' || c == 'e' || c == 'E'
+                            : c >= 'a' && c <= 'z';
+                if (part) {
+                    if (_token.size() >= token) return fail();
+                    _token += c;
+                    break;
+                }
+                if (number) {
+                    _handler.on_number(_token);
+                } else if (_token == "true" || _token == "false" || _token == "null") {
+                    _handler.on_literal(_token);
+                } else {
+                    return fail();
+                }
+                _token.clear();
+                next();
+                i--;
+                break;
+            }
+            case State::DONE:
+                if (!space(c)) return fail();
+                break;
+            case State::FAILED:
+                return false;
+        }
+        if (_state == State::FAILED) return false;
+    }
+
+    if (_state == State::STRING && start < size) {
+        text(data + start, size - start, false);
+    }
+    return _state != State::FAILED;
+}
+
+bool server::web::Tokenizer::done() const {
+    return _state == State::DONE;
+}
+
+bool server::web::Tokenizer::failed() const {
+    return _state == State::FAILED;
+}
+
+bool server::web::Tokenizer::value(char c) {
+    if (c == '{' || c == '[') {
+        if (_stack.size() >= depth) return false;
+        bool array = c == '[';
+        _stack.push_back(array);
+        _handler.on_begin(array);
+        _state = array ? State::FIRST_VALUE : State::FIRST_KEY;
+    } else if (c == '"') {
+        _key = false;
+        _state = State::STRING;
+    } else if (c == '-' || (c >= '0' && c <= '9')) {
+        _token = c;
+        _state = State::NUMBER;
+    } else if (c == 't' || c == 'f' || c == 'n') {
+        _token = c;
+        _state = State::LITERAL;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void server::web::Tokenizer::next() {
+    _state = _stack.empty() ? State::DONE : State::NEXT;
+}
+
+void server::web::Tokenizer::text(const char *data, size_t size, bool last) {
+    if (_key) {
+        if (_token.size() + size > token) {
+            fail();
+            return;
+        }
+        _token.append(data, size);
+        if (!last) return;
+        _handler.on_key(_token);
+        _token.clear();
+        _key = false;
+        _state = State::COLON;
+        return;
+    }
+
+    if (size > 0 || last) _handler.on_string(data, size, last);
+    if (last) next();
+}
+
+void server::web::Tokenizer::codepoint(uint32_t point) {
+    if (point >= 0xd800 && point <= 0xdbff) {
+        _surrogate = point;
+        return;
+    }
+    if (point >= 0xdc00 && point <= 0xdfff && _surrogate) {
+        point = 0x10000 + ((_surrogate - 0xd800) << 10) + (point - 0xdc00);
+    }
+    _surrogate = 0;
+
+    char encoded[4];
+    size_t size;
+    if (point < 0x80) {
+        encoded[0] = (char) point;
+        size = 1;
+    } else if (point < 0x800) {
+        encoded[0] = (char) (0xc0 | (point >> 6));
+        encoded[1] = (char) (0x80 | (point & 0x3f));
+        size = 2;
+    } else if (point < 0x10000) {
+        encoded[0] = (char) (0xe0 | (point >> 12));
+        encoded[1] = (char) (0x80 | ((point >> 6) & 0x3f));
+        encoded[2] = (char) (0x80 | (point & 0x3f));
+        size = 3;
+    } else {
+        encoded[0] = (char) (0xf0 | (point >> 18));
+        encoded[1] = (char) (0x80 | ((point >> 12) & 0x3f));
+        encoded[2] = (char) (0x80 | ((point >> 6) & 0x3f));
+        encoded[3] = (char) (0x80 | (point & 0x3f));
+        size = 4;
+    }
+    text(encoded, size, false);
+}
+
+bool server::web::Tokenizer::fail() {
+    _state = State::FAILED;
+    return false;
+}
@@ -0,0 +1,92 @@
+#ifndef SYNCAIDE_SERVER_WEB_TOKENIZER_H
+#define SYNCAIDE_SERVER_WEB_TOKENIZER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace server {
+    namespace web {
+        // Push tokenizer for JSON arriving in arbitrary pieces. Events are
+        // reported to the handler as soon as they are recognised. String
+        // values are handed over in slices of the input and never copied.
+        // Keys, numbers and literals are small and are collected first.
+        class Tokenizer {
+        public:
+            class Handler {
+            public:
+                virtual ~Handler() = default;
+
+                virtual void on_begin(bool array) {}
+
+                virtual void on_end(bool array) {}
+
+                virtual void on_key(const string &key) {}
+
+                virtual void on_string(const char *data, size_t size, bool last) {}
+
+                virtual void on_number(const string &text) {}
+
+                virtual void on_literal(const string &text) {}
+            };
+
+        private:
+            enum class State {
+                VALUE,
+                FIRST_VALUE,
+                FIRST_KEY,
+                KEY,
+                COLON,
+                NEXT,
+                STRING,
+                ESCAPE,
+                UNICODE,
+                NUMBER,
+                LITERAL,
+                DONE,
+                FAILED
+            };
+
+            enum {
+                depth = 64,
+                token = 256
+            };
+
+        private:
+            Handler &_handler;
+            State _state;
+            bool _key;
+            vector<bool> _stack;
+            string _token;
+            uint32_t _unicode;
+            uint32_t _surrogate;
+            int _digits;
+
+        public:
+            explicit Tokenizer(Handler &handler);
+
+            void reset();
+
+            bool feed(const char *data, size_t size);
+
+            bool done() const;
+
+            bool failed() const;
+
+        private:
+            bool value(char c);
+
+            void next();
+
+            void text(const char *data, size_t size, bool last);
+
+            void codepoint(uint32_t point);
+
+            bool fail();
+        };
+    }
+}
+
+#endif //SYNCAIDE_SERVER_WEB_TOKENIZER_H
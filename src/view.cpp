@@ -1,15 +1,109 @@
 #include "logging.h"
 #include "view.h"
 
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <system_error>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+
+namespace {
+    // Snapshot layout, in host byte order since a snapshot never leaves
+    // the node that wrote it: magic, version, entry count and a checksum
+    // of the entries, then every entry as its age, the length of its
+    // address and the address itself.
+    const char magic[4] = {'S', 'Y', 'V', 'W'};
+    const uint32_t version = 1;
+    const size_t header = sizeof(magic) + 3 * sizeof(uint32_t);
+
+    uint32_t checksum(const char *data, size_t size) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ (uint8_t) data[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    template<typename Type>
+    void put(string &out, Type value) {
+        out.append((const char *) &value, sizeof(value));
+    }
+
+    template<typename Type>
+    bool get(const char *&in, const char *end, Type &value) {
+        if ((size_t) (end - in) < sizeof(value)) return false;
+        memcpy(&value, in, sizeof(value));
+        in += sizeof(value);
+        return true;
+    }
+
+    deque<Peer> decode(const char *data, size_t size) {
+        const char *in = data;
+        const char *end = data + size;
+        char found[sizeof(magic)];
+        uint32_t release = 0, count = 0, sum = 0;
+        if (size < header) return {};
+        memcpy(found, in, sizeof(found));
+        in += sizeof(found);
+        get(in, end, release);
+        get(in, end, count);
+        get(in, end, sum);
+        if (memcmp(found, magic, sizeof(magic)) || release != version) {
+            throw runtime_error("not a view snapshot.");
+        }
+        if (checksum(in, (size_t) (end - in)) != sum) {
+            throw runtime_error("view snapshot is damaged.");
+        }
+
+        deque<Peer> peers;
+        for (uint32_t i = 0; i < count; i++) {
+            int32_t age;
+            uint16_t length;
+            if (!get(in, end, age) || !get(in, end, length) ||
+                (size_t) (end - in) < length) {
+                throw runtime_error("view snapshot is damaged.");
+            }
+            peers.emplace_back(string(in, length), age);
+            in += length;
+        }
+        return peers;
+    }
+}
+
+View::View(
+    chrono::steady_clock::duration quarantine,
+    Policy policy,
+    double nearby
+) :
+    _quarantine(quarantine),
+    _policy(policy),
+    _nearby(nearby) {}
+
 Peer View::random_peer() {
-    if (!_peers.empty()) {
-        shared_lock<shared_mutex> lock(_mutex);
-        random_device rd;
-        mt19937 gen(rd());
-        uniform_int_distribution<> dis(0, (int) _peers.size() - 1);
-        int idx = dis(gen);
-        return _peers[idx];
+    shared_lock<shared_mutex> lock(_mutex);
+    random_device rd;
+    mt19937 gen(rd());
+    return pick(gen);
+}
+
+deque<Peer> View::random_peers(int num) {
+    shared_lock<shared_mutex> lock(_mutex);
+    random_device rd;
+    mt19937 gen(rd());
+    deque<Peer> picked;
+    num = min(num, (int) _peers.size());
+    for (int tries = 0; (int) picked.size() < num && tries < num * 8; tries++) {
+        auto peer = pick(gen);
+        auto search = find_if(
+            picked.begin(), picked.end(),
+            [&peer](const Peer &each) { return each.addr() == peer.addr(); }
+        );
+        if (search == picked.end()) picked.emplace_back(peer);
     }
+    return picked;
 }
 
 bool View::empty() {
@@ -32,17 +126,227 @@ deque<Peer> View::select(int c, int H) {
     unique_lock<shared_mutex> lock(_mutex);
     sort();
     shuffle(H);
+    stable_partition(_peers.begin(), _peers.end(), [this](const Peer &peer) {
+        auto search = _health.find(peer.addr());
+        return search == _health.end() || search->second.failures == 0;
+    });
     return head(c);
 }
 
 void View::update(int c, int H, int S, deque<Peer> &buffer) {
+    {
+        lock_guard<mutex> lock(_queue);
+        _pending.emplace_back(buffer);
+        if (_merging) return;
+        _merging = true;
+    }
+
+    // Whoever found no merge running applies everything queued until the
+    // queue stays empty. Should applying throw, the merge is over all the
+    // same, or every later update would only ever be queued.
+    struct Release {
+        View &view;
+        bool done = false;
+
+        ~Release() {
+            if (done) return;
+            lock_guard<mutex> lock(view._queue);
+            view._merging = false;
+        }
+    } release{*this};
+
+    for (;;) {
+        vector<deque<Peer>> batch;
+        {
+            lock_guard<mutex> lock(_queue);
+            if (_pending.empty()) {
+                _merging = false;
+                release.done = true;
+                return;
+            }
+            batch.swap(_pending);
+        }
+        merge(c, H, S, batch);
+    }
+}
+
+void View::merge(int c, int H, int S, vector<deque<Peer>> &batch) {
+    // One lock for the whole batch, but healing, swapping and aging still
+    // happen once per buffer, as if every buffer came in its own update.
+    unique_lock<shared_mutex> lock(_mutex);
+    for (auto &each : batch) {
+        deque<Peer> admitted;
+        copy_if(
+            each.begin(), each.end(), back_inserter(admitted),
+            [this](const Peer &peer) { return !quarantined(peer.addr()); }
+        );
+        append(admitted);
+        remove_duplicates();
+        // The fresh entries near peers keep handing each other would crowd
+        // out the far ones over time until regions lost touch, so they go
+        // first, along with whatever is older than healing lets entries get.
+        // When there are too few others, as within a single region, near
+        // entries still fill the view and age out like any other.
+        if (_policy == Policy::nearest) {
+            remove_near((int) _peers.size() - c, H);
+        }
+        remove_old(min(H, (int) _peers.size() - c));
+        remove_head(min(S, (int) _peers.size() - c));
+        remove_random((int) _peers.size() - c);
+        maturate();
+        forget();
+    }
+}
+
+void View::succeeded(const string &addr, chrono::steady_clock::duration rtt) {
     unique_lock<shared_mutex> lock(_mutex);
-    append(buffer);
-    remove_duplicates();
-    remove_old(min(H, (int) _peers.size() - c));
-    remove_head(min(S, (int) _peers.size() - c));
-    remove_random((int) _peers.size() - c);
-    maturate();
+    auto &health = _health[addr];
+    health.failures = 0;
+    health.quarantine = {};
+    health.rtt = health.rtt.count() ? (health.rtt * 7 + rtt) / 8 : rtt;
+    health.measured = now();
+    _probes.erase(remove(_probes.begin(), _probes.end(), addr), _probes.end());
+}
+
+bool View::failed(const string &addr) {
+    unique_lock<shared_mutex> lock(_mutex);
+    // Entries of peers cut off by a partition mostly age out of the view
+    // before they fail often enough to be suspected, so any failure is
+    // enough to have the peer probed later.
+    enlist(addr);
+    auto &health = _health[addr];
+    if (++health.failures < suspect) return false;
+
+    health.quarantine = now() + _quarantine;
+    health.rtt = {};
+    _peers.erase(
+        remove_if(_peers.begin(), _peers.end(), [&addr](const Peer &peer) {
+            return peer.addr() == addr;
+        }),
+        _peers.end()
+    );
+    return true;
+}
+
+void View::heard(const string &addr) {
+    unique_lock<shared_mutex> lock(_mutex);
+    auto search = _health.find(addr);
+    if (search == _health.end()) return;
+    search->second.failures = 0;
+    search->second.quarantine = {};
+}
+
+int View::suspicion(const string &addr) {
+    shared_lock<shared_mutex> lock(_mutex);
+    auto search = _health.find(addr);
+    return search != _health.end() ? search->second.failures : 0;
+}
+
+void View::add_probe(const string &addr) {
+    unique_lock<shared_mutex> lock(_mutex);
+    enlist(addr);
+}
+
+string View::next_probe() {
+    unique_lock<shared_mutex> lock(_mutex);
+    for (size_t i = 0; i < _probes.size(); i++) {
+        auto addr = _probes.front();
+        _probes.pop_front();
+        _probes.emplace_back(addr);
+        auto search = find_if(_peers.begin(), _peers.end(),
+            [&addr](const Peer &peer) { return peer.addr() == addr; });
+        if (search == _peers.end()) return addr;
+    }
+    return string();
+}
+
+void View::save(const string &path) {
+    string entries;
+    uint32_t count = 0;
+    {
+        shared_lock<shared_mutex> lock(_mutex);
+        for (auto &peer : _peers) {
+            auto addr = peer.addr();
+            if (addr.size() > UINT16_MAX) continue;
+            put(entries, (int32_t) peer.age());
+            put(entries, (uint16_t) addr.size());
+            entries.append(addr);
+            count++;
+        }
+    }
+
+    string data(magic, sizeof(magic));
+    put(data, version);
+    put(data, count);
+    put(data, checksum(entries.data(), entries.size()));
+    data.append(entries);
+
+    auto temporary = path + ".tmp";
+    int fd = ::open(
+        temporary.c_str(),
+        O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+        0644
+    );
+    if (fd < 0) throw system_error(errno, generic_category(), temporary);
+    for (size_t done = 0; done < data.size();) {
+        auto written = ::write(fd, data.data() + done, data.size() - done);
+        if (written < 0 && errno == EINTR) continue;
+        if (written < 0) {
+            auto error = errno;
+            ::close(fd);
+            throw system_error(error, generic_category(), temporary);
+        }
+        done += (size_t) written;
+    }
+    if (fsync(fd) < 0) {
+        auto error = errno;
+        ::close(fd);
+        throw system_error(error, generic_category(), temporary);
+    }
+    ::close(fd);
+
+    if (rename(temporary.c_str(), path.c_str()) < 0) {
+        throw system_error(errno, generic_category(), path);
+    }
+}
+
+int View::restore(int c, int H, int S, const string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0 && errno == ENOENT) return 0;
+    if (fd < 0) throw system_error(errno, generic_category(), path);
+
+    struct stat st{};
+    if (fstat(fd, &st) < 0) {
+        auto error = errno;
+        ::close(fd);
+        throw system_error(error, generic_category(), path);
+    }
+
+    auto size = (size_t) st.st_size;
+    if (size == 0) {
+        ::close(fd);
+        throw runtime_error(path + ": view snapshot is empty.");
+    }
+    auto addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    auto error = errno;
+    ::close(fd);
+    if (addr == MAP_FAILED) throw system_error(error, generic_category(), path);
+
+    deque<Peer> buffer;
+    try {
+        buffer = decode((const char *) addr, size);
+    } catch (const runtime_error &e) {
+        munmap(addr, size);
+        throw runtime_error(path + ": " + e.what());
+    }
+    munmap(addr, size);
+
+    update(c, H, S, buffer);
+    return (int) buffer.size();
+}
+
+chrono::steady_clock::time_point View::now() const {
+    return chrono::steady_clock::now();
 }
 
 void View::append(deque<Peer> &buffer) {
@@ -123,6 +427,35 @@ void View::remove_old(int qty) {
     copy(newest.begin(), newest.end(), back_inserter(_peers));
 }
 
+void View::remove_near(int qty, int age) {
+    auto limit = reach();
+    vector<size_t> near;
+    for (size_t i = 0; i < _peers.size(); i++) {
+        if (close(_peers[i].addr(), limit) || _peers[i].age() > age) {
+            near.emplace_back(i);
+        }
+    }
+
+    qty = min(qty, (int) near.size());
+    if (qty <= 0) return;
+    stable_sort(near.begin(), near.end(), [this](size_t lhs, size_t rhs) {
+        return _peers[lhs].age() > _peers[rhs].age();
+    });
+    near.resize((size_t) qty);
+    ::sort(near.begin(), near.end());
+
+    deque<Peer> kept;
+    auto removed = near.begin();
+    for (size_t i = 0; i < _peers.size(); i++) {
+        if (removed != near.end() && *removed == i) {
+            removed++;
+            continue;
+        }
+        kept.emplace_back(_peers[i]);
+    }
+    _peers.swap(kept);
+}
+
 void View::remove_head(int qty) {
     qty = (qty < 0) ? 0 : qty;
     while (!_peers.empty() && qty > 0) {
@@ -146,4 +479,112 @@ void View::maturate() {
     for (auto &peer : _peers) {
         peer.maturate();
     }
+}
+
+Peer View::pick(mt19937 &gen) const {
+    if (_policy == Policy::nearest && bernoulli_distribution(_nearby)(gen)) {
+        auto near = nearest();
+        if (!near.empty()) {
+            uniform_int_distribution<size_t> closest(0, near.size() - 1);
+            return Peer(near[closest(gen)], 0);
+        }
+    }
+
+    // The better of two random picks, which steers rounds away from peers
+    // that have been failing or are slow while every peer stays reachable.
+    // Under the nearest policy slow does not count, near peers already get
+    // their share and these picks are what keeps far ones in touch.
+    uniform_int_distribution<> dis(0, (int) _peers.size() - 1);
+    auto &first = _peers[dis(gen)];
+    auto &second = _peers[dis(gen)];
+    return healthier(second, first, _policy == Policy::random) ? second : first;
+}
+
+vector<string> View::nearest() const {
+    auto limit = reach();
+    vector<pair<chrono::steady_clock::duration, const string *>> known;
+    for (auto &[addr, health] : _health) {
+        if (close(addr, limit)) known.emplace_back(health.rtt, &addr);
+    }
+
+    auto num = min((size_t) candidates, known.size());
+    partial_sort(known.begin(), known.begin() + num, known.end());
+    vector<string> closest;
+    for (size_t i = 0; i < num; i++) closest.emplace_back(*known[i].second);
+    return closest;
+}
+
+chrono::steady_clock::duration View::reach() const {
+    // Peers measured lately count whether still in the view or not, the
+    // entries come and go far faster than the distances between nodes
+    // change. Near is about as close as the closest, so a far away peer
+    // measured early on does not pass for near.
+    chrono::steady_clock::duration closest{0};
+    if (_policy != Policy::nearest) return closest;
+    for (auto &[ignored, health] : _health) {
+        if (!health.rtt.count() || health.failures) continue;
+        if (!closest.count() || health.rtt < closest) closest = health.rtt;
+    }
+    return closest * 2;
+}
+
+bool View::close(
+    const string &addr,
+    chrono::steady_clock::duration limit
+) const {
+    auto search = _health.find(addr);
+    if (search == _health.end()) return false;
+    auto &health = search->second;
+    return health.rtt.count() && !health.failures && health.rtt <= limit;
+}
+
+bool View::healthier(const Peer &lhs, const Peer &rhs, bool timed) const {
+    // Peers nothing is known about yet count as healthy, with a round trip
+    // that compares to none.
+    static const Health unknown;
+    auto lookup = [this](const Peer &peer) -> const Health & {
+        auto search = _health.find(peer.addr());
+        return search != _health.end() ? search->second : unknown;
+    };
+
+    auto &left = lookup(lhs);
+    auto &right = lookup(rhs);
+    if (left.failures != right.failures) return left.failures < right.failures;
+    if (!timed || !left.rtt.count() || !right.rtt.count()) return false;
+    return left.rtt < right.rtt;
+}
+
+bool View::quarantined(const string &addr) const {
+    auto search = _health.find(addr);
+    return search != _health.end() &&
+           search->second.quarantine > now();
+}
+
+void View::enlist(const string &addr) {
+    _probes.erase(remove(_probes.begin(), _probes.end(), addr), _probes.end());
+    _probes.emplace_back(addr);
+    if (_probes.size() > probes) _probes.pop_front();
+}
+
+void View::forget() {
+    // Only peers still in the view or still serving a quarantine are worth
+    // remembering everything about, of the others at most a recent round
+    // trip to find near peers by.
+    unordered_set<string> present;
+    for (auto &peer : _peers) present.emplace(peer.addr());
+
+    auto current = now();
+    auto expired = current - chrono::seconds(remembered);
+    for (auto it = _health.begin(); it != _health.end();) {
+        auto &health = it->second;
+        if (present.count(it->first) || health.quarantine > current) {
+            it++;
+        } else if (_policy == Policy::nearest && health.rtt.count() &&
+                   health.measured > expired) {
+            health.failures = 0;
+            it++;
+        } else {
+            it = _health.erase(it);
+        }
+    }
 }
\ No newline at end of file
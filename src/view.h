@@ -15,18 +15,81 @@
 #include <shared_mutex>
 #include <list>
 #include <unordered_map>
+#include <unordered_set>
 #include <queue>
+#include <vector>
+#include <chrono>
 
 using namespace std;
 
 class View {
+    enum {
+        // Exchanges in a row that have to fail before a peer is suspected
+        // dead and dropped from the view.
+        suspect = 2,
+        // Closest peers a pick going by round trip chooses among.
+        candidates = 4,
+        // Seconds a round trip is remembered for once it was last measured.
+        remembered = 600,
+        // Addresses kept to probe outside the view.
+        probes = 16
+    };
+
+public:
+    // How gossip targets are picked. Random takes the healthier of two
+    // random peers. Nearest goes to one of the closest peers measured for
+    // the given share of the picks and to a random one for the rest. Near
+    // entries are then the first to leave a full view, which holds on to
+    // the links to far away peers the overlay needs to stay in one piece.
+    enum class Policy {
+        random,
+        nearest
+    };
+
 private:
+    // What this node saw of its own exchanges with a peer. Unlike the age
+    // it is never gossiped, so it is kept apart from the entries.
+    struct Health {
+        int failures = 0;
+        // Smoothed round trip of the exchanges that went through. Under the
+        // nearest policy it stays known for a while after the peer left the
+        // view, entries come and go far faster than distances change.
+        chrono::steady_clock::duration rtt{0};
+        chrono::steady_clock::time_point measured{};
+        // Entries others gossip about a suspected peer are ignored until
+        // then, unless the peer turns up by itself.
+        chrono::steady_clock::time_point quarantine{};
+    };
+
     mutable shared_mutex _mutex;
     deque<Peer> _peers;
+    unordered_map<string, Health> _health;
+    chrono::steady_clock::duration _quarantine;
+    Policy _policy;
+    double _nearby;
+    // Peers that failed and joins, tried now and then so that links cut by
+    // a partition come back once it heals.
+    deque<string> _probes;
+
+    // Buffers waiting to be merged by whichever update is running.
+    mutex _queue;
+    vector<deque<Peer>> _pending;
+    bool _merging = false;
 
 public:
+    explicit View(
+        chrono::steady_clock::duration quarantine = chrono::seconds(30),
+        Policy policy = Policy::random,
+        double nearby = 0.75
+    );
+
+    virtual ~View() = default;
+
     Peer random_peer();
 
+    // Up to num different peers, picked the way random_peer picks one.
+    deque<Peer> random_peers(int num);
+
     bool empty();
 
     int size();
@@ -35,9 +98,43 @@ public:
 
     deque<Peer> select(int c, int H);
 
+    // Updates arriving while another one is being applied are merged into
+    // it rather than each rebuilding the view, so the call can return
+    // before its own buffer has been applied.
     void update(int c, int H, int S, deque<Peer> &buffer);
 
+    void succeeded(const string &addr, chrono::steady_clock::duration rtt);
+
+    // Returns true when this failure got the peer suspected and removed.
+    bool failed(const string &addr);
+
+    // The peer started an exchange itself, which clears any suspicion.
+    void heard(const string &addr);
+
+    int suspicion(const string &addr);
+
+    // Peers that failed an exchange are added by failed(), an address is let
+    // go once the peer answered or when it is the oldest of too many.
+    void add_probe(const string &addr);
+
+    // The next address to probe that is not in the view, if any.
+    string next_probe();
+
+    // Writes the entries to a temporary file next to path and renames it
+    // over path, so a crash never leaves half a snapshot behind.
+    void save(const string &path);
+
+    // Updates the view with the entries of a snapshot written by save and
+    // returns how many there were, none when there is no snapshot yet.
+    int restore(int c, int H, int S, const string &path);
+
 protected:
+    // Time quarantines are measured in, simulations run on their own.
+    virtual chrono::steady_clock::time_point now() const;
+
+    // Applies the buffers one after the other under a single lock.
+    void merge(int c, int H, int S, vector<deque<Peer>> &batch);
+
     void append(deque<Peer> &buffer);
 
     void sort();
@@ -50,11 +147,35 @@ protected:
 
     void remove_old(int qty);
 
+    // Drops up to qty of the entries that are near or older than age,
+    // oldest first.
+    void remove_near(int qty, int age);
+
     void remove_head(int qty);
 
     void remove_random(int qty);
 
     void maturate();
+
+    Peer pick(mt19937 &gen) const;
+
+    // The few closest of the near peers, which the nearest policy picks
+    // from by round trip, whether they are in the view or not.
+    vector<string> nearest() const;
+
+    // Round trip up to which a peer is near, zero under the random policy.
+    chrono::steady_clock::duration reach() const;
+
+    // Whether the peer is healthy and measured within the limit.
+    bool close(const string &addr, chrono::steady_clock::duration limit) const;
+
+    bool healthier(const Peer &lhs, const Peer &rhs, bool timed) const;
+
+    bool quarantined(const string &addr) const;
+
+    void enlist(const string &addr);
+
+    void forget();
 };
 
 #endif //SYNCAIDE_VIEW_H
\ No newline at end of file
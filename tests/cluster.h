@@ -0,0 +1,157 @@
+#ifndef SYNCAIDE_TESTS_CLUSTER_H
+#define SYNCAIDE_TESTS_CLUSTER_H
+
+#include "rpc/services/templates.h"
+#include "server/distributor.h"
+#include "server/template.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <grpc++/grpc++.h>
+#include <fmt/format.h>
+#include <condition_variable>
+#include <unistd.h>
+#include <memory>
+#include <thread>
+#include <string>
+#include <vector>
+#include <mutex>
+
+using namespace std;
+
+// Several template distribution nodes in one process, each with its own
+// gRPC server on a unix socket and its own io_context. Node i knows the
+// `fanout` nodes following it on a ring, so anything that reaches every
+// node had to be relayed. Deliveries are timestamped for latency figures.
+class Cluster {
+    using work_guard = boost::asio::executor_work_guard<
+        boost::asio::io_context::executor_type
+    >;
+
+public:
+    struct Node {
+        string addr;
+        boost::asio::io_context ioc;
+        unique_ptr<work_guard> work;
+        thread runner;
+        shared_ptr<server::Distributor> distributor;
+        unique_ptr<rpc::services::TemplatesService> service;
+        unique_ptr<grpc::Server> rpc;
+        vector<pair<uint64_t, chrono::steady_clock::time_point>> arrivals;
+    };
+
+private:
+    mutex _mutex;
+    condition_variable _cv;
+    vector<unique_ptr<Node>> _nodes;
+
+public:
+    Cluster(size_t size, size_t fanout) {
+        for (size_t i = 0; i < size; i++) {
+            auto node = make_unique<Node>();
+            node->addr = fmt::format("unix:/tmp/syncaide-cluster-{}-{}", getpid(), i);
+            _nodes.emplace_back(move(node));
+        }
+
+        for (size_t i = 0; i < size; i++) {
+            auto &node = *_nodes[i];
+            vector<string> targets;
+            for (size_t j = 1; j <= fanout && j < size; j++) {
+                targets.emplace_back(_nodes[(i + j) % size]->addr);
+            }
+
+            node.distributor = make_shared<server::Distributor>(
+                node.ioc,
+                node.addr,
+                [targets] { return targets; },
+                [this, &node](shared_ptr<const server::Template> block) {
+                    lock_guard<mutex> lock(_mutex);
+                    node.arrivals.emplace_back(block->height(), chrono::steady_clock::now());
+                    _cv.notify_all();
+                }
+            );
+            node.service = make_unique<rpc::services::TemplatesService>(node.distributor);
+
+            grpc::ServerBuilder builder;
+            builder.AddListeningPort(node.addr, grpc::InsecureServerCredentials());
+            builder.RegisterService(node.service.get());
+            node.rpc = builder.BuildAndStart();
+
+            node.work = make_unique<work_guard>(node.ioc.get_executor());
+            node.runner = thread([&node] { node.ioc.run(); });
+        }
+    }
+
+    ~Cluster() {
+        for (auto &node : _nodes) {
+            node->rpc->Shutdown();
+            node->work.reset();
+            node->ioc.stop();
+            node->runner.join();
+            unlink(node->addr.substr(5).c_str());
+        }
+    }
+
+    size_t size() const {
+        return _nodes.size();
+    }
+
+    Node &node(size_t index) {
+        return *_nodes.at(index);
+    }
+
+    // Number of nodes that have received a template at the given height.
+    size_t reached(uint64_t height) {
+        lock_guard<mutex> lock(_mutex);
+        return count(height);
+    }
+
+    bool wait(uint64_t height, size_t nodes, chrono::milliseconds timeout) {
+        unique_lock<mutex> lock(_mutex);
+        return _cv.wait_for(lock, timeout, [this, height, nodes] {
+            return count(height) >= nodes;
+        });
+    }
+
+    // Time from `sent` to the first arrival at the given height on each
+    // node that has one.
+    vector<chrono::steady_clock::duration> latencies(
+        uint64_t height,
+        chrono::steady_clock::time_point sent
+    ) {
+        lock_guard<mutex> lock(_mutex);
+        vector<chrono::steady_clock::duration> out;
+        for (auto &node : _nodes) {
+            for (auto &arrival : node->arrivals) {
+                if (arrival.first != height) continue;
+                out.emplace_back(arrival.second - sent);
+                break;
+            }
+        }
+        return out;
+    }
+
+    size_t deliveries(size_t index, uint64_t height) {
+        lock_guard<mutex> lock(_mutex);
+        size_t total = 0;
+        for (auto &arrival : _nodes.at(index)->arrivals) {
+            if (arrival.first == height) total++;
+        }
+        return total;
+    }
+
+private:
+    size_t count(uint64_t height) {
+        size_t total = 0;
+        for (auto &node : _nodes) {
+            for (auto &arrival : node->arrivals) {
+                if (arrival.first != height) continue;
+                total++;
+                break;
+            }
+        }
+        return total;
+    }
+};
+
+#endif //SYNCAIDE_TESTS_CLUSTER_H
@@ -0,0 +1,307 @@
+#ifndef SYNCAIDE_TESTS_DAEMON_H
+#define SYNCAIDE_TESTS_DAEMON_H
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <nlohmann/json.hpp>
+#include <fmt/format.h>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <string>
+#include <vector>
+#include <mutex>
+
+using namespace std;
+
+// Stand-in for the cryptocurrency daemon. It answers get_info and
+// getblocktemplate over HTTP JSON-RPC and publishes chain notifications to
+// ZMTP subscribers, both on ephemeral localhost ports. Every publish()
+// advances the chain by one block.
+class Daemon {
+    using tcp = boost::asio::ip::tcp;
+    using json = nlohmann::json;
+    using error_code = boost::system::error_code;
+
+private:
+    boost::asio::io_context _ioc;
+    tcp::acceptor _rpc;
+    tcp::acceptor _pub;
+    mutex _mutex;
+    condition_variable _cv;
+    thread _acceptors[2];
+    vector<thread> _threads;
+    vector<shared_ptr<tcp::socket>> _sockets;
+    vector<shared_ptr<tcp::socket>> _subscribers;
+    atomic<uint64_t> _height{1};
+    atomic<uint64_t> _requests{0};
+    atomic<uint64_t> _connections{0};
+    atomic<int64_t> _delay{0};
+    atomic<bool> _stopped{false};
+
+public:
+    Daemon() :
+        _rpc(_ioc, tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0)),
+        _pub(_ioc, tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0)) {
+        _acceptors[0] = thread([this] { accept(_rpc, &Daemon::serve); });
+        _acceptors[1] = thread([this] { accept(_pub, &Daemon::subscribe); });
+    }
+
+    ~Daemon() {
+        _stopped = true;
+
+        // A blocking accept is not interrupted by closing the acceptor, so
+        // each one is woken with a throwaway connection first.
+        error_code code;
+        for (auto port : {rpc_port(), pub_port()}) {
+            tcp::socket waker(_ioc);
+            waker.connect({boost::asio::ip::make_address("127.0.0.1"), port}, code);
+        }
+        _acceptors[0].join();
+        _acceptors[1].join();
+        _rpc.close(code);
+        _pub.close(code);
+
+        for (auto &socket : _sockets) {
+            socket->shutdown(tcp::socket::shutdown_both, code);
+            socket->close(code);
+        }
+        for (auto &each : _threads) each.join();
+    }
+
+    uint16_t rpc_port() const {
+        return _rpc.local_endpoint().port();
+    }
+
+    uint16_t pub_port() const {
+        return _pub.local_endpoint().port();
+    }
+
+    uint64_t height() const {
+        return _height;
+    }
+
+    uint64_t requests() const {
+        return _requests;
+    }
+
+    // JSON-RPC connections accepted so far.
+    uint64_t connections() const {
+        return _connections;
+    }
+
+    // Closes every open connection from the daemon's side, the way a
+    // daemon drops keep-alive connections that sat idle for too long.
+    void drop() {
+        lock_guard<mutex> lock(_mutex);
+        for (auto &socket : _sockets) {
+            error_code code;
+            socket->shutdown(tcp::socket::shutdown_both, code);
+        }
+    }
+
+    // Holds every reply back by the given time, standing in for a daemon
+    // that is busy or far away.
+    void delay(chrono::milliseconds delay) {
+        _delay = delay.count();
+    }
+
+    bool wait_subscribers(size_t count, chrono::milliseconds timeout) {
+        unique_lock<mutex> lock(_mutex);
+        return _cv.wait_for(lock, timeout, [this, count] {
+            return _subscribers.size() >= count;
+        });
+    }
+
+    void publish() {
+        uint64_t height = ++_height;
+        string body = "json-minimal-chain_main:" + json{
+            {"first_height", height},
+            {"first_prev_id", hash(height - 1)},
+            {"ids", {hash(height)}}
+        }.dump();
+        string frame = header(0x00, body.size()) + body;
+
+        lock_guard<mutex> lock(_mutex);
+        for (auto &socket : _subscribers) {
+            error_code code;
+            boost::asio::write(*socket, boost::asio::buffer(frame), code);
+        }
+    }
+
+    static string hash(uint64_t height) {
+        return fmt::format("{:064x}", height);
+    }
+
+    // Monero block template blob for the given height: header, a coinbase
+    // transaction with a 60 byte reserved nonce in its extra, and the hashes
+    // of the transactions in the block.
+    static string blob(uint64_t height, const vector<string> &txs = {}) {
+        string out;
+        auto varint = [&out](uint64_t value) {
+            while (value >= 0x80) {
+                out += fmt::format("{:02x}", (value & 0x7f) | 0x80);
+                value >>= 7;
+            }
+            out += fmt::format("{:02x}", value);
+        };
+
+        varint(14);
+        varint(14);
+        varint(1500000000 + height);
+        out += hash(height - 1);
+        out += "00000000";
+
+        varint(2);
+        varint(height + 60);
+        varint(1);
+        out += "ff";
+        varint(height);
+        varint(1);
+        varint(600000000000);
+        out += "02";
+        out += string(64, 'a');
+        varint(1 + 32 + 2 + 60);
+        out += "01" + string(64, 'b');
+        out += "023c" + string(120, '0');
+        out += "00";
+
+        varint(txs.size());
+        for (auto &tx : txs) out += tx;
+        return out;
+    }
+
+private:
+    static string header(unsigned char flags, size_t size) {
+        string out;
+        if (size > 255) {
+            out += (char) (flags | 0x02);
+            for (int i = 7; i >= 0; i--) out += (char) ((size >> (i * 8)) & 0xff);
+        } else {
+            out += (char) flags;
+            out += (char) size;
+        }
+        return out;
+    }
+
+    void accept(tcp::acceptor &acceptor, void (Daemon::*fn)(shared_ptr<tcp::socket>)) {
+        while (!_stopped) {
+            auto socket = make_shared<tcp::socket>(_ioc);
+            error_code code;
+            acceptor.accept(*socket, code);
+            if (code || _stopped) return;
+            if (&acceptor == &_rpc) _connections++;
+
+            lock_guard<mutex> lock(_mutex);
+            _sockets.emplace_back(socket);
+            _threads.emplace_back([this, fn, socket] { (this->*fn)(socket); });
+        }
+    }
+
+    json reply(const json &call) {
+        _requests++;
+        auto method = call.value("method", string());
+        json result;
+        if (method == "get_info") {
+            result = {{"height", height()}, {"status", "OK"}};
+        } else if (method == "getblocktemplate") {
+            uint64_t current = height();
+            result = {
+                {"blocktemplate_blob", blob(current)},
+                {"blockhashing_blob", string(152, '0')},
+                {"difficulty", 1000},
+                {"expected_reward", 600000000000},
+                {"height", current},
+                {"prev_hash", hash(current - 1)},
+                {"reserved_offset", 130},
+                {"seed_hash", hash(0)},
+                {"status", "OK"}
+            };
+        } else {
+            return {
+                {"id", call.value("id", json())},
+                {"jsonrpc", "2.0"},
+                {"error", {{"code", -32601}, {"message", "Method not found"}}}
+            };
+        }
+        return {
+            {"id", call.value("id", json())},
+            {"jsonrpc", "2.0"},
+            {"result", result}
+        };
+    }
+
+    void serve(shared_ptr<tcp::socket> socket) {
+        namespace http = boost::beast::http;
+        boost::beast::flat_buffer buffer;
+        while (!_stopped) {
+            error_code code;
+            http::request<http::string_body> req;
+            http::read(*socket, buffer, req, code);
+            if (code) return;
+
+            if (_delay > 0) this_thread::sleep_for(chrono::milliseconds(_delay));
+
+            json call = json::parse(req.body(), nullptr, false);
+            json answer;
+            if (call.is_array()) {
+                answer = json::array();
+                for (auto &each : call) answer.emplace_back(reply(each));
+            } else {
+                answer = reply(call);
+            }
+
+            http::response<http::string_body> res{http::status::ok, req.version()};
+            res.set(http::field::content_type, "application/json");
+            res.keep_alive(req.keep_alive());
+            res.body() = answer.dump();
+            res.prepare_payload();
+            http::write(*socket, res, code);
+            if (code || !res.keep_alive()) return;
+        }
+    }
+
+    void subscribe(shared_ptr<tcp::socket> socket) {
+        error_code code;
+        string greeting(64, '\0');
+        greeting[0] = '\xff';
+        greeting[9] = '\x7f';
+        greeting[10] = '\x03';
+        greeting.replace(12, 4, "NULL");
+        string ready = string("\x05") + "READY"
+                       + string("\x0b") + "Socket-Type"
+                       + string("\x00\x00\x00\x03", 4) + "PUB";
+        string outgoing = greeting + header(0x04, ready.size()) + ready;
+        boost::asio::write(*socket, boost::asio::buffer(outgoing), code);
+        if (code) return;
+
+        string incoming(64, '\0');
+        boost::asio::read(*socket, boost::asio::buffer(&incoming[0], 64), code);
+        if (code) return;
+
+        // Frames up to and including the subscription message.
+        for (;;) {
+            unsigned char head[2];
+            boost::asio::read(*socket, boost::asio::buffer(head, 2), code);
+            if (code) return;
+
+            string body(head[1], '\0');
+            if (!body.empty()) {
+                boost::asio::read(*socket, boost::asio::buffer(&body[0], body.size()), code);
+                if (code) return;
+            }
+            if (!(head[0] & 0x04) && !body.empty() && body[0] == '\x01') break;
+        }
+
+        lock_guard<mutex> lock(_mutex);
+        _subscribers.emplace_back(socket);
+        _cv.notify_all();
+    }
+};
+
+#endif //SYNCAIDE_TESTS_DAEMON_H
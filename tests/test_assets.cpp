@@ -0,0 +1,135 @@
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_MODULE test_assets
+
+#include <boost/test/unit_test.hpp>
+
+#include "server/assets.h"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <string>
+
+using server::Assets;
+namespace fs = boost::filesystem;
+
+// Stands in for the index the embedder generates for syncaided.
+namespace resources {
+    constexpr Resource index[] = {
+        {"syncaide.js", "built in", "digest"},
+    };
+
+    constexpr size_t count = sizeof(index) / sizeof(Resource);
+
+    const Resource *find(string_view name) {
+        for (size_t i = 0; i < count; i++) {
+            if (index[i].name == name) return &index[i];
+        }
+        return nullptr;
+    }
+}
+
+struct Directory {
+    fs::path path;
+
+    Directory() : path(fs::temp_directory_path() / fs::unique_path()) {
+        fs::create_directories(path);
+    }
+
+    ~Directory() {
+        fs::remove_all(path);
+    }
+
+    // Writes next to the target and renames over it, the way a release is
+    // expected to replace files.
+    void put(const string &name, const string &data) const {
+        auto temporary = path / ("." + name);
+        ofstream(temporary.string(), ios::binary) << data;
+        fs::rename(temporary, path / name);
+    }
+};
+
+BOOST_AUTO_TEST_CASE(built_in) { // NOLINT
+    Assets assets;
+    BOOST_CHECK(!assets.enabled());
+    BOOST_CHECK(!assets.reload());
+
+    auto asset = assets.find("syncaide.js");
+    BOOST_REQUIRE(asset);
+    BOOST_CHECK_EQUAL(asset->data, "built in");
+    BOOST_CHECK(!assets.find("syncaide.wasm"));
+}
+
+BOOST_AUTO_TEST_CASE(directory) { // NOLINT
+    Directory dir;
+    dir.put("syncaide.wasm", "wasm");
+
+    Assets assets(dir.path.string());
+    auto asset = assets.find("syncaide.wasm");
+    BOOST_REQUIRE(asset);
+    BOOST_CHECK_EQUAL(asset->data, "wasm");
+    BOOST_CHECK_EQUAL(
+        asset->digest,
+        "336154bf67f765f8f75d16a0accee61b5ee5f6a75b2a2905703df913bd550f3e"
+    );
+
+    // Files the directory lacks still come from the binary.
+    auto js = assets.find("syncaide.js");
+    BOOST_REQUIRE(js);
+    BOOST_CHECK_EQUAL(js->data, "built in");
+}
+
+BOOST_AUTO_TEST_CASE(reload) { // NOLINT
+    Directory dir;
+    dir.put("syncaide.wasm", "old");
+
+    Assets assets(dir.path.string());
+    auto before = assets.find("syncaide.wasm");
+    BOOST_CHECK(!assets.reload());
+
+    // A change is only taken once it has held still for a whole check.
+    dir.put("syncaide.wasm", "new");
+    BOOST_CHECK(!assets.reload());
+    BOOST_CHECK_EQUAL(assets.find("syncaide.wasm")->data, "old");
+    BOOST_CHECK(assets.reload());
+    BOOST_CHECK_EQUAL(assets.find("syncaide.wasm")->data, "new");
+    BOOST_CHECK(!assets.reload());
+
+    // Whoever still holds the previous bundle keeps reading it intact.
+    BOOST_CHECK_EQUAL(before->data, "old");
+}
+
+BOOST_AUTO_TEST_CASE(overwritten) { // NOLINT
+    Directory dir;
+    dir.put("syncaide.wasm", "original");
+
+    Assets assets(dir.path.string());
+    auto before = assets.find("syncaide.wasm");
+
+    // Truncated and written over under the same inode instead of renamed.
+    ofstream(
+        (dir.path / "syncaide.wasm").string(),
+        ios::binary | ios::trunc
+    ) << "new";
+    BOOST_CHECK_EQUAL(before->data, "original");
+
+    BOOST_CHECK(!assets.reload());
+    BOOST_CHECK(assets.reload());
+    BOOST_CHECK_EQUAL(assets.find("syncaide.wasm")->data, "new");
+    BOOST_CHECK_EQUAL(before->data, "original");
+}
+
+BOOST_AUTO_TEST_CASE(unsettled) { // NOLINT
+    Directory dir;
+    dir.put("syncaide.wasm", "first");
+
+    Assets assets(dir.path.string());
+    dir.put("syncaide.wasm", "second");
+    BOOST_CHECK(!assets.reload());
+    dir.put("syncaide.wasm", "third");
+    BOOST_CHECK(!assets.reload());
+    BOOST_CHECK(assets.reload());
+    BOOST_CHECK_EQUAL(assets.find("syncaide.wasm")->data, "third");
+}
+
+#pragma clang diagnostic pop
@@ -0,0 +1,182 @@
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_MODULE test_balancer
+
+#include <boost/test/unit_test.hpp>
+
+#include "server/web/balancer.h"
+#include "daemon.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/beast/http.hpp>
+#include <fmt/format.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+using server::web::Balancer;
+using common::Uri;
+namespace http = boost::beast::http;
+
+static http::request<http::string_body> call(const string &method) {
+    http::request<http::string_body> req;
+    req.method(http::verb::post);
+    req.target("/json_rpc");
+    req.body() = nlohmann::json{
+        {"jsonrpc", "2.0"},
+        {"id", "0"},
+        {"method", method}
+    }.dump();
+    req.prepare_payload();
+    return req;
+}
+
+static Uri uri(uint16_t port) {
+    return Uri(fmt::format("http://127.0.0.1:{}", port));
+}
+
+static uint16_t closed_port() {
+    boost::asio::io_context ioc;
+    boost::asio::ip::tcp::acceptor acceptor(ioc,
+        {boost::asio::ip::make_address("127.0.0.1"), 0});
+    return acceptor.local_endpoint().port();
+}
+
+// Issues `count` requests one after another and returns how many succeeded.
+static size_t sequence(
+    boost::asio::io_context &ioc,
+    shared_ptr<Balancer> balancer,
+    size_t count,
+    Balancer::Policy policy = Balancer::Policy::SINGLE
+) {
+    size_t succeeded = 0, issued = 0;
+    function<void()> next = [&] {
+        if (issued++ == count) return ioc.stop();
+        balancer->request(call("get_info"), nullptr, [&](auto &res) {
+            succeeded++;
+            next();
+        }, [&](const string &msg, boost::system::error_code code) {
+            next();
+        }, policy);
+    };
+    ioc.restart();
+    boost::asio::post(ioc, next);
+    ioc.run_for(chrono::seconds(20));
+    return succeeded;
+}
+
+BOOST_AUTO_TEST_CASE(prefers_faster) { // NOLINT
+    Daemon slow, fast;
+    slow.delay(chrono::milliseconds(20));
+
+    boost::asio::io_context ioc;
+    auto balancer = make_shared<Balancer>(
+        ioc,
+        vector<Uri>{uri(slow.rpc_port()), uri(fast.rpc_port())},
+        1, 1, chrono::milliseconds(1000)
+    );
+    balancer->run();
+
+    BOOST_TEST(sequence(ioc, balancer, 20) == 20);
+    BOOST_TEST(balancer->latency(0) > balancer->latency(1));
+    BOOST_TEST(slow.requests() <= 2);
+    BOOST_TEST(fast.requests() >= 18);
+    balancer->stop();
+}
+
+BOOST_AUTO_TEST_CASE(hedged) { // NOLINT
+    Daemon stalled, spare;
+    stalled.delay(chrono::milliseconds(1500));
+
+    boost::asio::io_context ioc;
+    auto balancer = make_shared<Balancer>(
+        ioc,
+        vector<Uri>{uri(stalled.rpc_port()), uri(spare.rpc_port())},
+        1, 1, chrono::milliseconds(50)
+    );
+    balancer->run();
+
+    auto started = chrono::steady_clock::now();
+    BOOST_TEST(sequence(ioc, balancer, 1, Balancer::Policy::HEDGED) == 1);
+    auto elapsed = chrono::steady_clock::now() - started;
+    BOOST_TEST((elapsed < chrono::milliseconds(1000)));
+    BOOST_TEST(spare.requests() == 1);
+    balancer->stop();
+}
+
+BOOST_AUTO_TEST_CASE(deadline) { // NOLINT
+    Daemon silent, spare;
+    silent.delay(chrono::milliseconds(3000));
+
+    boost::asio::io_context ioc;
+    auto balancer = make_shared<Balancer>(
+        ioc,
+        vector<Uri>{uri(silent.rpc_port()), uri(spare.rpc_port())},
+        1, 1, chrono::milliseconds(1000), chrono::milliseconds(200)
+    );
+    balancer->run();
+
+    // A daemon that takes the request and never answers is given up on
+    // once the deadline has passed.
+    auto started = chrono::steady_clock::now();
+    BOOST_TEST(sequence(ioc, balancer, 1) == 1);
+    auto elapsed = chrono::steady_clock::now() - started;
+    BOOST_TEST((elapsed < chrono::milliseconds(1000)));
+    BOOST_TEST(spare.requests() == 1);
+    balancer->stop();
+}
+
+BOOST_AUTO_TEST_CASE(longpoll_deadline) { // NOLINT
+    Daemon holding;
+    holding.delay(chrono::milliseconds(1000));
+
+    boost::asio::io_context ioc;
+    auto balancer = make_shared<Balancer>(
+        ioc,
+        vector<Uri>{uri(holding.rpc_port())},
+        1, 1, chrono::milliseconds(1000), chrono::milliseconds(100),
+        chrono::milliseconds(200)
+    );
+    balancer->run();
+
+    // Long-polls that run out of time fail, but the daemon is not
+    // sidelined for holding them.
+    BOOST_TEST(sequence(ioc, balancer, 3, Balancer::Policy::LONGPOLL) == 0);
+    BOOST_TEST(balancer->available() == 1);
+    balancer->stop();
+}
+
+BOOST_AUTO_TEST_CASE(circuit_breaker) { // NOLINT
+    Daemon healthy;
+
+    boost::asio::io_context ioc;
+    auto balancer = make_shared<Balancer>(
+        ioc,
+        vector<Uri>{uri(closed_port()), uri(healthy.rpc_port())},
+        1, 1, chrono::milliseconds(1000)
+    );
+    balancer->run();
+
+    // Every request fails over to the healthy daemon until the dead one has
+    // failed often enough to be sidelined.
+    BOOST_TEST(sequence(ioc, balancer, 10) == 10);
+    BOOST_TEST(balancer->available() == 1);
+    BOOST_TEST(healthy.requests() == 10);
+    balancer->stop();
+}
+
+BOOST_AUTO_TEST_CASE(all_down) { // NOLINT
+    boost::asio::io_context ioc;
+    auto balancer = make_shared<Balancer>(
+        ioc,
+        vector<Uri>{uri(closed_port()), uri(closed_port())},
+        1, 1, chrono::milliseconds(1000)
+    );
+    balancer->run();
+
+    BOOST_TEST(sequence(ioc, balancer, 5) == 0);
+    BOOST_TEST(balancer->available() == 0);
+    balancer->stop();
+}
+
+#pragma clang diagnostic pop
@@ -0,0 +1,125 @@
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_MODULE test_batch
+
+#include <boost/test/unit_test.hpp>
+
+#include "server/web/batch.h"
+#include "server/template.h"
+#include "daemon.h"
+
+#include <nlohmann/json.hpp>
+#include <memory>
+#include <string>
+
+using server::Template;
+using server::web::Batch;
+using server::web::Reply;
+using nlohmann::json;
+
+static json reply(const string &id, const json &result) {
+    return {{"id", id}, {"jsonrpc", "2.0"}, {"result", result}};
+}
+
+static json block(uint64_t height) {
+    return {
+        {"blocktemplate_blob", Daemon::blob(height)},
+        {"difficulty", 1000},
+        {"expected_reward", 600000000000},
+        {"height", height},
+        {"prev_hash", Daemon::hash(height - 1)},
+        {"reserved_offset", 130},
+        {"seed_hash", Daemon::hash(0)},
+        {"status", "OK"}
+    };
+}
+
+static shared_ptr<Batch> stream(const string &text, size_t chunk) {
+    auto batch = make_shared<Batch>();
+    batch->add("get_info", make_shared<Reply>());
+    batch->add("getblocktemplate", make_shared<Template::Reader>());
+    batch->reset();
+    for (size_t i = 0; i < text.size(); i += chunk) {
+        batch->write(text.data() + i, min(chunk, text.size() - i));
+    }
+    batch->finish();
+    return batch;
+}
+
+BOOST_AUTO_TEST_CASE(elements) { // NOLINT
+    auto text = json::array({
+        reply("get_info", {{"height", 42}, {"status", "OK"}}),
+        reply("getblocktemplate", block(42))
+    }).dump();
+
+    for (size_t chunk : {size_t(1), size_t(7), text.size()}) {
+        auto batch = stream(text, chunk);
+        BOOST_TEST(batch->supported());
+
+        auto info = static_pointer_cast<Reply>(batch->element(0));
+        BOOST_TEST(info->error().empty());
+        BOOST_TEST(info->result("height") == "42");
+
+        auto reader = static_pointer_cast<Template::Reader>(batch->element(1));
+        BOOST_TEST(reader->error().empty());
+        BOOST_TEST(reader->result()->height() == 42);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(element_error) { // NOLINT
+    auto text = json::array({
+        reply("get_info", {{"height", 42}}),
+        {
+            {"id", "getblocktemplate"},
+            {"jsonrpc", "2.0"},
+            {"error", {{"code", -9}, {"message", "Core is busy"}}}
+        }
+    }).dump();
+
+    auto batch = stream(text, 5);
+    BOOST_TEST(batch->supported());
+    BOOST_TEST(static_pointer_cast<Reply>(batch->element(0))->error().empty());
+    auto reader = static_pointer_cast<Template::Reader>(batch->element(1));
+    BOOST_TEST(reader->error() == "Core is busy");
+}
+
+BOOST_AUTO_TEST_CASE(unsupported) { // NOLINT
+    auto text = json{
+        {"id", nullptr},
+        {"jsonrpc", "2.0"},
+        {"error", {{"code", -32600}, {"message", "Invalid Request"}}}
+    }.dump();
+
+    auto batch = stream(text, 3);
+    BOOST_TEST(!batch->supported());
+    BOOST_TEST(!static_pointer_cast<Reply>(batch->element(0))->error().empty());
+    BOOST_TEST(!static_pointer_cast<Template::Reader>(batch->element(1))->error().empty());
+}
+
+BOOST_AUTO_TEST_CASE(reordered) { // NOLINT
+    auto text = json::array({
+        reply("getblocktemplate", block(42)),
+        reply("get_info", {{"height", 42}})
+    }).dump();
+
+    auto batch = stream(text, 11);
+    BOOST_TEST(!batch->supported());
+    BOOST_TEST(!static_pointer_cast<Reply>(batch->element(0))->error().empty());
+}
+
+BOOST_AUTO_TEST_CASE(reset) { // NOLINT
+    auto batch = stream("[{\"id\":", 4);
+    BOOST_TEST(!static_pointer_cast<Reply>(batch->element(0))->error().empty());
+
+    auto text = json::array({
+        reply("get_info", {{"height", 7}}),
+        reply("getblocktemplate", block(7))
+    }).dump();
+    batch->reset();
+    batch->write(text.data(), text.size());
+    batch->finish();
+    BOOST_TEST(batch->supported());
+    BOOST_TEST(static_pointer_cast<Reply>(batch->element(0))->result("height") == "7");
+}
+
+#pragma clang diagnostic pop
@@ -0,0 +1,114 @@
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_MODULE test_directory
+
+#include <boost/test/unit_test.hpp>
+
+#include "server/directory.h"
+
+#include <fmt/format.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <map>
+
+using server::Directory;
+
+static vector<string> nodes(size_t count) {
+    vector<string> out;
+    for (size_t i = 0; i < count; i++) {
+        out.emplace_back(fmt::format("10.0.0.{}:8847", i + 1));
+    }
+    return out;
+}
+
+BOOST_AUTO_TEST_CASE(agreement) { // NOLINT
+    // Nodes that know the same members agree on every owner, whichever of
+    // them is asking.
+    auto members = nodes(5);
+    vector<unique_ptr<Directory>> directories;
+    for (const auto &self : members) {
+        directories.emplace_back(make_unique<Directory>(self));
+        directories.back()->observe(members);
+    }
+
+    for (int i = 0; i < 200; i++) {
+        auto id = fmt::format("miner-{}", i);
+        auto owners = directories[0]->owners(id);
+        BOOST_TEST(owners.size() == 2u);
+        BOOST_TEST(owners[0] != owners[1]);
+        for (auto &each : directories) {
+            BOOST_TEST(each->owners(id) == owners);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(balance) { // NOLINT
+    auto members = nodes(8);
+    Directory directory(members[0]);
+    directory.observe(members);
+
+    map<string, size_t> load;
+    for (int i = 0; i < 8000; i++) {
+        load[directory.owners(fmt::format("miner-{}", i))[0]]++;
+    }
+    BOOST_TEST(load.size() == members.size());
+    for (auto &each : load) {
+        BOOST_TEST(each.second > 500u);
+        BOOST_TEST(each.second < 1500u);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(churn) { // NOLINT
+    // A joining member takes over about its fair share of ids and every
+    // other id keeps its owner.
+    auto members = nodes(9);
+    Directory before(members[0]), after(members[0]);
+    before.observe(vector<string>(members.begin(), members.end() - 1));
+    after.observe(members);
+
+    size_t moved = 0, total = 9000;
+    for (size_t i = 0; i < total; i++) {
+        auto id = fmt::format("miner-{}", i);
+        auto previous = before.owners(id)[0], current = after.owners(id)[0];
+        if (previous == current) continue;
+        BOOST_TEST(current == members.back());
+        moved++;
+    }
+    BOOST_TEST(moved > total / 18);
+    BOOST_TEST(moved < total / 5);
+}
+
+BOOST_AUTO_TEST_CASE(single) { // NOLINT
+    Directory directory("10.0.0.1:8847");
+    auto owners = directory.owners("miner");
+    BOOST_REQUIRE(owners.size() == 1u);
+    BOOST_TEST(owners[0] == "10.0.0.1:8847");
+    BOOST_TEST(!directory.observe({"10.0.0.1:8847"}));
+    BOOST_TEST(directory.observe({"10.0.0.2:8847"}));
+    BOOST_TEST(!directory.observe({"10.0.0.2:8847"}));
+    BOOST_TEST(directory.owners("miner").size() == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(entries) { // NOLINT
+    Directory directory("10.0.0.1:8847");
+    BOOST_TEST(directory.locate("miner").empty());
+
+    directory.record("miner", "10.0.0.2:8847");
+    BOOST_TEST(directory.locate("miner") == "10.0.0.2:8847");
+
+    // The miner moved before its old node reported the disconnect.
+    directory.record("miner", "10.0.0.3:8847");
+    directory.erase("miner", "10.0.0.2:8847");
+    BOOST_TEST(directory.locate("miner") == "10.0.0.3:8847");
+
+    directory.erase("miner", "10.0.0.3:8847");
+    BOOST_TEST(directory.locate("miner").empty());
+    BOOST_TEST(directory.size() == 0u);
+
+    directory.record("miner", "10.0.0.3:8847");
+    BOOST_TEST(!directory.expire());
+    BOOST_TEST(directory.size() == 1u);
+}
+
+#pragma clang diagnostic pop
@@ -0,0 +1,59 @@
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_MODULE test_lru
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/lru.h"
+
+#include <string>
+
+using common::Lru;
+
+BOOST_AUTO_TEST_CASE(get_missing) { // NOLINT
+    Lru<string, string> lru(2);
+    BOOST_TEST(!lru.get("a").has_value());
+}
+
+BOOST_AUTO_TEST_CASE(put_get) { // NOLINT
+    Lru<string, string> lru(2);
+    lru.put("a", "1");
+    BOOST_TEST(lru.get("a").value() == "1");
+    BOOST_TEST(lru.size() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(put_overwrite) { // NOLINT
+    Lru<string, string> lru(2);
+    lru.put("a", "1");
+    lru.put("a", "2");
+    BOOST_TEST(lru.get("a").value() == "2");
+    BOOST_TEST(lru.size() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(evict_least_recent) { // NOLINT
+    Lru<string, string> lru(2);
+    lru.put("a", "1");
+    lru.put("b", "2");
+    lru.get("a");
+    lru.put("c", "3");
+    BOOST_TEST(lru.get("a").has_value());
+    BOOST_TEST(!lru.get("b").has_value());
+    BOOST_TEST(lru.get("c").has_value());
+    BOOST_TEST(lru.size() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(erase) { // NOLINT
+    Lru<string, string> lru(2);
+    lru.put("a", "1");
+    BOOST_TEST(lru.erase("a"));
+    BOOST_TEST(!lru.erase("a"));
+    BOOST_TEST(lru.size() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(zero_capacity) { // NOLINT
+    Lru<string, string> lru(0);
+    lru.put("a", "1");
+    BOOST_TEST(!lru.get("a").has_value());
+}
+
+#pragma clang diagnostic pop
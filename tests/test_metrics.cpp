@@ -0,0 +1,154 @@
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_MODULE test_metrics
+
+#include <boost/test/unit_test.hpp>
+
+#include "server/metrics.h"
+
+#include <thread>
+#include <string>
+#include <vector>
+
+using namespace server::metrics;
+
+BOOST_AUTO_TEST_CASE(counter) { // NOLINT
+    Counter counter;
+    vector<thread> threads;
+    for (int i = 0; i < 8; i++) {
+        threads.emplace_back([&counter] {
+            for (int j = 0; j < 10000; j++) counter.add();
+        });
+    }
+    for (auto &each : threads) each.join();
+    BOOST_CHECK_EQUAL(counter.value(), 80000);
+
+    counter.add(5);
+    BOOST_CHECK_EQUAL(counter.value(), 80005);
+}
+
+BOOST_AUTO_TEST_CASE(gauge) { // NOLINT
+    Gauge gauge;
+    gauge.add(3);
+    gauge.sub();
+    BOOST_CHECK_EQUAL(gauge.value(), 2);
+    gauge.set(-7);
+    BOOST_CHECK_EQUAL(gauge.value(), -7);
+}
+
+BOOST_AUTO_TEST_CASE(histogram) { // NOLINT
+    Histogram histogram({1000, 10000});
+    histogram.observe(chrono::microseconds(500));
+    histogram.observe(chrono::microseconds(1000));
+    histogram.observe(chrono::milliseconds(5));
+    histogram.observe(chrono::seconds(1));
+
+    auto buckets = histogram.buckets();
+    BOOST_REQUIRE_EQUAL(buckets.size(), 3);
+    BOOST_CHECK_EQUAL(buckets[0], 2);
+    BOOST_CHECK_EQUAL(buckets[1], 1);
+    BOOST_CHECK_EQUAL(buckets[2], 1);
+    BOOST_CHECK_EQUAL(histogram.count(), 4);
+    BOOST_CHECK_EQUAL(histogram.sum(), 1006500);
+}
+
+BOOST_AUTO_TEST_CASE(family) { // NOLINT
+    Registry registry;
+    Family<Counter> requests(registry, "requests_total", "Requests.", {"route", "status"});
+    auto &ok = requests.with({"/health", "200"});
+    ok.add();
+    requests.with({"/health", "200"}).add();
+    requests.with({"/agent/{}", "101"}).add();
+
+    BOOST_CHECK_EQUAL(&ok, &requests.with({"/health", "200"}));
+    BOOST_CHECK_EQUAL(ok.value(), 2);
+
+    vector<thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&requests, i] {
+            for (int j = 0; j < 1000; j++) {
+                requests.with({"/route", to_string((i + j) % 16)}).add();
+            }
+        });
+    }
+    for (auto &each : threads) each.join();
+
+    uint64_t total = 0;
+    for (int i = 0; i < 16; i++) {
+        total += requests.with({"/route", to_string(i)}).value();
+    }
+    BOOST_CHECK_EQUAL(total, 4000);
+}
+
+BOOST_AUTO_TEST_CASE(histogram_limit) { // NOLINT
+    vector<uint64_t> bounds(buckets_limit - 1);
+    for (size_t i = 0; i < bounds.size(); i++) bounds[i] = i + 1;
+    Histogram largest(bounds);
+    largest.observe(chrono::seconds(1));
+    BOOST_CHECK_EQUAL(largest.buckets().back(), 1);
+
+    bounds.emplace_back(bounds.size() + 1);
+    BOOST_CHECK_THROW(Histogram{bounds}, invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(table) { // NOLINT
+    Registry registry;
+    Family<Counter> requests(registry, "requests_total", "Requests.", {"route", "status"});
+    size_t resolved = 0;
+    Table<Counter> table(requests, 4, [&resolved](size_t key) {
+        resolved++;
+        return vector<string>{"/route", to_string(key)};
+    });
+
+    for (int i = 0; i < 10; i++) table.at(1).add();
+    BOOST_CHECK_EQUAL(resolved, 1);
+    BOOST_CHECK_EQUAL(&table.at(1), &requests.with({"/route", "1"}));
+    BOOST_CHECK_EQUAL(requests.with({"/route", "1"}).value(), 10);
+
+    // Keys past the table still reach their child, just not from the cache.
+    table.at(7).add();
+    table.at(7).add();
+    BOOST_CHECK_EQUAL(resolved, 3);
+    BOOST_CHECK_EQUAL(requests.with({"/route", "7"}).value(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(overflow) { // NOLINT
+    Registry registry;
+    Family<Counter> ids(registry, "ids_total", "Ids.", {"id"});
+    for (int i = 0; i < 300; i++) ids.with({to_string(i)}).add();
+
+    auto out = registry.expose();
+    BOOST_CHECK(out.find("ids_total{id=\"0\"} 1\n") != string::npos);
+    BOOST_CHECK(out.find("ids_total{id=\"overflow\"} 44\n") != string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(exposition) { // NOLINT
+    Registry registry;
+    Family<Counter> frames(registry, "frames_total", "Frames.", {"type"});
+    Family<Gauge> sessions(registry, "sessions", "Sessions.");
+    Family<Histogram> latency(registry, "latency_seconds", "Latency.", {"method"});
+
+    frames.with({"LO\"GIN"}).add(3);
+    sessions.with().set(2);
+    latency.with({"get_info"}).observe(chrono::milliseconds(2));
+
+    auto out = registry.expose();
+    BOOST_CHECK(out.find("# HELP frames_total Frames.\n") != string::npos);
+    BOOST_CHECK(out.find("# TYPE frames_total counter\n") != string::npos);
+    BOOST_CHECK(out.find("frames_total{type=\"LO\\\"GIN\"} 3\n") != string::npos);
+    BOOST_CHECK(out.find("# TYPE sessions gauge\nsessions 2\n") != string::npos);
+    BOOST_CHECK(out.find("# TYPE latency_seconds histogram\n") != string::npos);
+    BOOST_CHECK(out.find(
+        "latency_seconds_bucket{method=\"get_info\",le=\"0.001\"} 0\n"
+    ) != string::npos);
+    BOOST_CHECK(out.find(
+        "latency_seconds_bucket{method=\"get_info\",le=\"0.0025\"} 1\n"
+    ) != string::npos);
+    BOOST_CHECK(out.find(
+        "latency_seconds_bucket{method=\"get_info\",le=\"+Inf\"} 1\n"
+    ) != string::npos);
+    BOOST_CHECK(out.find("latency_seconds_sum{method=\"get_info\"} 0.002\n") != string::npos);
+    BOOST_CHECK(out.find("latency_seconds_count{method=\"get_info\"} 1\n") != string::npos);
+}
+
+#pragma clang diagnostic pop
@@ -0,0 +1,69 @@
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_MODULE test_notifier
+
+#include <boost/test/unit_test.hpp>
+
+#include "server/notifier.h"
+#include "daemon.h"
+
+#include <boost/asio/io_context.hpp>
+#include <fmt/format.h>
+#include <string>
+#include <vector>
+
+using server::Notifier;
+using common::Uri;
+
+static const string topic = "json-minimal-chain_main";
+
+BOOST_AUTO_TEST_CASE(subscribe_receive) { // NOLINT
+    Daemon daemon;
+    boost::asio::io_context ioc;
+    vector<string> received;
+
+    Uri uri(fmt::format("tcp://127.0.0.1:{}", daemon.pub_port()));
+    auto notifier = make_shared<Notifier>(ioc, uri, topic,
+        [&](const string &message) {
+            received.emplace_back(message);
+            if (received.size() == 2) ioc.stop();
+        }
+    );
+    notifier->run();
+
+    thread publisher([&daemon] {
+        if (!daemon.wait_subscribers(1, chrono::seconds(5))) return;
+        daemon.publish();
+        daemon.publish();
+    });
+
+    ioc.run_for(chrono::seconds(10));
+    publisher.join();
+
+    BOOST_TEST(notifier->connected());
+    BOOST_REQUIRE(received.size() == 2);
+    BOOST_TEST(received[0].compare(0, topic.size(), topic) == 0);
+    BOOST_TEST(received[1].find(Daemon::hash(daemon.height())) != string::npos);
+    notifier->stop();
+}
+
+BOOST_AUTO_TEST_CASE(reconnect_refused) { // NOLINT
+    boost::asio::io_context ioc;
+    boost::asio::ip::tcp::acceptor acceptor(ioc,
+        {boost::asio::ip::make_address("127.0.0.1"), 0});
+    auto port = acceptor.local_endpoint().port();
+    acceptor.close();
+
+    Uri uri(fmt::format("tcp://127.0.0.1:{}", port));
+    auto notifier = make_shared<Notifier>(ioc, uri, topic,
+        [](const string &message) {}
+    );
+    notifier->run();
+
+    ioc.run_for(chrono::milliseconds(200));
+    BOOST_TEST(!notifier->connected());
+    notifier->stop();
+    ioc.run_for(chrono::milliseconds(10));
+}
+
+#pragma clang diagnostic pop
@@ -0,0 +1,62 @@
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_MODULE test_placement
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/placement.h"
+
+#include <pthread.h>
+#include <system_error>
+#include <cstring>
+#include <thread>
+#include <string>
+
+using common::Placement;
+
+BOOST_AUTO_TEST_CASE(parse) { // NOLINT
+    BOOST_TEST(Placement().empty());
+    BOOST_TEST(Placement("").empty());
+    BOOST_TEST(Placement("3").count() == 1);
+    BOOST_TEST(Placement("0-3,8").count() == 5);
+    BOOST_TEST(Placement("0-3,2-5").count() == 6);
+    BOOST_TEST(Placement("0-3,8").str() == "0-3,8");
+}
+
+BOOST_AUTO_TEST_CASE(parse_invalid) { // NOLINT
+    for (auto list : {"x", "1-", "-1", "3-1", "1,", ",1", "1 2", "0-99999"}) {
+        BOOST_CHECK_THROW(Placement{list}, invalid_argument);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(apply_inherited) { // NOLINT
+    // Threads started afterwards inherit the CPUs, the way the ones of a
+    // subsystem do.
+    thread([] {
+        int cpu = sched_getcpu();
+        Placement(to_string(cpu)).apply();
+        thread([cpu] {
+            cpu_set_t cpus;
+            pthread_getaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+            BOOST_TEST(CPU_COUNT(&cpus) == 1);
+            BOOST_TEST(CPU_ISSET(cpu, &cpus));
+        }).join();
+    }).join();
+}
+
+BOOST_AUTO_TEST_CASE(apply_unavailable) { // NOLINT
+    thread([] {
+        BOOST_CHECK_THROW(Placement("1023").apply(), system_error);
+    }).join();
+}
+
+BOOST_AUTO_TEST_CASE(thread_name) { // NOLINT
+    thread([] {
+        char name[16];
+        Placement::name("frontend-io-12345");
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        BOOST_TEST(string(name) == "frontend-io-123");
+    }).join();
+}
+
+#pragma clang diagnostic pop
@@ -0,0 +1,140 @@
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_MODULE test_pool
+
+#include <boost/test/unit_test.hpp>
+
+#include "server/web/pool.h"
+#include "daemon.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/beast/http.hpp>
+#include <fmt/format.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+using server::web::Pool;
+using common::Uri;
+namespace http = boost::beast::http;
+
+static http::request<http::string_body> call(const string &method) {
+    http::request<http::string_body> req;
+    req.method(http::verb::post);
+    req.target("/json_rpc");
+    req.keep_alive(true);
+    req.body() = nlohmann::json{
+        {"jsonrpc", "2.0"},
+        {"id", "0"},
+        {"method", method}
+    }.dump();
+    req.prepare_payload();
+    return req;
+}
+
+static shared_ptr<Pool> pool(
+    boost::asio::io_context &ioc,
+    const Daemon &daemon,
+    size_t size,
+    size_t depth
+) {
+    auto uri = Uri(fmt::format("http://127.0.0.1:{}", daemon.rpc_port()));
+    auto pool = make_shared<Pool>(ioc, uri, size, depth);
+    pool->run();
+    return pool;
+}
+
+struct Outcome {
+    size_t succeeded = 0;
+    vector<boost::system::error_code> failures;
+};
+
+// Issues `count` requests at once and runs the io_context until all of
+// them are answered one way or the other.
+static Outcome issue(
+    boost::asio::io_context &ioc,
+    shared_ptr<Pool> pool,
+    size_t count,
+    chrono::steady_clock::duration timeout = chrono::seconds(5)
+) {
+    Outcome outcome;
+    size_t done = 0;
+    auto finished = [&] {
+        if (++done == count) ioc.stop();
+    };
+    ioc.restart();
+    boost::asio::post(ioc, [&] {
+        for (size_t i = 0; i < count; i++) {
+            pool->request(call("get_info"), [&](auto &res) {
+                outcome.succeeded++;
+                finished();
+            }, [&](const string &msg, boost::system::error_code code) {
+                outcome.failures.emplace_back(code);
+                finished();
+            }, timeout);
+        }
+    });
+    ioc.run_for(chrono::seconds(20));
+    return outcome;
+}
+
+BOOST_AUTO_TEST_CASE(reuse) { // NOLINT
+    Daemon daemon;
+    boost::asio::io_context ioc;
+    auto connections = pool(ioc, daemon, 2, 1);
+
+    for (int i = 0; i < 10; i++) {
+        BOOST_TEST(issue(ioc, connections, 1).succeeded == 1);
+    }
+    BOOST_TEST(daemon.requests() == 10);
+    BOOST_TEST(daemon.connections() == 1);
+    connections->stop();
+}
+
+BOOST_AUTO_TEST_CASE(pipelined) { // NOLINT
+    Daemon daemon;
+    boost::asio::io_context ioc;
+    auto connections = pool(ioc, daemon, 1, 4);
+
+    auto outcome = issue(ioc, connections, 8);
+    BOOST_TEST(outcome.succeeded == 8);
+    BOOST_TEST(daemon.connections() == 1);
+    connections->stop();
+}
+
+BOOST_AUTO_TEST_CASE(stale) { // NOLINT
+    Daemon daemon;
+    boost::asio::io_context ioc;
+    auto connections = pool(ioc, daemon, 1, 1);
+    BOOST_TEST(issue(ioc, connections, 1).succeeded == 1);
+
+    // The pool only finds out on the next exchange, which is sent once
+    // more on a fresh connection instead of failing.
+    daemon.drop();
+    auto outcome = issue(ioc, connections, 1);
+    BOOST_TEST(outcome.succeeded == 1);
+    BOOST_TEST(outcome.failures.empty());
+    BOOST_TEST(daemon.connections() == 2);
+    connections->stop();
+}
+
+BOOST_AUTO_TEST_CASE(deadline) { // NOLINT
+    Daemon daemon;
+    daemon.delay(chrono::milliseconds(2000));
+    boost::asio::io_context ioc;
+    auto connections = pool(ioc, daemon, 1, 1);
+
+    // An exchange that ran out of time is reported rather than retried.
+    auto started = chrono::steady_clock::now();
+    auto outcome = issue(ioc, connections, 1, chrono::milliseconds(200));
+    auto elapsed = chrono::steady_clock::now() - started;
+    BOOST_TEST(outcome.succeeded == 0);
+    BOOST_REQUIRE(outcome.failures.size() == 1);
+    BOOST_TEST(outcome.failures[0] == boost::asio::error::timed_out);
+    BOOST_TEST((elapsed < chrono::milliseconds(1000)));
+    BOOST_TEST(daemon.connections() == 1);
+    connections->stop();
+}
+
+#pragma clang diagnostic pop
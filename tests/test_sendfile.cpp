@@ -0,0 +1,111 @@
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_MODULE test_sendfile
+
+#include <boost/test/unit_test.hpp>
+
+#include "server/sendfile.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/connect.hpp>
+#include <boost/filesystem.hpp>
+#include <fcntl.h>
+#include <unistd.h>
+#include <fstream>
+#include <random>
+#include <string>
+
+using server::Sendfile;
+namespace asio = boost::asio;
+namespace fs = boost::filesystem;
+using asio::ip::tcp;
+
+struct File {
+    fs::path path;
+    string data;
+    int fd;
+
+    explicit File(size_t size) :
+        path(fs::temp_directory_path() / fs::unique_path()),
+        data(size, '\0') {
+        mt19937 rng(size);
+        for (auto &each : data) each = (char) rng();
+        ofstream(path.string(), ios::binary) << data;
+        fd = ::open(path.c_str(), O_RDONLY);
+    }
+
+    ~File() {
+        ::close(fd);
+        fs::remove(path);
+    }
+};
+
+// Sends a range of the file across a loopback connection while the other
+// end reads it back slowly enough for the sender to find the socket full.
+static string transfer(const File &file, int64_t offset, uint64_t count) {
+    asio::io_context ioc;
+    asio::strand<asio::io_context::executor_type> strand(ioc.get_executor());
+    tcp::acceptor acceptor(ioc, {asio::ip::make_address("127.0.0.1"), 0});
+    tcp::socket server(ioc), client(ioc);
+    client.connect(acceptor.local_endpoint());
+    acceptor.accept(server);
+    server.set_option(asio::socket_base::send_buffer_size(4096));
+
+    boost::system::error_code result = asio::error::would_block;
+    make_shared<Sendfile>(server, strand, file.fd, offset, count,
+        [&](boost::system::error_code code) {
+            result = code;
+            server.shutdown(tcp::socket::shutdown_send);
+        }
+    )->run();
+
+    string received;
+    vector<char> buffer(1024);
+    function<void(boost::system::error_code, size_t)> on_read;
+    on_read = [&](boost::system::error_code code, size_t bytes) {
+        received.append(buffer.data(), bytes);
+        if (code) return;
+        client.async_read_some(asio::buffer(buffer), on_read);
+    };
+    client.async_read_some(asio::buffer(buffer), on_read);
+    ioc.run();
+
+    BOOST_CHECK(!result);
+    return received;
+}
+
+BOOST_AUTO_TEST_CASE(whole) { // NOLINT
+    File file(4 << 20);
+    BOOST_CHECK(transfer(file, 0, file.data.size()) == file.data);
+}
+
+BOOST_AUTO_TEST_CASE(range) { // NOLINT
+    File file(100000);
+    BOOST_CHECK(transfer(file, 1234, 5678) == file.data.substr(1234, 5678));
+}
+
+BOOST_AUTO_TEST_CASE(nothing) { // NOLINT
+    File file(16);
+    BOOST_CHECK(transfer(file, 0, 0).empty());
+}
+
+BOOST_AUTO_TEST_CASE(truncated) { // NOLINT
+    File file(1000);
+    asio::io_context ioc;
+    asio::strand<asio::io_context::executor_type> strand(ioc.get_executor());
+    tcp::acceptor acceptor(ioc, {asio::ip::make_address("127.0.0.1"), 0});
+    tcp::socket server(ioc), client(ioc);
+    client.connect(acceptor.local_endpoint());
+    acceptor.accept(server);
+
+    boost::system::error_code result;
+    make_shared<Sendfile>(server, strand, file.fd, 0, 2000,
+        [&](boost::system::error_code code) { result = code; }
+    )->run();
+    ioc.run();
+    BOOST_CHECK(result == asio::error::eof);
+}
+
+#pragma clang diagnostic pop
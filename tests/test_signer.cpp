@@ -0,0 +1,95 @@
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_MODULE test_signer
+
+#include <boost/test/unit_test.hpp>
+
+#include "server/signer.h"
+
+#include <boost/filesystem.hpp>
+#include <sys/stat.h>
+#include <fstream>
+#include <string>
+
+using server::Signer;
+namespace fs = boost::filesystem;
+
+struct Keyfile {
+    fs::path path;
+
+    Keyfile() : path(fs::temp_directory_path() / fs::unique_path()) {}
+
+    ~Keyfile() {
+        fs::remove(path);
+    }
+};
+
+BOOST_AUTO_TEST_CASE(sign_verify) { // NOLINT
+    Signer signer("", 16);
+    auto signature = signer.sign("parameters");
+    BOOST_TEST(signer.verify("parameters", signature));
+    BOOST_TEST(!signer.verify("tampered", signature));
+    BOOST_TEST(!signer.verify("parameters", "00"));
+    BOOST_TEST(!signer.verify("parameters", "not hex"));
+}
+
+BOOST_AUTO_TEST_CASE(cached) { // NOLINT
+    Signer signer("", 16);
+    auto signature = signer.sign("parameters");
+    BOOST_TEST(signer.verify("parameters", signature));
+    BOOST_TEST(signer.verify("parameters", signature));
+
+    // Another signature over the same data is not the one that was cached.
+    auto other = signer.sign("parameters");
+    other[0] = other[0] == '0' ? '1' : '0';
+    BOOST_TEST(!signer.verify("parameters", other));
+}
+
+BOOST_AUTO_TEST_CASE(generate_load) { // NOLINT
+    Keyfile keyfile;
+    string signature;
+    {
+        Signer signer(keyfile.path.string(), 16);
+        signature = signer.sign("parameters");
+    }
+
+    struct stat st{};
+    BOOST_REQUIRE(stat(keyfile.path.c_str(), &st) == 0);
+    BOOST_TEST((st.st_mode & 0777) == 0600);
+
+    // A restarted node still accepts what it signed before.
+    Signer signer(keyfile.path.string(), 16);
+    BOOST_TEST(signer.verify("parameters", signature));
+}
+
+BOOST_AUTO_TEST_CASE(ephemeral) { // NOLINT
+    Signer first("", 16);
+    Signer second("", 16);
+    BOOST_TEST(!second.verify("parameters", first.sign("parameters")));
+}
+
+BOOST_AUTO_TEST_CASE(forged_login) { // NOLINT
+    // What an agent sends on login: the parameters it was served and the
+    // signature that came with them. An agent that edits the parameters,
+    // or signs them with a key of its own, must be turned away even after
+    // the genuine pair has been seen and cached.
+    Signer signer("", 16);
+    Signer forger("", 16);
+    string parameters = R"({"wallet":"node","uid":"a"})";
+    string edited = R"({"wallet":"mine","uid":"a"})";
+    auto signature = signer.sign(parameters);
+    BOOST_TEST(signer.verify(parameters, signature));
+
+    BOOST_TEST(!signer.verify(edited, signature));
+    BOOST_TEST(!signer.verify(edited, forger.sign(edited)));
+    BOOST_TEST(!signer.verify(parameters, forger.sign(parameters)));
+    BOOST_TEST(!signer.verify(parameters, ""));
+}
+
+BOOST_AUTO_TEST_CASE(invalid_key) { // NOLINT
+    Keyfile keyfile;
+    ofstream(keyfile.path.string(), ios::binary) << "not a key";
+    BOOST_CHECK_THROW(Signer(keyfile.path.string(), 16), exception);
+}
+
+#pragma clang diagnostic pop
@@ -0,0 +1,214 @@
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_MODULE test_template
+
+#include <boost/test/unit_test.hpp>
+
+#include "server/template.h"
+#include "daemon.h"
+
+#include <boost/beast/http.hpp>
+#include <nlohmann/json.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+using server::Template;
+using server::web::stream_body;
+using nlohmann::json;
+namespace http = boost::beast::http;
+
+static string reply(const json &result) {
+    return json{{"id", "0"}, {"jsonrpc", "2.0"}, {"result", result}}.dump();
+}
+
+static shared_ptr<Template::Reader> stream(const string &text, size_t chunk) {
+    auto reader = make_shared<Template::Reader>();
+    for (size_t i = 0; i < text.size(); i += chunk) {
+        reader->write(text.data() + i, min(chunk, text.size() - i));
+    }
+    reader->finish();
+    return reader;
+}
+
+static json result(uint64_t height, const vector<string> &txs = {}) {
+    return {
+        {"blocktemplate_blob", Daemon::blob(height, txs)},
+        {"difficulty", 1000},
+        {"expected_reward", 600000000000},
+        {"height", height},
+        {"prev_hash", Daemon::hash(height - 1)},
+        {"reserved_offset", 130},
+        {"seed_hash", Daemon::hash(0)},
+        {"status", "OK"}
+    };
+}
+
+BOOST_AUTO_TEST_CASE(unhex) { // NOLINT
+    BOOST_TEST(Template::unhex("00ff10Ab") == string("\x00\xff\x10\xab", 4));
+    BOOST_CHECK_THROW(Template::unhex("abc"), invalid_argument);
+    BOOST_CHECK_THROW(Template::unhex("zz"), invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(decode) { // NOLINT
+    Template tmpl(result(42));
+    BOOST_TEST(tmpl.height() == 42);
+    BOOST_TEST(tmpl.difficulty() == 1000);
+    BOOST_TEST(tmpl.reserved_offset() == 130);
+    BOOST_TEST(tmpl.prev_hash()[31] == 41);
+    BOOST_TEST(tmpl.blob().size() * 2 == Daemon::blob(42).size());
+    BOOST_TEST(tmpl.txs().empty());
+}
+
+BOOST_AUTO_TEST_CASE(decode_txs) { // NOLINT
+    Template tmpl(result(42, {Daemon::hash(7), Daemon::hash(9)}));
+    BOOST_REQUIRE(tmpl.txs().size() == 2);
+    BOOST_TEST(tmpl.txs()[0][31] == 7);
+    BOOST_TEST(tmpl.txs()[1][31] == 9);
+}
+
+BOOST_AUTO_TEST_CASE(decode_truncated) { // NOLINT
+    auto truncated = result(42, {Daemon::hash(7)});
+    auto blob = truncated["blocktemplate_blob"].get<string>();
+    truncated["blocktemplate_blob"] = blob.substr(0, blob.size() - 2);
+    BOOST_CHECK_THROW(Template{truncated}, invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(decode_missing) { // NOLINT
+    auto missing = result(42);
+    missing.erase("prev_hash");
+    BOOST_CHECK_THROW(Template{missing}, invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(fields) { // NOLINT
+    Template base(result(42, {Daemon::hash(7)}));
+    auto prev = string(base.prev_hash().begin(), base.prev_hash().end());
+    auto seed = string(base.seed_hash().begin(), base.seed_hash().end());
+
+    Template copy(
+        base.height(),
+        base.difficulty(),
+        base.reward(),
+        base.reserved_offset(),
+        prev,
+        seed,
+        base.blob()
+    );
+    BOOST_TEST(copy.same(base));
+    BOOST_TEST(copy.reward() == base.reward());
+    BOOST_REQUIRE(copy.txs().size() == 1);
+
+    BOOST_CHECK_THROW(Template(42, 1000, 0, 130, "short", seed, base.blob()), invalid_argument);
+    BOOST_CHECK_THROW(Template(42, 1000, 0, 130, prev, seed, "\x0e"), invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(same) { // NOLINT
+    Template base(result(42, {Daemon::hash(7)}));
+
+    auto difficulty = result(42, {Daemon::hash(7)});
+    difficulty["difficulty"] = 2000;
+    BOOST_TEST(base.same(Template(difficulty)));
+
+    BOOST_TEST(!base.same(Template(result(43, {Daemon::hash(7)}))));
+    BOOST_TEST(!base.same(Template(result(42, {Daemon::hash(8)}))));
+    BOOST_TEST(!base.same(Template(result(42))));
+}
+
+BOOST_AUTO_TEST_CASE(reader) { // NOLINT
+    auto source = result(42, {Daemon::hash(7), Daemon::hash(9)});
+    Template expected(source);
+    for (size_t chunk : {1, 7, 64, 4096}) {
+        auto reader = stream(reply(source), chunk);
+        BOOST_REQUIRE(reader->error().empty());
+        auto tmpl = reader->result();
+        BOOST_REQUIRE(tmpl);
+        BOOST_TEST(tmpl->height() == expected.height());
+        BOOST_TEST(tmpl->difficulty() == expected.difficulty());
+        BOOST_TEST(tmpl->reward() == expected.reward());
+        BOOST_TEST(tmpl->reserved_offset() == expected.reserved_offset());
+        BOOST_TEST(tmpl->prev_hash() == expected.prev_hash());
+        BOOST_TEST(tmpl->seed_hash() == expected.seed_hash());
+        BOOST_TEST(tmpl->blob() == expected.blob());
+        BOOST_TEST(tmpl->txs() == expected.txs());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(reader_error) { // NOLINT
+    auto text = json{
+        {"id", "0"},
+        {"jsonrpc", "2.0"},
+        {"error", {{"code", -9}, {"message", "Core is busy"}}}
+    }.dump();
+    auto reader = stream(text, 5);
+    BOOST_TEST(reader->error() == "Core is busy");
+    BOOST_TEST(!reader->result());
+}
+
+BOOST_AUTO_TEST_CASE(reader_malformed) { // NOLINT
+    auto text = reply(result(42));
+    BOOST_TEST(!stream(text.substr(0, text.size() - 1), 16)->result());
+
+    auto missing = result(42);
+    missing.erase("height");
+    BOOST_TEST(!stream(reply(missing), 16)->result());
+
+    auto odd = result(42);
+    odd["blocktemplate_blob"] = "0" + odd["blocktemplate_blob"].get<string>();
+    BOOST_TEST(!stream(reply(odd), 16)->result());
+}
+
+BOOST_AUTO_TEST_CASE(reader_odd_blob) { // NOLINT
+    // The nibble left over from the blob must not shift the hashes after it.
+    auto odd = result(42);
+    odd["blocktemplate_blob"] = odd["blocktemplate_blob"].get<string>() + "0";
+    for (size_t chunk : {1, 7, 4096}) {
+        auto reader = stream(reply(odd), chunk);
+        BOOST_TEST(!reader->result());
+        BOOST_TEST(!reader->error().empty());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(reader_overflow) { // NOLINT
+    auto text = reply(result(42));
+    auto at = text.find("\"height\":42");
+    BOOST_REQUIRE(at != string::npos);
+    text.replace(at, 11, "\"height\":99999999999999999999999");
+    BOOST_TEST(!stream(text, 16)->result());
+}
+
+BOOST_AUTO_TEST_CASE(reader_reset) { // NOLINT
+    auto text = reply(result(42));
+    Template::Reader reader;
+    reader.write(text.data(), text.size() / 2);
+    reader.reset();
+    reader.write(text.data(), text.size());
+    reader.finish();
+    BOOST_TEST(reader.error().empty());
+    BOOST_TEST(reader.digest() == stream(text, 3)->digest());
+    BOOST_TEST(reader.digest() != stream(reply(result(43)), 3)->digest());
+}
+
+BOOST_AUTO_TEST_CASE(body) { // NOLINT
+    auto text = reply(result(42, {Daemon::hash(7)}));
+    auto wire = "HTTP/1.1 200 OK\r\nContent-Length: " + to_string(text.size())
+                + "\r\n\r\n" + text;
+
+    auto reader = make_shared<Template::Reader>();
+    http::response_parser<stream_body> parser;
+    parser.get().body().sink = reader;
+    string pending;
+    boost::system::error_code code;
+    for (size_t i = 0; i < wire.size(); i += 16) {
+        pending += wire.substr(i, 16);
+        auto used = parser.put(boost::asio::buffer(pending), code);
+        if (code == http::error::need_more) code = {};
+        BOOST_REQUIRE(!code);
+        pending.erase(0, used);
+    }
+    BOOST_TEST(parser.is_done());
+    BOOST_TEST(parser.get().body().text.empty());
+    BOOST_REQUIRE(reader->result());
+    BOOST_TEST(reader->result()->txs().size() == 1);
+}
+
+#pragma clang diagnostic pop
@@ -0,0 +1,138 @@
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_MODULE test_templates
+
+#include <boost/test/unit_test.hpp>
+
+#include "cluster.h"
+#include "daemon.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using server::Distributor;
+using server::Template;
+
+static shared_ptr<const Template> block(uint64_t height) {
+    return make_shared<Template>(nlohmann::json{
+        {"blocktemplate_blob", Daemon::blob(height)},
+        {"difficulty", 1000},
+        {"expected_reward", 600000000000},
+        {"height", height},
+        {"prev_hash", Daemon::hash(height - 1)},
+        {"reserved_offset", 130},
+        {"seed_hash", Daemon::hash(0)},
+        {"status", "OK"}
+    });
+}
+
+BOOST_AUTO_TEST_CASE(propagation) { // NOLINT
+    Cluster cluster(8, 2);
+    vector<chrono::steady_clock::duration> samples;
+
+    for (uint64_t height = 2; height < 52; height++) {
+        auto sent = chrono::steady_clock::now();
+        cluster.node(0).distributor->originate(block(height));
+        BOOST_REQUIRE(cluster.wait(height, cluster.size() - 1, chrono::seconds(5)));
+
+        auto latencies = cluster.latencies(height, sent);
+        samples.insert(samples.end(), latencies.begin(), latencies.end());
+    }
+
+    sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        auto index = (size_t) (p * (samples.size() - 1));
+        return chrono::duration_cast<chrono::microseconds>(samples[index]).count();
+    };
+    BOOST_TEST_MESSAGE("propagation over " << cluster.size() << " nodes, "
+                       << samples.size() << " samples: p50 " << percentile(0.5)
+                       << "us, p90 " << percentile(0.9)
+                       << "us, p99 " << percentile(0.99) << "us");
+}
+
+BOOST_AUTO_TEST_CASE(duplicates) { // NOLINT
+    Cluster cluster(6, 3);
+    cluster.node(2).distributor->originate(block(7));
+    BOOST_REQUIRE(cluster.wait(7, cluster.size() - 1, chrono::seconds(5)));
+
+    // Relays overlap on purpose, give stragglers time to arrive.
+    this_thread::sleep_for(chrono::milliseconds(200));
+    for (size_t i = 0; i < cluster.size(); i++) {
+        BOOST_TEST(cluster.deliveries(i, 7) == (i == 2 ? 0u : 1u));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(heartbeat) { // NOLINT
+    Cluster cluster(4, 1);
+    auto &origin = *cluster.node(0).distributor;
+
+    origin.heartbeat();
+    this_thread::sleep_for(chrono::milliseconds(100));
+    BOOST_TEST(cluster.reached(9) == 0);
+
+    origin.originate(block(9));
+    BOOST_REQUIRE(cluster.wait(9, cluster.size() - 1, chrono::seconds(5)));
+
+    // Heartbeats keep followers fed without handing them the same
+    // template over and over.
+    for (int i = 0; i < 3; i++) origin.heartbeat();
+    this_thread::sleep_for(chrono::milliseconds(200));
+    for (size_t i = 1; i < cluster.size(); i++) {
+        BOOST_TEST(cluster.deliveries(i, 9) == 1u);
+        BOOST_TEST(cluster.node(i).distributor->fed());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(missed) { // NOLINT
+    Cluster cluster(3, 1);
+    auto &first = *cluster.node(0).distributor;
+    auto current = block(4);
+
+    // Relays skip the origin, so coming from its only neighbour the
+    // template stops at the first node and the others miss it.
+    first.receive(cluster.node(1).addr, 1, 1, Distributor::digest(*current), current);
+    this_thread::sleep_for(chrono::milliseconds(100));
+    BOOST_TEST(cluster.reached(4) == 1u);
+
+    // A heartbeat only names it, the others ask for the block themselves.
+    first.heartbeat();
+    BOOST_REQUIRE(cluster.wait(4, cluster.size(), chrono::seconds(5)));
+}
+
+BOOST_AUTO_TEST_CASE(receipt) { // NOLINT
+    using Receipt = Distributor::Receipt;
+    Cluster cluster(2, 1);
+    auto &node = *cluster.node(1).distributor;
+    auto current = block(3);
+    auto digest = Distributor::digest(*current);
+
+    BOOST_TEST((node.receive("unix:elsewhere", 5, 5, digest, nullptr) == Receipt::missing));
+    BOOST_TEST((node.receive("unix:elsewhere", 5, 5, digest, current) == Receipt::fresh));
+    BOOST_TEST((node.receive("unix:elsewhere", 5, 5, digest, current) == Receipt::known));
+    BOOST_TEST((node.receive("unix:elsewhere", 4, 4, digest, current) == Receipt::known));
+    BOOST_TEST((node.receive("unix:elsewhere", 6, 5, digest, nullptr) == Receipt::known));
+    BOOST_TEST((node.receive("unix:another", 1, 1, digest, nullptr) == Receipt::known));
+    BOOST_TEST((node.receive(cluster.node(1).addr, 100, 100, "", current) == Receipt::known));
+    BOOST_TEST(cluster.deliveries(1, 3) == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(leadership) { // NOLINT
+    Cluster cluster(2, 1);
+    auto &node = *cluster.node(1).distributor;
+    auto current = block(3);
+    auto digest = Distributor::digest(*current);
+    BOOST_TEST(!node.fed());
+    BOOST_TEST(!node.outranked());
+
+    node.receive("unix:~", 1, 1, digest, current);
+    BOOST_TEST(node.fed());
+    BOOST_TEST(!node.outranked());
+
+    // Heartbeats from below the node's own address make it step down.
+    node.receive("unix:", 1, 1, digest, nullptr);
+    BOOST_TEST(node.outranked());
+}
+
+#pragma clang diagnostic pop
@@ -0,0 +1,106 @@
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_MODULE test_tokenizer
+
+#include <boost/test/unit_test.hpp>
+
+#include "server/web/tokenizer.h"
+
+#include <string>
+#include <vector>
+
+using server::web::Tokenizer;
+
+class Recorder : public Tokenizer::Handler {
+public:
+    vector<string> events;
+    string pending;
+
+    void on_begin(bool array) override {
+        events.emplace_back(array ? "[" : "{");
+    }
+
+    void on_end(bool array) override {
+        events.emplace_back(array ? "]" : "}");
+    }
+
+    void on_key(const string &key) override {
+        events.emplace_back("k:" + key);
+    }
+
+    void on_string(const char *data, size_t size, bool last) override {
+        pending.append(data, size);
+        if (!last) return;
+        events.emplace_back("s:" + pending);
+        pending.clear();
+    }
+
+    void on_number(const string &text) override {
+        events.emplace_back("n:" + text);
+    }
+
+    void on_literal(const string &text) override {
+        events.emplace_back("l:" + text);
+    }
+};
+
+static const string document = R"({"id": "0", "result": {"height": 1234,
+    "list": [1, -2.5e3, true, null, "a\"b\u00e9\ud83d\ude00😀"], "empty": {},
+    "none": []}})";
+
+static const vector<string> expected = {
+    "{", "k:id", "s:0", "k:result", "{", "k:height", "n:1234", "k:list", "[",
+    "n:1", "n:-2.5e3", "l:true", "l:null", "s:a\"bé\U0001F600\U0001F600", "]",
+    "k:empty", "{", "}", "k:none", "[", "]", "}", "}"
+};
+
+BOOST_AUTO_TEST_CASE(whole) { // NOLINT
+    Recorder recorder;
+    Tokenizer tokenizer(recorder);
+    BOOST_TEST(tokenizer.feed(document.data(), document.size()));
+    BOOST_TEST(tokenizer.done());
+    BOOST_TEST(recorder.events == expected);
+}
+
+BOOST_AUTO_TEST_CASE(bytewise) { // NOLINT
+    Recorder recorder;
+    Tokenizer tokenizer(recorder);
+    for (char c : document) {
+        BOOST_REQUIRE(tokenizer.feed(&c, 1));
+    }
+    BOOST_TEST(tokenizer.done());
+    BOOST_TEST(recorder.events == expected);
+}
+
+BOOST_AUTO_TEST_CASE(every_split) { // NOLINT
+    for (size_t split = 1; split < document.size(); split++) {
+        Recorder recorder;
+        Tokenizer tokenizer(recorder);
+        tokenizer.feed(document.data(), split);
+        tokenizer.feed(document.data() + split, document.size() - split);
+        BOOST_REQUIRE(tokenizer.done());
+        BOOST_REQUIRE(recorder.events == expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(malformed) { // NOLINT
+    for (string text : {"{\"a\" 1}", "[1,]x", "{\"a\":tru}", "\"\x01\"", "{]", "[1 2]"}) {
+        Recorder recorder;
+        Tokenizer tokenizer(recorder);
+        tokenizer.feed(text.data(), text.size());
+        BOOST_TEST(!tokenizer.done(), text);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(reset) { // NOLINT
+    Recorder recorder;
+    Tokenizer tokenizer(recorder);
+    tokenizer.feed("{\"a\":", 5);
+    tokenizer.reset();
+    recorder.events.clear();
+    BOOST_TEST(tokenizer.feed("[]", 2));
+    BOOST_TEST(tokenizer.done());
+    BOOST_TEST(recorder.events == vector<string>({"[", "]"}));
+}
+
+#pragma clang diagnostic pop
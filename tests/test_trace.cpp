@@ -0,0 +1,95 @@
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_MODULE test_trace
+
+#include <boost/test/unit_test.hpp>
+
+#include "server/trace.h"
+
+#include <thread>
+#include <string>
+#include <vector>
+
+namespace trace = server::trace;
+
+static vector<trace::json> named(const trace::json &doc, const string &name) {
+    vector<trace::json> out;
+    for (auto &each : doc["traceEvents"]) {
+        if (each["name"] == name) out.emplace_back(each);
+    }
+    return out;
+}
+
+BOOST_AUTO_TEST_CASE(span) { // NOLINT
+    trace::clear();
+    {
+        trace::Span span("test/span", 7);
+        this_thread::sleep_for(chrono::milliseconds(20));
+    }
+
+    auto events = named(trace::dump(), "test/span");
+    BOOST_REQUIRE_EQUAL(events.size(), 1);
+    BOOST_CHECK_EQUAL(events[0]["ph"], "X");
+    BOOST_CHECK_EQUAL(events[0]["cat"], "syncaide");
+
+    // The tick rate is calibrated against the steady clock, so the duration
+    // only has to be in the right ballpark.
+    double duration = events[0]["dur"];
+    BOOST_CHECK_GT(duration, 15000);
+    BOOST_CHECK_LT(duration, 200000);
+}
+
+BOOST_AUTO_TEST_CASE(async) { // NOLINT
+    trace::clear();
+    trace::begin("test/handshake", 42);
+    thread([] { trace::end("test/handshake", 42); }).join();
+    trace::instant("test/instant");
+
+    auto doc = trace::dump();
+    auto events = named(doc, "test/handshake");
+    BOOST_REQUIRE_EQUAL(events.size(), 2);
+    BOOST_CHECK_EQUAL(events[0]["ph"], "b");
+    BOOST_CHECK_EQUAL(events[1]["ph"], "e");
+    BOOST_CHECK_EQUAL(events[0]["id"], 42);
+    BOOST_CHECK_EQUAL(events[1]["id"], 42);
+    BOOST_CHECK_NE(events[0]["tid"], events[1]["tid"]);
+    BOOST_CHECK_LE((double) events[0]["ts"], (double) events[1]["ts"]);
+    BOOST_CHECK_EQUAL(named(doc, "test/instant").size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(wrap) { // NOLINT
+    trace::clear();
+    for (int i = 0; i < trace::capacity + 100; i++) {
+        trace::instant("test/wrap", (uint64_t) i);
+    }
+
+    // The oldest slot may be mid-write once the ring has wrapped, dump
+    // leaves it out.
+    auto events = named(trace::dump(), "test/wrap");
+    BOOST_CHECK_EQUAL(events.size(), (size_t) trace::capacity - 1);
+}
+
+BOOST_AUTO_TEST_CASE(threads) { // NOLINT
+    trace::clear();
+    vector<thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([] {
+            for (int j = 0; j < 100; j++) trace::Span span("test/threads");
+        });
+    }
+
+    // Dumping while the rings are being written must only ever return
+    // whole events.
+    for (int i = 0; i < 10; i++) {
+        for (auto &each : named(trace::dump(), "test/threads")) {
+            BOOST_CHECK_EQUAL(each["ph"], "X");
+        }
+    }
+    for (auto &each : threads) each.join();
+
+    BOOST_CHECK_EQUAL(named(trace::dump(), "test/threads").size(), 400);
+    trace::clear();
+    BOOST_CHECK(trace::dump()["traceEvents"].empty());
+}
+
+#pragma clang diagnostic pop
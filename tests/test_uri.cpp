@@ -174,4 +174,85 @@ BOOST_AUTO_TEST_CASE(print_netloc_without_port) { // NOLINT
     BOOST_TEST(u.netloc() == "www.example.com");
 }
 
+BOOST_AUTO_TEST_CASE(verify_address_constexpr) { // NOLINT
+    using namespace common::address;
+    static_assert(is_ipv4("198.51.100.255"));
+    static_assert(!is_ipv4("198.51.100.256"));
+    static_assert(is_ipv6("2001:db8::8a2e:370:7334"));
+    static_assert(is_ipv6("::ffff:198.51.100.1"));
+    static_assert(is_ipv6("fe80::1%eth0"));
+    static_assert(is_fqdn("xn--bcher-kva.example"));
+    static_assert(!is_fqdn("Example.com"));
+}
+
+BOOST_AUTO_TEST_CASE(verify_userinfo_and_path) { // NOLINT
+    Uri u("wss://user:pa:ss@[::1]:8443/a/b?x=1?y#frag ment");
+    BOOST_TEST(u.username() == "user");
+    BOOST_TEST(u.password() == "pa:ss");
+    BOOST_TEST(u.host() == "::1");
+    BOOST_TEST(u.port() == 8443);
+    BOOST_TEST(u.path() == "/a/b");
+    BOOST_TEST(u.query() == "x=1?y");
+    BOOST_TEST(u.fragment() == "frag ment");
+}
+
+// Inputs found by fuzzing the new parser against the regex it replaced. The
+// last accepted ones made the regex give up on backtracking limits.
+BOOST_AUTO_TEST_CASE(verify_corpus_accepted) { // NOLINT
+    for (auto source : {
+        "//www.example.com",
+        "://www.example.com",
+        "scheme//www.example.com",
+        "http://0.0.0.0:0",
+        "http://255.255.255.255:65535",
+        "1.2.3.4.example",
+        "[1:2:3:4:5:6:7:8]",
+        "[1:2:3:4:5:6:7::]",
+        "[::]",
+        "[::ffff:0:198.51.100.1]",
+        "[64:ff9b::198.51.100.1]",
+        "[FE80::1%25eth0]",
+        "xn---a.example",
+        "a-b.c-d.example",
+        "user@localhost",
+        "http://www.example.com/a//b",
+        "localhost.example",
+        "example.localhost"
+    }) {
+        BOOST_CHECK_NO_THROW(Uri{source});
+    }
+}
+
+BOOST_AUTO_TEST_CASE(verify_corpus_rejected) { // NOLINT
+    for (auto source : {
+        "",
+        "http://",
+        "www.example.com:",
+        "www.example.com:65536",
+        "www.example.com:080",
+        "198.51.100.01",
+        "198.51.100.256",
+        "www.Example.com",
+        "www.example.c0m",
+        "-a.example",
+        "a-.example",
+        "a--b.example",
+        "node",
+        "http://www.example.com//path",
+        "http://www.example.com/pa th",
+        "http://www.example.com?q=a b",
+        "a@b@www.example.com",
+        "::1",
+        "[::1",
+        "[1:2:3:4:5:6:7:8:9]",
+        "[1::2::3]",
+        "[12345::1]",
+        "[1:2:3:4:5:6:198.51.100.1]",
+        "[::1%eth0]",
+        "[2001:db8::1]x"
+    }) {
+        BOOST_CHECK_THROW(Uri{source}, invalid_argument);
+    }
+}
+
 #pragma clang diagnostic pop
\ No newline at end of file
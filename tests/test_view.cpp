@@ -7,6 +7,12 @@
 #include "peer.h"
 #include "view.h"
 
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <thread>
+#include <fstream>
+#include <map>
+
 class F : public View {
 };
 
@@ -162,4 +168,288 @@ BOOST_FIXTURE_TEST_CASE(test_remove_update, F) { // NOLINT
 
 }
 
+BOOST_FIXTURE_TEST_CASE(test_suspect, F) { // NOLINT
+    deque<Peer> buffer{
+        Peer(string("a"), 0),
+        Peer(string("b"), 0),
+        Peer(string("c"), 0)
+    };
+    update(30, 15, 0, buffer);
+
+    BOOST_CHECK(!failed("b"));
+    BOOST_CHECK_EQUAL(suspicion("b"), 1);
+    BOOST_CHECK_EQUAL(size(), 3);
+    BOOST_CHECK(failed("b"));
+    BOOST_CHECK_EQUAL(size(), 2);
+
+    // Others still gossiping the suspected peer do not bring it back.
+    deque<Peer> again{Peer(string("b"), 0)};
+    update(30, 15, 0, again);
+    BOOST_CHECK_EQUAL(size(), 2);
+
+    // Hearing from it directly does.
+    heard("b");
+    BOOST_CHECK_EQUAL(suspicion("b"), 0);
+    update(30, 15, 0, again);
+    BOOST_CHECK_EQUAL(size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_quarantine) { // NOLINT
+    View view(chrono::seconds(0));
+    deque<Peer> buffer{Peer(string("a"), 0), Peer(string("b"), 0)};
+    view.update(30, 15, 0, buffer);
+
+    view.failed("a");
+    BOOST_CHECK(view.failed("a"));
+    BOOST_CHECK_EQUAL(view.size(), 1);
+
+    deque<Peer> again{Peer(string("a"), 0)};
+    view.update(30, 15, 0, again);
+    BOOST_CHECK_EQUAL(view.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_probe) { // NOLINT
+    View view;
+    deque<Peer> buffer{Peer(string("a"), 0), Peer(string("b"), 0)};
+    view.update(30, 15, 0, buffer);
+    BOOST_CHECK_EQUAL(view.next_probe(), "");
+
+    // Peers in the view are gossiped with anyway and are not probed.
+    view.add_probe("j");
+    view.failed("a");
+    BOOST_CHECK_EQUAL(view.next_probe(), "j");
+    BOOST_CHECK_EQUAL(view.next_probe(), "j");
+    view.failed("a");
+    BOOST_CHECK_EQUAL(view.next_probe(), "j");
+    BOOST_CHECK_EQUAL(view.next_probe(), "a");
+
+    // A peer that answered is no longer probed.
+    view.succeeded("a", chrono::milliseconds(10));
+    view.succeeded("j", chrono::milliseconds(10));
+    BOOST_CHECK_EQUAL(view.next_probe(), "");
+
+    // Only the most recent failures are kept.
+    for (int i = 0; i < 40; i++) view.failed(to_string(i));
+    map<string, int> probed;
+    for (int i = 0; i < 40; i++) probed[view.next_probe()]++;
+    BOOST_CHECK_EQUAL(probed.size(), 16);
+    BOOST_CHECK_EQUAL(probed.count("39"), 1);
+    BOOST_CHECK_EQUAL(probed.count("0"), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_prefer_healthy, F) { // NOLINT
+    deque<Peer> buffer{
+        Peer(string("a"), 0),
+        Peer(string("b"), 0),
+        Peer(string("c"), 0),
+        Peer(string("d"), 0)
+    };
+    update(30, 0, 0, buffer);
+    failed("a");
+    succeeded("b", chrono::milliseconds(80));
+    succeeded("c", chrono::milliseconds(5));
+
+    // Peers that failed are only sent along when nothing else is left.
+    deque<Peer> selected = select(3, 0);
+    BOOST_CHECK(none_of(selected.begin(), selected.end(), [](const Peer &p) {
+        return p.addr() == "a";
+    }));
+
+    map<string, int> picked;
+    for (int i = 0; i < 400; i++) picked[random_peer().addr()]++;
+    BOOST_CHECK_LT(picked["a"], picked["d"]);
+    BOOST_CHECK_LT(picked["b"], picked["c"]);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_random_peers, F) { // NOLINT
+    deque<Peer> buffer{
+        Peer(string("a"), 0),
+        Peer(string("b"), 0),
+        Peer(string("c"), 0)
+    };
+    update(30, 15, 0, buffer);
+
+    deque<Peer> picked = random_peers(2);
+    BOOST_CHECK_EQUAL(picked.size(), 2);
+    BOOST_CHECK_NE(picked[0].addr(), picked[1].addr());
+    BOOST_CHECK_LE(random_peers(5).size(), 3);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_concurrent_update, F) { // NOLINT
+    // Updates racing each other are merged, none of their entries may get
+    // lost on the way.
+    vector<thread> writers;
+    for (int i = 0; i < 8; i++) {
+        writers.emplace_back([this, i] {
+            for (int j = 0; j < 50; j++) {
+                deque<Peer> buffer{Peer(to_string(i * 50 + j), 0)};
+                update(1000, 0, 0, buffer);
+            }
+        });
+    }
+    for (auto &each : writers) each.join();
+    BOOST_CHECK_EQUAL(size(), 400);
+}
+
+BOOST_AUTO_TEST_CASE(test_merged_update) { // NOLINT
+    // Merged buffers heal, swap and age the view just as separate updates
+    // would. Each buffer brings in as many entries as H and S drop, so
+    // nothing is left for random removal to pick from.
+    deque<Peer> buffer{
+        Peer(string("a"), 3),
+        Peer(string("b"), 2),
+        Peer(string("c"), 1),
+        Peer(string("d"), 0)
+    };
+    vector<deque<Peer>> batch{
+        {Peer(string("e"), 0), Peer(string("f"), 1)},
+        {Peer(string("g"), 0), Peer(string("h"), 2)}
+    };
+
+    struct M : public View {
+        using View::merge;
+    } merged;
+    View separate;
+    merged.update(4, 1, 1, buffer);
+    separate.update(4, 1, 1, buffer);
+    merged.merge(4, 1, 1, batch);
+    for (auto &each : batch) separate.update(4, 1, 1, each);
+
+    map<string, int> expected;
+    for (auto &peer : separate.snapshot()) expected[peer.addr()] = peer.age();
+    map<string, int> ages;
+    for (auto &peer : merged.snapshot()) ages[peer.addr()] = peer.age();
+    BOOST_CHECK(ages == expected);
+    BOOST_CHECK_EQUAL(ages.size(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_failed_update) { // NOLINT
+    // An update that throws half way must not leave the merge running,
+    // later updates would all be queued and never applied.
+    struct T : public View {
+        mutable bool broken = true;
+
+        chrono::steady_clock::time_point now() const override {
+            if (broken) throw runtime_error("clock");
+            return View::now();
+        }
+    } view;
+
+    deque<Peer> buffer{Peer(string("a"), 0)};
+    BOOST_CHECK_THROW(view.update(30, 15, 0, buffer), runtime_error);
+    view.broken = false;
+    deque<Peer> again{Peer(string("b"), 0)};
+    view.update(30, 15, 0, again);
+    auto snap = view.snapshot();
+    BOOST_CHECK(any_of(snap.begin(), snap.end(), [](const Peer &peer) {
+        return peer.addr() == "b";
+    }));
+}
+
+BOOST_AUTO_TEST_CASE(test_nearest) { // NOLINT
+    View view(chrono::seconds(30), View::Policy::nearest, 1);
+    deque<Peer> buffer{
+        Peer(string("a"), 0),
+        Peer(string("b"), 0),
+        Peer(string("c"), 0),
+        Peer(string("d"), 0)
+    };
+    view.update(30, 15, 0, buffer);
+    view.succeeded("a", chrono::milliseconds(50));
+    view.succeeded("b", chrono::milliseconds(10));
+    view.succeeded("c", chrono::milliseconds(15));
+    view.succeeded("e", chrono::milliseconds(12));
+
+    // Only peers about as close as the closest one count as near, whether
+    // they are in the view or not.
+    map<string, int> picked;
+    for (int i = 0; i < 100; i++) picked[view.random_peer().addr()]++;
+    BOOST_CHECK_EQUAL(picked.size(), 3);
+    BOOST_CHECK_GT(picked["e"], 0);
+    BOOST_CHECK_EQUAL(picked["a"] + picked["d"], 0);
+
+    // Near peers are let into the view like any other, but are the first to
+    // leave it once it is full, which keeps the far ones around.
+    deque<Peer> again{Peer(string("e"), 0), Peer(string("f"), 0)};
+    view.update(30, 15, 0, again);
+    BOOST_CHECK_EQUAL(view.size(), 6);
+    deque<Peer> more{Peer(string("g"), 0)};
+    view.update(6, 15, 0, more);
+    BOOST_CHECK_EQUAL(view.size(), 6);
+    map<string, int> kept;
+    for (auto &peer : view.snapshot()) kept[peer.addr()]++;
+    BOOST_CHECK_EQUAL(kept["a"] + kept["d"] + kept["f"] + kept["g"], 4);
+    BOOST_CHECK_EQUAL(kept["b"] + kept["c"] + kept["e"], 2);
+
+    // Nothing is near once the peer failed.
+    view.failed("e");
+    view.failed("b");
+    view.failed("c");
+    picked.clear();
+    for (int i = 0; i < 100; i++) picked[view.random_peer().addr()]++;
+    BOOST_CHECK_EQUAL(picked["b"] + picked["c"] + picked["e"], 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_nearest_healing) { // NOLINT
+    // Within a single region every peer is near, entries of peers that died
+    // still have to age out to make room for the ones still around.
+    View view(chrono::seconds(30), View::Policy::nearest, 1);
+    deque<Peer> buffer;
+    for (auto addr : {"a", "b", "c", "d"}) {
+        buffer.emplace_back(string(addr), 0);
+        view.succeeded(addr, chrono::milliseconds(10));
+    }
+    view.update(4, 1, 0, buffer);
+
+    vector<string> alive{"a", "b", "e", "f", "g", "h"};
+    for (auto &addr : alive) view.succeeded(addr, chrono::milliseconds(10));
+    for (size_t i = 0; i < 20; i++) {
+        deque<Peer> fresh{
+            Peer(alive[(2 * i) % alive.size()], 0),
+            Peer(alive[(2 * i + 1) % alive.size()], 0)
+        };
+        view.update(4, 1, 0, fresh);
+    }
+    BOOST_CHECK_EQUAL(view.size(), 4);
+    for (auto &peer : view.snapshot()) {
+        BOOST_CHECK_NE(peer.addr(), "c");
+        BOOST_CHECK_NE(peer.addr(), "d");
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(test_snapshot, F) { // NOLINT
+    namespace fs = boost::filesystem;
+    auto path = (fs::temp_directory_path() / fs::unique_path()).string();
+
+    BOOST_CHECK_EQUAL(restore(30, 15, 0, path), 0);
+
+    deque<Peer> buffer{
+        Peer(string("a"), 3),
+        Peer(string("b"), 0),
+        Peer(string("c"), 7)
+    };
+    update(30, 15, 0, buffer);
+    save(path);
+    BOOST_CHECK(!fs::exists(path + ".tmp"));
+
+    View restored;
+    BOOST_CHECK_EQUAL(restored.restore(30, 15, 0, path), 3);
+    map<string, int> ages;
+    for (auto &peer : restored.snapshot()) ages[peer.addr()] = peer.age();
+    for (auto &peer : snapshot()) {
+        BOOST_CHECK_EQUAL(ages[peer.addr()], peer.age() + 1);
+    }
+
+    // A flipped byte anywhere in the entries is caught by the checksum.
+    {
+        fstream file(path, ios::in | ios::out | ios::binary);
+        file.seekp(-1, ios::end);
+        file.put('x');
+    }
+    View damaged;
+    BOOST_CHECK_THROW(damaged.restore(30, 15, 0, path), runtime_error);
+    BOOST_CHECK(damaged.empty());
+    fs::remove(path);
+}
+
 #pragma clang diagnostic pop
\ No newline at end of file
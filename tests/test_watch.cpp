@@ -0,0 +1,119 @@
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_MODULE test_watch
+
+#include <boost/test/unit_test.hpp>
+
+#include "server/watch.h"
+
+#include <atomic>
+#include <thread>
+#include <string>
+#include <vector>
+
+using server::Watch;
+using Type = server::Watch::Type;
+
+static vector<string> drain(Watch &watch) {
+    vector<string> out;
+    Watch::Event event;
+    while (watch.next(event, chrono::milliseconds(0))) {
+        out.emplace_back(Watch::name(event.type) + ":" + event.id);
+    }
+    return out;
+}
+
+BOOST_AUTO_TEST_CASE(snapshot) { // NOLINT
+    Watch watch("", 8);
+    watch.reset({"a", "b"});
+    watch.push({Type::LOGIN, "c"});
+    watch.push({Type::DISCONNECT, "a"});
+
+    vector<string> expected = {
+        "reset:", "snapshot:a", "snapshot:b", "synced:", "login:c", "disconnect:a"
+    };
+    BOOST_TEST(drain(watch) == expected);
+}
+
+BOOST_AUTO_TEST_CASE(filter) { // NOLINT
+    Watch watch("b", 8);
+    watch.reset({"a", "b"});
+    watch.push({Type::CONNECT, "a"});
+    watch.push({Type::CONNECT, "b"});
+
+    vector<string> expected = {"reset:", "snapshot:b", "synced:", "connect:b"};
+    BOOST_TEST(drain(watch) == expected);
+}
+
+BOOST_AUTO_TEST_CASE(overrun) { // NOLINT
+    Watch watch("", 4);
+    watch.reset({});
+    for (int i = 0; i < 2; i++) BOOST_TEST(watch.push({Type::LOGIN, to_string(i)}));
+    BOOST_TEST(!watch.push({Type::LOGIN, "2"}));
+    BOOST_TEST(watch.overrun());
+    BOOST_TEST(watch.overruns() == 1u);
+
+    // Nothing is queued until the watcher has been resynchronised.
+    BOOST_TEST(!watch.push({Type::LOGIN, "3"}));
+    BOOST_TEST(drain(watch).empty());
+
+    watch.reset({"0", "1", "2", "3"});
+    BOOST_TEST(!watch.overrun());
+    BOOST_TEST(drain(watch).size() == 6u);
+}
+
+BOOST_AUTO_TEST_CASE(blocking) { // NOLINT
+    Watch watch("", 4);
+    Watch::Event event;
+    BOOST_TEST(!watch.next(event, chrono::milliseconds(10)));
+
+    thread producer([&watch] {
+        this_thread::sleep_for(chrono::milliseconds(20));
+        watch.push({Type::CONNECT, "a"});
+    });
+    BOOST_TEST(watch.next(event, chrono::seconds(5)));
+    BOOST_TEST(event.id == "a");
+    producer.join();
+
+    thread closer([&watch] {
+        this_thread::sleep_for(chrono::milliseconds(20));
+        watch.close();
+    });
+    auto begin = chrono::steady_clock::now();
+    BOOST_TEST(!watch.next(event, chrono::seconds(5)));
+    BOOST_TEST((chrono::steady_clock::now() - begin < chrono::seconds(1)));
+    closer.join();
+    BOOST_TEST(!watch.push({Type::CONNECT, "b"}));
+}
+
+BOOST_AUTO_TEST_CASE(shutdown) { // NOLINT
+    // Streams the way the miners/watch handler does, for a watcher that
+    // stays connected while miners keep coming and going.
+    Watch watch("", 1024);
+    atomic<bool> stopping{false};
+    atomic<size_t> streamed{0};
+    thread stream([&watch, &streamed] {
+        Watch::Event event;
+        while (!watch.closed()) {
+            if (watch.next(event, chrono::milliseconds(500))) streamed++;
+        }
+    });
+    thread miners([&watch, &stopping] {
+        while (!stopping) {
+            watch.push({Type::CONNECT, "a"});
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    });
+    this_thread::sleep_for(chrono::milliseconds(50));
+
+    auto begin = chrono::steady_clock::now();
+    watch.close();
+    stream.join();
+    BOOST_TEST((chrono::steady_clock::now() - begin < chrono::milliseconds(500)));
+    BOOST_TEST(watch.closed());
+    BOOST_TEST(streamed > 0u);
+    stopping = true;
+    miners.join();
+}
+
+#pragma clang diagnostic pop